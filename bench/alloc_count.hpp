@@ -0,0 +1,37 @@
+#ifndef ALLOC_COUNT_HPP
+#define ALLOC_COUNT_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+/*
+    Counts heap allocations by replacing the global operator new.
+    Include in one translation unit only (the benchmark main)
+*/
+
+
+static std::atomic<long> n_allocs(0);
+
+
+long bench_allocs(){ return n_allocs.load(std::memory_order_relaxed); }
+
+
+void *operator new(std::size_t sz){
+    n_allocs.fetch_add(1, std::memory_order_relaxed);
+    if(void *p = std::malloc((sz > 0) ? sz : 1)) return p;
+    throw std::bad_alloc();
+}
+
+
+void *operator new[](std::size_t sz){ return operator new(sz); }
+
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef BASELINE_HPP
+#define BASELINE_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+
+
+/*
+    Benchmark baselines
+
+    A baseline is the JSON output of a benchmark run (bench --save). A new
+    run is compared with it benchmark by benchmark: a benchmark regresses
+    when its median time is slower than the baseline by more than the
+    threshold AND the confidence intervals of the two medians do not
+    overlap (so that noise alone does not fail the comparison), or when it
+    allocates more than the threshold above the baseline
+*/
+
+
+// value of a numeric field after pos (the first one with this key), -1 if missing
+inline double json_number(const std::string& s, size_t pos, size_t end, const std::string& key){
+    size_t p = s.find("\"" + key + "\":", pos);
+    if(p == std::string::npos || p >= end) return -1;
+    return std::strtod(s.c_str() + p + key.size() + 3, nullptr);
+}
+
+
+// reads the results of a file written by --save (or --json), false if it can't be read
+inline bool load_baseline(const std::string& path, std::vector<bench_result>& out){
+    std::ifstream in(path);
+    if(!in) return false;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string s = ss.str();
+
+    const std::string key = "{\"name\": \"";
+    size_t p = s.find(key);
+    while(p != std::string::npos){
+        size_t next = s.find(key, p + 1);
+        size_t end  = (next == std::string::npos) ? s.size() : next;
+        size_t q    = s.find('"', p + key.size());
+
+        bench_result r = bench_result();
+        r.name          = s.substr(p + key.size(), q - p - key.size());
+        r.median        = json_number(s, p, end, "median");
+        r.mean          = json_number(s, p, end, "mean");
+        r.stddev        = json_number(s, p, end, "stddev");
+        r.min           = json_number(s, p, end, "min");
+        r.max           = json_number(s, p, end, "max");
+        r.ci_low        = json_number(s, p, end, "ci_low");
+        r.ci_high       = json_number(s, p, end, "ci_high");
+        r.allocs_per_op = json_number(s, p, end, "allocs_per_op");
+        if(r.median < 0) return false;
+        out.push_back(r);
+
+        p = next;
+    }
+    return !out.empty();
+}
+
+
+inline bool save_results(const std::string& path, const std::string& json){
+    std::ofstream out(path);
+    out << json;
+    return (bool) out;
+}
+
+
+/*
+    Compares results with a baseline, prints a report and returns the number
+    of regressions. Benchmarks missing from either side are reported and skipped
+*/
+inline int compare_results(const std::vector<bench_result>& base, const std::vector<bench_result>& cur,
+                           double threshold, std::ostream& os){
+    int regressions = 0;
+    char buf[512];
+
+    std::snprintf(buf, sizeof(buf), "%-28s %12s %12s %8s %10s %10s  %s",
+                  "benchmark", "base ns", "new ns", "change", "base alloc", "new alloc", "verdict");
+    os << buf << "\n";
+
+    for(const bench_result& c : cur){
+        const bench_result *b = nullptr;
+        for(const bench_result& x : base) if(x.name == c.name) b = &x;
+        if(b == nullptr){
+            os << c.name << ": not in the baseline\n";
+            continue;
+        }
+
+        double change  = (b->median > 0) ? c.median / b->median - 1 : 0;
+        bool slower    = change > threshold;
+        bool separated = c.ci_low > b->ci_high;
+        bool allocs    = b->allocs_per_op >= 0 && c.allocs_per_op > b->allocs_per_op * (1 + threshold) + 0.01;
+
+        const char *verdict = "ok";
+        if(slower && separated) verdict = "REGRESSED";
+        else if(slower) verdict = "noisy (intervals overlap)";
+        else if(change < -threshold && c.ci_high < b->ci_low) verdict = "faster";
+        if(allocs) verdict = (slower && separated) ? "REGRESSED, MORE ALLOCATIONS" : "MORE ALLOCATIONS";
+        if((slower && separated) || allocs) ++regressions;
+
+        std::snprintf(buf, sizeof(buf), "%-28s %12.1f %12.1f %+7.1f%% %10.2f %10.2f  %s",
+                      c.name.c_str(), b->median, c.median, 100 * change, b->allocs_per_op, c.allocs_per_op, verdict);
+        os << buf << "\n";
+    }
+
+    for(const bench_result& b : base){
+        bool found = false;
+        for(const bench_result& c : cur) found = found || (c.name == b.name);
+        if(!found) os << b.name << ": not run (in the baseline only)\n";
+    }
+
+    return regressions;
+}
+
+
+#endif
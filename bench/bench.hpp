@@ -0,0 +1,144 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+/*
+    Minimal micro-benchmark harness
+
+    A benchmark is a function running a given number of iterations, each
+    doing ops_per_iter operations. The harness warms it up, calibrates the
+    iterations so that a repetition lasts about min_time, then times the
+    repetitions and reports statistics of the time per operation (with a
+    distribution-free 95% confidence interval of the median) and the heap
+    allocations per operation
+*/
+
+
+// heap allocations so far (see alloc_count.hpp)
+long bench_allocs();
+
+
+// keeps the compiler from optimizing a value away
+template<class T>
+inline void keep(const T& v){
+    asm volatile("" : : "g"(&v) : "memory");
+}
+
+
+struct bench_config{
+    int          reps     = 10;      // timed repetitions
+    double       min_time = 0.05;    // seconds per repetition
+    std::string  filter;             // only run benchmarks containing this
+};
+
+
+struct bench_result{
+    std::string  name;
+    std::string  unit;               // what an operation is
+    long         iters;              // iterations per repetition
+    long         ops_per_iter;
+    double       median;             // ns per operation
+    double       mean;
+    double       stddev;
+    double       min;
+    double       max;
+    double       ci_low;             // 95% confidence interval of the median
+    double       ci_high;
+    double       allocs_per_op;
+
+    double per_sec() const { return (median > 0) ? 1e9 / median : 0; }
+};
+
+
+struct benchmark{
+    std::string                 name;
+    std::string                 unit;
+    long                        ops_per_iter;
+    std::function<void(long)>   run;     // runs n iterations
+};
+
+
+// seconds taken by n iterations
+inline double time_iters(const benchmark& b, long n){
+    auto t0 = std::chrono::steady_clock::now();
+    b.run(n);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+
+inline bench_result run_benchmark(const benchmark& b, const bench_config& cfg){
+
+    // warmup and calibration: double the iterations until a run is long enough
+    long n = 1;
+    double t;
+    while((t = time_iters(b, n)) < cfg.min_time / 4 && n < (1L << 40)) n *= 2;
+    n = std::max(1L, (long) (n * cfg.min_time / std::max(t, 1e-9)));
+
+    std::vector<double> ns;
+    long allocs = bench_allocs();
+    for(int r=0; r<cfg.reps; ++r)
+        ns.push_back(time_iters(b, n) * 1e9 / ((double) n * b.ops_per_iter));
+    allocs = bench_allocs() - allocs;
+
+    bench_result res;
+    res.name         = b.name;
+    res.unit         = b.unit;
+    res.iters        = n;
+    res.ops_per_iter = b.ops_per_iter;
+
+    std::sort(ns.begin(), ns.end());
+    size_t k = ns.size();
+    res.median = (k % 2) ? ns[k/2] : (ns[k/2 - 1] + ns[k/2]) / 2;
+    res.min    = ns.front();
+    res.max    = ns.back();
+
+    // ranks of the interval bounds, normal approximation of the binomial
+    double half = 0.98 * std::sqrt((double) k);
+    long lo = std::max(0L, (long) std::floor(k / 2.0 - half));
+    long hi = std::min((long) k - 1, (long) std::ceil(k / 2.0 + half) - 1);
+    res.ci_low  = ns[lo];
+    res.ci_high = ns[hi];
+
+    res.allocs_per_op = allocs / ((double) n * b.ops_per_iter * cfg.reps);
+
+    double sum = 0, sq = 0;
+    for(double v : ns) sum += v;
+    res.mean = sum / k;
+    for(double v : ns) sq += (v - res.mean) * (v - res.mean);
+    res.stddev = (k > 1) ? std::sqrt(sq / (k - 1)) : 0;
+
+    return res;
+}
+
+
+inline std::string to_json(const bench_result& r){
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+        "{\"name\": \"%s\", \"unit\": \"%s\", \"iters\": %ld, \"ops_per_iter\": %ld, "
+        "\"ns_per_op\": {\"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, \"min\": %.3f, \"max\": %.3f, "
+        "\"ci_low\": %.3f, \"ci_high\": %.3f}, \"per_sec\": %.1f, \"allocs_per_op\": %.3f}",
+        r.name.c_str(), r.unit.c_str(), r.iters, r.ops_per_iter,
+        r.median, r.mean, r.stddev, r.min, r.max, r.ci_low, r.ci_high, r.per_sec(), r.allocs_per_op);
+    return buf;
+}
+
+
+inline std::string to_text(const bench_result& r){
+    char buf[512];
+    std::snprintf(buf, sizeof(buf), "%-28s %12.1f ns/%-6s (+- %5.1f%%) %14.1f %s/s %10.1f allocs/%s",
+        r.name.c_str(), r.median, r.unit.c_str(),
+        (r.mean > 0) ? 100 * r.stddev / r.mean : 0.0, r.per_sec(), r.unit.c_str(),
+        r.allocs_per_op, r.unit.c_str());
+    return buf;
+}
+
+
+#endif
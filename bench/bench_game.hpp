@@ -0,0 +1,86 @@
+#ifndef BENCH_GAME_HPP
+#define BENCH_GAME_HPP
+
+#include <vector>
+#include "bench.hpp"
+#include "battleship.h"
+#include "bs_player.h"
+#include "slick_player.h"
+#include "sliced_engine.h"
+#include "vec_env.h"
+
+
+// plays n silent games between two new players
+template<class PA, class PB>
+inline void play_games(long n, PA pa_proto, PB pb_proto){
+    for(long it=0; it<n; ++it){
+        bship::battleship game(10, 10, bship::OM_SILENT);
+        PA pa(pa_proto);
+        PB pb(pb_proto);
+        bship::connect(&game, &pa, &pb);
+        game.start();
+        keep(game.get_total_shots());
+    }
+}
+
+
+// plays n silent games between two players in one game, reset between the games
+template<class PA, class PB>
+inline void replay_games(long n, PA pa, PB pb){
+    bship::battleship game(10, 10, bship::OM_SILENT);
+    bship::connect(&game, &pa, &pb);
+    for(long it=0; it<n; ++it){
+        game.reset();
+        game.start();
+        keep(game.get_total_shots());
+    }
+}
+
+
+inline std::vector<benchmark> game_benchmarks(){
+    std::vector<benchmark> res;
+
+    res.push_back({"game/random_vs_random", "game", 1, [](long n){
+        play_games(n, bship::bs_player("a"), bship::bs_player("b"));
+    }});
+
+    res.push_back({"game/slick_vs_random", "game", 1, [](long n){
+        play_games(n, bship::slick_player("a", 0.2), bship::bs_player("b"));
+    }});
+
+    res.push_back({"game/random_vs_random_reset", "game", 1, [](long n){
+        replay_games(n, bship::bs_player("a"), bship::bs_player("b"));
+    }});
+
+    res.push_back({"game/slick_vs_random_reset", "game", 1, [](long n){
+        replay_games(n, bship::slick_player("a", 0.2), bship::bs_player("b"));
+    }});
+
+    // 64 games per batch, layouts drawn uniformly
+    res.push_back({"game/sliced_random_vs_random", "game", bship::sliced_engine::LANES, [](long n){
+        bship::sliced_engine eng(bship::bs_grid(10, 10));
+        bship::game_outcome out[bship::sliced_engine::LANES];
+        for(long it=0; it<n; ++it){
+            eng.play(bship::SP_RANDOM, bship::SP_RANDOM, out);
+            keep(out);
+        }
+    }});
+
+    // one shot in each of 64 environments, every cell in order
+    res.push_back({"game/vec_env_step", "game", 64, [](long n){
+        bship::vec_env env(64, 10, 10);
+        std::vector<float> obs(64 * env.get_obs_size()), rew(64);
+        std::vector<uint8_t> dones(64);
+        std::vector<int32_t> act(64, 0);
+        for(long it=0; it<n; ++it){
+            env.step(act.data(), obs.data(), rew.data(), dones.data());
+            for(size_t i=0; i<64; ++i) act[i] = (dones[i]) ? 0 : act[i] + 1;
+            keep(rew.data());
+        }
+    }});
+
+    return res;
+}
+
+
+#endif
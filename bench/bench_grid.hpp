@@ -0,0 +1,134 @@
+#ifndef BENCH_GRID_HPP
+#define BENCH_GRID_HPP
+
+#include <cstdlib>
+#include <vector>
+#include "bench.hpp"
+#include "bs_grid.h"
+#include "fleet_sampler.h"
+
+
+// the standard fleet, placed without overlaps
+inline void place_fleet(bship::bs_grid& g){
+    g.place_ship(bship::ST_FIVE,  0, 0, bship::SO_HOR);
+    g.place_ship(bship::ST_FOUR,  2, 0, bship::SO_HOR);
+    g.place_ship(bship::ST_THREE, 4, 0, bship::SO_HOR);
+    g.place_ship(bship::ST_THREE, 6, 0, bship::SO_HOR);
+    g.place_ship(bship::ST_TWO,   8, 0, bship::SO_HOR);
+}
+
+
+// random placement of the fleet, the way bs_player does it
+inline void place_random_fleet(bship::bs_grid& g){
+    std::vector<bship::ship_type> types;
+    for(auto& tp : g.get_max_n_ships())
+        for(int i=0; i<tp.second; ++i) types.push_back(tp.first);
+
+    for(bship::ship_type t : types){
+        while(!g.place_ship(t, rand() % g.get_height(), rand() % g.get_width(),
+                            (rand() % 2) ? bship::SO_HOR : bship::SO_VERT));
+    }
+}
+
+
+inline std::vector<benchmark> grid_benchmarks(){
+    std::vector<benchmark> res;
+
+    res.push_back({"grid/cell_at", "op", 100, [](long n){
+        bship::bs_grid g(10, 10);
+        place_fleet(g);
+        unsigned sum = 0;
+        for(long it=0; it<n; ++it){
+            for(size_t i=0; i<10; ++i)
+                for(size_t j=0; j<10; ++j) sum += g.cell_at(i, j).state;
+            keep(sum);
+        }
+    }});
+
+    // includes resetting the grid (copy of an empty one) once per fleet
+    res.push_back({"grid/place_ship", "op", 5, [](long n){
+        bship::bs_grid empty(10, 10), g(10, 10);
+        for(long it=0; it<n; ++it){
+            g = empty;
+            place_fleet(g);
+            keep(g);
+        }
+    }});
+
+    // includes resetting the grid (copy of a full one) once per 100 shots
+    res.push_back({"grid/shoot_at", "op", 100, [](long n){
+        bship::bs_grid full(10, 10), g(10, 10);
+        place_fleet(full);
+        for(long it=0; it<n; ++it){
+            g = full;
+            for(size_t i=0; i<10; ++i)
+                for(size_t j=0; j<10; ++j) keep(g.shoot_at(i, j));
+        }
+    }});
+
+    // every placement of a 3-cell ship on a full grid
+    res.push_back({"grid/can_place_ship", "op", 200, [](long n){
+        bship::bs_grid g(10, 10);
+        place_fleet(g);
+        for(long it=0; it<n; ++it){
+            for(size_t i=0; i<10; ++i){
+                for(size_t j=0; j<10; ++j){
+                    keep(g.can_place_ship(bship::ST_THREE, i, j, bship::SO_HOR));
+                    keep(g.can_place_ship(bship::ST_THREE, i, j, bship::SO_VERT));
+                }
+            }
+        }
+    }});
+
+    res.push_back({"grid/ship_sunk", "op", 5, [](long n){
+        bship::bs_grid g(10, 10);
+        place_fleet(g);
+        for(long it=0; it<n; ++it)
+            for(int id=0; id<5; ++id) keep(g.ship_sunk(id));
+    }});
+
+    // worst case: every ship is sunk, all the cells are checked
+    res.push_back({"grid/all_ships_sunk", "op", 1, [](long n){
+        bship::bs_grid g(10, 10);
+        place_fleet(g);
+        for(size_t i=0; i<10; ++i)
+            for(size_t j=0; j<10; ++j) g.shoot_at(i, j);
+        for(long it=0; it<n; ++it) keep(g.all_ships_sunk());
+    }});
+
+    res.push_back({"fleet/random_placement", "fleet", 1, [](long n){
+        for(long it=0; it<n; ++it){
+            bship::bs_grid g(10, 10);
+            place_random_fleet(g);
+            keep(g);
+        }
+    }});
+
+    res.push_back({"fleet/sample_uniform", "fleet", 1, [](long n){
+        bship::fleet_sampler fs(10, 10, bship::bs_grid(10, 10).get_max_n_ships(), bship::SM_UNIFORM);
+        bship::ship_placement out[5];
+        for(long it=0; it<n; ++it) keep(fs.sample(out));
+    }});
+
+    res.push_back({"fleet/sample_fast", "fleet", 1, [](long n){
+        bship::fleet_sampler fs(10, 10, bship::bs_grid(10, 10).get_max_n_ships(), bship::SM_FAST);
+        bship::ship_placement out[5];
+        for(long it=0; it<n; ++it) keep(fs.sample(out));
+    }});
+
+    // includes resetting the grid once per fleet
+    res.push_back({"fleet/sample_place", "fleet", 1, [](long n){
+        bship::bs_grid g(10, 10);
+        bship::fleet_sampler fs(g);
+        for(long it=0; it<n; ++it){
+            g.reset();
+            fs.place(g);
+            keep(g);
+        }
+    }});
+
+    return res;
+}
+
+
+#endif
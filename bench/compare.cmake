@@ -0,0 +1,14 @@
+# Runs the benchmarks against the stored baseline (see the bench_compare target)
+#
+#   cmake -DBENCH=<bench executable> -DBASELINE=<baseline file> -P compare.cmake
+
+if(NOT EXISTS "${BASELINE}")
+    message(STATUS "No benchmark baseline at ${BASELINE}, nothing to compare with.")
+    message(STATUS "Save one from a Release build of a known good revision with: ${BENCH} --save ${BASELINE}")
+    return()
+endif()
+
+execute_process(COMMAND "${BENCH}" --compare "${BASELINE}" RESULT_VARIABLE rc)
+if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "Benchmark comparison with ${BASELINE} failed")
+endif()
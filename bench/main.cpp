@@ -0,0 +1,88 @@
+/*
+    Micro-benchmarks of the engine hot paths
+
+    usage: bench [--json] [--reps <n>] [--min-time <seconds>] [--filter <name part>]
+                 [--save <baseline>] [--compare <baseline> [--threshold <fraction>]]
+
+    --save writes the results (JSON) to a baseline file, --compare compares
+    them with one and exits with 2 if a benchmark regressed (see baseline.hpp)
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "alloc_count.hpp"
+#include "bench.hpp"
+#include "baseline.hpp"
+#include "bench_grid.hpp"
+#include "bench_game.hpp"
+
+
+static int usage(const char *prog){
+    std::cerr << "usage: " << prog << " [--json] [--reps <n>] [--min-time <seconds>] [--filter <name part>]" << std::endl;
+    std::cerr << "       [--save <baseline>] [--compare <baseline> [--threshold <fraction>]]" << std::endl;
+    return 1;
+}
+
+
+int main(int argc, char **argv){
+    bench_config cfg;
+    bool json = false;
+    std::string save, compare;
+    double threshold = 0.1;
+
+    for(int i=1; i<argc; ++i){
+        std::string a = argv[i];
+        if(a == "--json") json = true;
+        else if(a == "--reps" && i+1 < argc) cfg.reps = std::max(1, atoi(argv[++i]));
+        else if(a == "--min-time" && i+1 < argc) cfg.min_time = atof(argv[++i]);
+        else if(a == "--filter" && i+1 < argc) cfg.filter = argv[++i];
+        else if(a == "--save" && i+1 < argc) save = argv[++i];
+        else if(a == "--compare" && i+1 < argc) compare = argv[++i];
+        else if(a == "--threshold" && i+1 < argc) threshold = atof(argv[++i]);
+        else return usage(argv[0]);
+    }
+    srand(1);
+
+    std::vector<bench_result> base;
+    if(!compare.empty() && !load_baseline(compare, base)){
+        std::cerr << "can't read the baseline " << compare << std::endl;
+        return 1;
+    }
+
+    std::vector<benchmark> all = grid_benchmarks();
+    for(auto& b : game_benchmarks()) all.push_back(b);
+
+    std::vector<bench_result> results;
+    for(auto& b : all){
+        if(!cfg.filter.empty() && b.name.find(cfg.filter) == std::string::npos) continue;
+        results.push_back(run_benchmark(b, cfg));
+        if(!json && compare.empty()) std::cout << to_text(results.back()) << std::endl;
+    }
+
+    std::ostringstream os;
+    os << "{\"reps\": " << cfg.reps << ", \"min_time\": " << cfg.min_time << ", \"benchmarks\": [";
+    for(size_t i=0; i<results.size(); ++i)
+        os << ((i > 0) ? "," : "") << "\n  " << to_json(results[i]);
+    os << "\n]}\n";
+
+    if(json) std::cout << os.str();
+    if(!save.empty() && !save_results(save, os.str())){
+        std::cerr << "can't write the baseline " << save << std::endl;
+        return 1;
+    }
+
+    if(!compare.empty()){
+        int n = compare_results(base, results, threshold, std::cout);
+        if(n > 0){
+            std::cout << n << " benchmark(s) regressed by more than " << 100 * threshold << "% against " << compare << std::endl;
+            return 2;
+        }
+        std::cout << "no regression against " << compare << std::endl;
+    }
+
+    return 0;
+}
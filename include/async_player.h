@@ -0,0 +1,125 @@
+/*!
+    A battleship player thinking in the background
+*/
+
+#ifndef ASYNC_PLAYER_HPP
+#define ASYNC_PLAYER_HPP
+
+
+#include <atomic>
+#include <future>
+#include <vector>
+#include "battleship.h"
+#include "bs_player.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+    class battleship;
+    class async_player;
+}
+
+
+
+/*!
+    @class async_player
+
+    @brief Pondering battleship player
+
+    Base class of bots whose shot takes a while to compute. Every time the
+    player's hit grid changes (see bs_player::on_update()), the shot for the
+    new position is started on a background thread, on a snapshot of the
+    hit grid. That includes the opponent's turn: after a miss the next shot
+    is being computed while the opponent thinks.
+
+    When the game asks for a move, a result computed for the current position
+    is used as is (waiting for it if it is still running). Work started for a
+    position that is no longer current is cancelled through a stop flag the
+    derived class is expected to poll. Under time control (see
+    battleship::set_time_control()) the wait is bounded by the time left,
+    after which the work is cancelled and a random shot is made.
+
+    Derived classes only implement think(); placement is random (bs_player::move())
+*/
+class bship::async_player : public bs_player {
+public:
+
+    /*!
+        @brief Constructor with grid and game pointers
+
+        Constructs a player with given grids and game. The grids are pointers
+        to bs_grid objects inside the relevant game object. Players get
+        all game state information through their grids. Players are free
+        to keep track of any additional data they deem useful.
+        The game is a pointer to the game on which the player makes moves
+
+        @param hdg, htg Hidden and hit grid pointers of the player
+        @param gm Pointer to the game
+    */
+    async_player(std::string& n, bs_grid* hdg, bs_grid* htg, battleship *gm);
+
+
+    /// Name constructor
+    async_player(std::string nm);
+
+
+    /// Default constructor initializes everything to nullptr
+    async_player();
+
+
+    /// Destructor cancels and waits for the background work
+    virtual ~async_player();
+
+
+    void move();
+
+
+    /// Starts pondering on a new position, cancels work on a stale one
+    void on_update();
+
+
+    /// Cancels the background work before a new game
+    void reset();
+
+
+protected:
+
+    /*!
+        @brief Computes a shot
+
+        Called on a background thread with a snapshot of the hit grid.
+        Never called twice at the same time.
+
+        @param obs Observation grid to shoot at
+        @param stop Set when the result is no longer needed, should be polled
+        @param row, col Set to the coordinates of the shot
+        @return false if stopped or no shot was found (a random shot is made instead)
+    */
+    virtual bool think(bs_grid& obs, const std::atomic<bool>& stop, size_t& row, size_t& col) = 0;
+
+
+    /// Cancels the background work and waits for it to finish
+    void stop_pondering();
+
+
+private:
+
+    /// True if the background work is on the current hit grid
+    bool on_current_position();
+
+
+    /// Starts the background work on a snapshot of the hit grid
+    void start_job();
+
+
+    std::future<bool>         job;       ///< background work (invalid if none)
+    std::atomic<bool>         stop;      ///< cancels the background work
+    bs_grid                  *snapshot;  ///< copy of the hit grid the background work runs on
+    std::vector<cell_state>   position;  ///< hit grid states the background work runs on
+    size_t                    job_row;   ///< result of the background work: row
+    size_t                    job_col;   ///< result of the background work: column
+
+};
+
+
+#endif
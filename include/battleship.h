@@ -5,9 +5,12 @@
 #ifndef BATTLESHIP_HPP
 #define BATTLESHIP_HPP
 
+#include <chrono>
 #include <cstdlib>
+#include <vector>
 #include "bs_grid.h"
 #include "bs_player.h"
+#include "game_listener.h"
 #include "exceptions.hpp"
 
 
@@ -27,6 +30,35 @@ namespace bship{
     };
 
 
+    /// What the game does when a player runs out of time
+    enum overrun_policy : uint8_t {
+        OP_FORFEIT,     ///< the player loses the game
+        OP_RANDOM_MOVE  ///< a random legal move is made instead
+    };
+
+
+    /*!
+        @brief Time control
+
+        Time budgets of each player, measured with a monotonic clock
+        from the moment the game asks the player to move. A zero
+        budget is unlimited
+    */
+    struct time_control{
+
+        /// Constructor with budgets (no limit by default)
+        time_control(std::chrono::microseconds move_budget = std::chrono::microseconds(0),
+                     std::chrono::microseconds game_budget = std::chrono::microseconds(0),
+                     overrun_policy pol = OP_FORFEIT)
+        :   per_move(move_budget), per_game(game_budget), policy(pol)
+        {}
+
+        std::chrono::microseconds  per_move;  ///< budget of each move
+        std::chrono::microseconds  per_game;  ///< budget of all the moves of a player in the game
+        overrun_policy             policy;    ///< what to do on overrun
+    };
+
+
     /*!
         @brief Connect game and its players
 
@@ -87,10 +119,51 @@ public:
     bs_player * get_winner();
 
 
+    /// returns the pointer to the player to move
+    bs_player * get_current_player();
+
+
     /// returns total shots by both players
     int get_total_shots();
 
 
+    /// true once one of the fleets has been sunk (or a player forfeited)
+    bool is_finished();
+
+
+    /*!
+        @brief Set time control
+
+        Both players get the same budgets. Moves made after the deadline
+        are not made: place_ship() and shoot_at() throw time_exception
+        instead and the game applies the overrun policy. A player
+        returning from move() past its deadline without moving is
+        treated the same way. Only enforced inside start()
+
+        @param tc Budgets and overrun policy
+    */
+    void set_time_control(const time_control& tc);
+
+
+    /// Time control getter
+    time_control get_time_control();
+
+
+    /*!
+        @brief Time left
+
+        Anytime bots can poll this to stop thinking in time
+
+        @return Time left until the deadline of the move in progress,
+                std::chrono::nanoseconds::max() if unlimited
+    */
+    std::chrono::nanoseconds time_left();
+
+
+    /// Time spent by player p in its moves so far
+    std::chrono::nanoseconds get_time_used(bs_player *p);
+
+
     /*!
         @brief Place a ship
 
@@ -125,13 +198,80 @@ public:
     void start();
 
 
+    /*!
+        @brief Reset the game
+
+        Clears the grids and the game state and resets both players
+        (bs_player::reset()), so that the same game and players can play
+        again. Nothing is allocated: batch simulations keep one game per
+        thread and reset it between games instead of constructing new ones.
+        The players, time control and listeners are kept
+    */
+    void reset();
+
+
+    /*!
+        @brief Add a listener
+
+        The listener is told about every move made from now on.
+        It is not owned by the game and has to outlive it (or be removed)
+
+        @param l Listener to add
+    */
+    void add_listener(game_listener *l);
+
+
+    /// Removes a listener added with add_listener()
+    void remove_listener(game_listener *l);
+
+
     friend void connect(battleship *game, bs_player *pa, bs_player *pb);
     friend class human_player;
     friend class slick_player;
+    friend class model_player;
+    friend class game_server;
+    friend class game_broadcast;
 
 
 private:
 
+    /// Calls bs_player::on_update() on both players
+    void notify_players();
+
+
+    /// Ends the game and tells the players and listeners
+    void finish(bool a_won);
+
+
+    /// Starts the clock of the player to move
+    void start_clock();
+
+
+    /// Stops the clock of the player to move, returns true if its deadline passed
+    bool stop_clock();
+
+
+    /// Throws time_exception (after applying the overrun policy) if the current move is late
+    void check_deadline();
+
+
+    /// Applies the overrun policy to the player to move
+    void overrun();
+
+
+    /// Makes a random legal move for the player to move (no time checks)
+    void random_move();
+
+
+    /// place_ship() without time checks
+    bool do_place_ship(ship_type type, size_t row, size_t col, ship_orientation orient);
+
+
+    /// shoot_at() without time checks
+    std::pair<shot_result, int> do_shoot_at(size_t row, size_t col);
+
+
+
     bs_grid       pa_hidden_grid;  ///< player A ship placement grid
     bs_grid       pa_hit_grid;     ///< player A hit tracking grid
     bs_grid       pb_hidden_grid;  ///< player B ship placement grid
@@ -145,6 +285,19 @@ private:
     bool          pa_won;          ///< true if player A has won, false otherwise. only relevant if game is finished
     output_mode   output;          ///< game verbosity
 
+    typedef std::chrono::steady_clock clock;
+
+    time_control        tc;            ///< time budgets
+    bool                timed;         ///< the move in progress has a deadline
+    bool                moved;         ///< the move in progress has been made
+    bool                clock_pa;      ///< the move in progress is player A's
+    clock::time_point   move_start;    ///< start of the move in progress
+    clock::time_point   deadline;      ///< deadline of the move in progress
+    clock::duration     pa_time;       ///< time used by player A
+    clock::duration     pb_time;       ///< time used by player B
+
+    std::vector<game_listener*>  listeners;  ///< observers of the moves
+
 };
 
 
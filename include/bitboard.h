@@ -0,0 +1,83 @@
+/*!
+    Fixed-size cell sets for grids of up to 128 cells
+*/
+
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+
+#include <cstdint>
+#include <cstddef>
+
+
+namespace bship{
+    struct bitboard;
+}
+
+
+
+/*!
+    @brief Set of grid cells
+
+    One bit per cell, cell (row, col) of a grid of width w has index row*w + col.
+    Used by solvers and bots that need to compare and combine many cell sets quickly
+*/
+struct bship::bitboard{
+
+    uint64_t w[2];   ///< bits of cells 0-63 and 64-127
+
+    /// Maximum number of cells
+    static const size_t CAPACITY = 128;
+
+
+    /// Constructor, empty set
+    constexpr bitboard() : w{0, 0} {}
+
+
+    /// Constructor from the bits of cells 0-63 and 64-127 (usable in constant expressions)
+    constexpr bitboard(uint64_t lo, uint64_t hi) : w{lo, hi} {}
+
+
+    /// Adds cell i to the set
+    inline void set(size_t i){ w[i >> 6] |= 1ull << (i & 63); }
+
+
+    /// Removes cell i from the set
+    inline void reset(size_t i){ w[i >> 6] &= ~(1ull << (i & 63)); }
+
+
+    /// Checks whether cell i is in the set
+    inline bool test(size_t i) const { return (w[i >> 6] >> (i & 63)) & 1; }
+
+
+    /// Checks whether the set is not empty
+    inline bool any() const { return (w[0] | w[1]) != 0; }
+
+
+    /// Number of cells in the set
+    inline int count() const { return __builtin_popcountll(w[0]) + __builtin_popcountll(w[1]); }
+
+
+    /// Checks whether the two sets have a common cell
+    inline bool intersects(const bitboard& o) const { return ((w[0] & o.w[0]) | (w[1] & o.w[1])) != 0; }
+
+
+    /// Checks whether all cells of the set are in o
+    inline bool subset_of(const bitboard& o) const { return ((w[0] & ~o.w[0]) | (w[1] & ~o.w[1])) == 0; }
+
+
+    inline bitboard operator|(const bitboard& o) const { bitboard r; r.w[0] = w[0] | o.w[0]; r.w[1] = w[1] | o.w[1]; return r; }
+    inline bitboard operator&(const bitboard& o) const { bitboard r; r.w[0] = w[0] & o.w[0]; r.w[1] = w[1] & o.w[1]; return r; }
+    inline bitboard& operator|=(const bitboard& o){ w[0] |= o.w[0]; w[1] |= o.w[1]; return *this; }
+    inline bitboard& operator&=(const bitboard& o){ w[0] &= o.w[0]; w[1] &= o.w[1]; return *this; }
+    inline bool operator==(const bitboard& o) const { return w[0] == o.w[0] && w[1] == o.w[1]; }
+    inline bool operator!=(const bitboard& o) const { return !(*this == o); }
+
+
+    /// Hash of the set
+    inline uint64_t hash() const { return (w[0] * 0x9E3779B97F4A7C15ull) ^ (w[1] + 0x632BE59BD9B4E019ull + (w[0] >> 7)); }
+
+};
+
+
+#endif
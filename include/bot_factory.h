@@ -0,0 +1,33 @@
+/*!
+    Bots by their command line names
+*/
+
+#ifndef BOT_FACTORY_HPP
+#define BOT_FACTORY_HPP
+
+
+#include <string>
+#include "bs_player.h"
+
+
+namespace bship{
+
+    /// Bot specs known to make_bot(), for usage messages
+    extern const char *const BOT_SPECS;
+
+
+    /*!
+        @brief Create a bot from its command line name
+
+        The tools share it, so that every bot can be used by every tool
+
+        @param spec Bot and its settings (see BOT_SPECS), e.g. "slick:0.5"
+        @param name Name of the player
+        @return The bot (owned by the caller), nullptr if the spec is unknown
+    */
+    bs_player *make_bot(const std::string& spec, const std::string& name);
+
+}
+
+
+#endif
@@ -0,0 +1,155 @@
+/*!
+    Bounded lock-free queue between threads
+*/
+
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+
+namespace bship{
+    template<class T> class bounded_queue;
+}
+
+
+
+/*!
+    @class bounded_queue
+
+    @brief Bounded multi-producer multi-consumer queue
+
+    A ring of slots, each with a sequence number telling whether it is
+    free for the producer or ready for the consumer of the current lap
+    (D. Vyukov's bounded MPMC queue): a push or a pop is one compare and
+    swap on the position plus one release store, with no lock.
+
+    The memory is allocated once: when the queue is full, push() waits
+    (spinning, then yielding, then sleeping) until a consumer makes room,
+    which slows the producers down to the pace of the consumers instead of
+    buffering without limit. The waits are counted (see get_stalls())
+*/
+template<class T>
+class bship::bounded_queue{
+public:
+
+    /// Constructor, the capacity is rounded up to a power of 2
+    explicit bounded_queue(size_t capacity)
+    :   mask(round_up(capacity) - 1),
+        slots(new slot[mask + 1]),
+        head(0),
+        tail(0),
+        stalls(0)
+    {
+        for(size_t i=0; i<=mask; ++i) slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+
+    bounded_queue(const bounded_queue&) = delete;
+    bounded_queue& operator=(const bounded_queue&) = delete;
+
+
+    /// Adds an element, false if the queue is full
+    bool try_push(const T& v){
+        size_t pos = head.load(std::memory_order_relaxed);
+        for(;;){
+            slot& s = slots[pos & mask];
+            size_t seq = s.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+            if(diff == 0){
+                if(head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    s.value = v;
+                    s.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0){
+                return false;
+            }
+            else{
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+
+    /// Adds an element, waits while the queue is full
+    void push(const T& v){
+        if(try_push(v)) return;
+
+        stalls.fetch_add(1, std::memory_order_relaxed);
+        for(int k=0; !try_push(v); ++k){
+            if(k < 64) continue;
+            else if(k < 128) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+
+    /// Takes the oldest element, false if the queue is empty
+    bool try_pop(T& v){
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for(;;){
+            slot& s = slots[pos & mask];
+            size_t seq = s.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+
+            if(diff == 0){
+                if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    v = s.value;
+                    s.seq.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0){
+                return false;
+            }
+            else{
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+
+    /// Maximum number of elements
+    size_t capacity() const { return mask + 1; }
+
+
+    /// Number of push() calls that had to wait for room
+    uint64_t get_stalls() const { return stalls.load(std::memory_order_relaxed); }
+
+
+private:
+
+    /// Element and its sequence number
+    struct slot{
+        std::atomic<size_t>  seq;
+        T                    value;
+    };
+
+
+    /// Smallest power of 2 not less than n (at least 2)
+    static size_t round_up(size_t n){
+        size_t p = 2;
+        while(p < n) p <<= 1;
+        return p;
+    }
+
+
+    const size_t                       mask;     ///< capacity - 1
+    std::unique_ptr<slot[]>            slots;    ///< the ring
+    alignas(64) std::atomic<size_t>    head;     ///< next position to push
+    alignas(64) std::atomic<size_t>    tail;     ///< next position to pop
+    alignas(64) std::atomic<uint64_t>  stalls;   ///< pushes that waited
+
+};
+
+
+#endif
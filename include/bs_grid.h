@@ -11,7 +11,9 @@
 #include <unordered_set>
 #include <vector>
 #include <algorithm>
+#include "bitboard.h"
 #include "exceptions.hpp"
+#include "placement_masks.h"
 
 
 // for small printing - comment for ASCII table printing
@@ -130,6 +132,14 @@ public:
     bs_grid(size_t width_, size_t height_);
 
 
+    /// Copy constructor copies all the cells (e.g. to snapshot a grid for another thread)
+    bs_grid(const bs_grid& other);
+
+
+    /// Copy assignment copies all the cells
+    bs_grid& operator=(const bs_grid& other);
+
+
     /// Destructor frees data
     ~bs_grid();
 
@@ -146,23 +156,29 @@ public:
     bool is_ready() const;
 
 
+    /// Clears the grid for a new game (keeps its memory, see battleship::reset())
+    void reset();
+
+
     /// Returns the number of alive ships on the grid
     int get_num_alive_ships() const;
 
 
     /// Returns map of ship number per type
-    std::map<ship_type, uint8_t> get_n_ships() const;
+    const std::map<ship_type, uint8_t>& get_n_ships() const;
 
 
     /// Returns map of maximum ships per type
-    std::map<ship_type, uint8_t> get_max_n_ships() const;
+    const std::map<ship_type, uint8_t>& get_max_n_ships() const;
 
 
     /*!
         @brief Cell access
 
         Easy cell access. Throws index_exception if index is out of bounds.
-        Cells are stored in row-major order
+        Cells are stored in row-major order. The cell may be changed through
+        the reference, so the cells taken for can_place_ship() are rebuilt
+        from the cells before its next call
 
         @param row, col Coordinates of requested cell
         @return Reference to the requested cell
@@ -210,6 +226,23 @@ public:
     bool place_ship(ship_type type, size_t row, size_t col, ship_orientation orient);
 
 
+    /*!
+        @brief Check a ship placement
+
+        Whether place_ship() would place the ship (leaving aside the number of
+        ships of the type), without placing it. On the standard grid sizes this
+        is one AND of a compile-time placement mask (see placement_masks) with
+        the cells taken by ships and shots, rebuilt from the cells first if
+        cell_at() handed one out since
+
+        @param type Type of ship
+        @param row, col Coordinates of the upper-left cell of the ship
+        @param orient Orientation of the ship
+        @return true if the ship fits
+    */
+    bool can_place_ship(ship_type type, size_t row, size_t col, ship_orientation orient);
+
+
     /*!
         @brief Shooting
 
@@ -235,8 +268,36 @@ private:
     std::map<ship_type, uint8_t>  max_n_ships;  ///< maximum number of ships of each type (initialized at runtime)
     int                           alive_ships;  ///< number of alive ships
     int                           cur_ship_id;  ///< id of the ship that is being placed (ids are sequential and start from 0)
+    const bitboard               *masks;        ///< placement masks of the grid size (nullptr if none)
+    bitboard                      taken;        ///< cells taken by ships and shots (kept if masks is set)
+    bool                          stale;        ///< cell_at() was called since taken was built
+
+
+    /// cell_at() for the members, which keep taken up to date themselves
+    cell& at(size_t row, size_t col);
+
+
+    /// Rebuilds taken from the cells
+    void rebuild_taken();
 
 };
 
 
+
+// defined here so that it can be inlined in the other translation units (hot path)
+inline bship::cell& bship::bs_grid::at(size_t row, size_t col){
+    if(row >= height || col >= width)
+        throw index_exception(row, col, "Index out of bounds: ");
+
+    // row-major order
+    return data[row*width + col];
+}
+
+
+inline bship::cell& bship::bs_grid::cell_at(size_t row, size_t col){
+    stale = true;
+    return at(row, col);
+}
+
+
 #endif
\ No newline at end of file
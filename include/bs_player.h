@@ -57,15 +57,21 @@ public:
 
 
     /// Get name
-    std::string get_name();
+    const std::string& get_name() const;
 
 
     /// Set name
     void set_name(std::string& n);
 
 
-    /// Hidden grid setter
-    void set_hidden_grid(bs_grid *hidden);
+    /*!
+        @brief Hidden grid setter
+
+        Called by connect() when the player joins a game, which may be a
+        fresh one without a reset(): derived classes clear their per-game
+        state here too
+    */
+    virtual void set_hidden_grid(bs_grid *hidden);
 
 
     /// Hit grid setter
@@ -86,6 +92,38 @@ public:
     virtual void move();
 
 
+    /*!
+        @brief Game update notification
+
+        Called by the game on both players after every successful move of
+        either player (placement or shot), including the last one. Does
+        nothing by default; bots can use it to start or cancel work in the
+        background while the opponent is thinking (see async_player)
+    */
+    virtual void on_update();
+
+
+    /*!
+        @brief New game
+
+        Called by battleship::reset() to prepare the player for a new game
+        on the same grids. Derived classes clear their per-game state here
+        and should keep their memory, so that games can be replayed
+        without allocating
+    */
+    virtual void reset();
+
+
+    /*!
+        @brief Type of the next ship to place
+
+        The smallest type placed fewer times than the fleet has it, read from
+        the hidden grid: the order the bots place their fleet in, and the
+        ship the game places for a player that runs out of time
+    */
+    ship_type next_ship() const;
+
+
     friend void connect(battleship *game, bs_player *pa, bs_player *pb);    
 
 
@@ -95,8 +133,6 @@ protected:
     bs_grid                *hidden_grid;  ///< pointer to ship placement grid
     bs_grid                *hit_grid;     ///< pointer to hit tracking grid
     battleship             *game;         ///< pointer to game
-    std::vector<ship_type>  stype;        ///< placement: ship types to place
-    size_t                  sindex;       ///< placement: index in stype
 
 };
 
@@ -0,0 +1,95 @@
+/*!
+    Plain C interface of the vectorized environments (see vec_env.h)
+*/
+
+#ifndef BSHIP_C_H
+#define BSHIP_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/// Opaque handle of a set of environments
+typedef struct bship_vec_env bship_vec_env;
+
+
+/// Rewards of the shots (see bship::env_rewards)
+typedef struct bship_rewards{
+    float  miss;       ///< shot into the water
+    float  hit;        ///< shot hitting a ship without sinking it
+    float  sink;       ///< shot sinking a ship (but not the last one)
+    float  win;        ///< shot sinking the last ship
+    float  illegal;    ///< cell out of the grid or shot before
+    int    max_steps;  ///< steps after which an episode is cut (0: twice the number of cells)
+} bship_rewards;
+
+
+/// Fills the default rewards
+void bship_default_rewards(bship_rewards *rewards);
+
+
+/*!
+    @brief Create environments
+
+    @param n_envs Number of environments
+    @param width, height Dimensions of the grid (at most 128 cells)
+    @param n_threads Threads stepping the environments (1: the caller only)
+    @param seed Seed of the layouts
+    @param rewards Rewards of the shots (NULL for the defaults)
+    @return Handle of the environments, NULL on error
+*/
+bship_vec_env *bship_vec_env_create(size_t n_envs, size_t width, size_t height, int n_threads,
+                                    uint64_t seed, const bship_rewards *rewards);
+
+
+/// Destroys environments created by bship_vec_env_create() (NULL is ignored)
+void bship_vec_env_destroy(bship_vec_env *env);
+
+
+/// Number of environments
+size_t bship_vec_env_n_envs(const bship_vec_env *env);
+
+
+/// Floats of the observation of one environment (3 planes of width * height: hits, misses, sunk ships)
+size_t bship_vec_env_obs_size(const bship_vec_env *env);
+
+
+/*!
+    @brief Reset every environment
+
+    @param env Environments
+    @param obs Observations, n_envs * obs_size floats (may be NULL)
+    @return 0, -1 on error
+*/
+int bship_vec_env_reset(bship_vec_env *env, float *obs);
+
+
+/*!
+    @brief Step every environment
+
+    Finished environments are reset, their observation is the first one of
+    the next episode. The output buffers may be NULL
+
+    @param env Environments
+    @param actions One cell index (row * width + col) per environment
+    @param obs Observations, n_envs * obs_size floats
+    @param rewards One reward per environment
+    @param dones 1 where the episode ended, 0 elsewhere
+    @return 0, -1 on error
+*/
+int bship_vec_env_step(bship_vec_env *env, const int32_t *actions, float *obs, float *rewards, uint8_t *dones);
+
+
+/// Shots of the last finished episode of environment i (0 if none, -1 on error)
+int bship_vec_env_last_length(const bship_vec_env *env, size_t i);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
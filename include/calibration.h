@@ -0,0 +1,147 @@
+/*!
+    Calibration of the difficulty of slick_player against a reference bot
+*/
+
+#ifndef CALIBRATION_HPP
+#define CALIBRATION_HPP
+
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "bs_player.h"
+#include "outcome_stats.h"
+
+
+namespace bship{
+
+    /// What a difficulty is calibrated on
+    enum calib_target{
+        CT_WIN_RATE,   ///< win rate of slick_player against the reference
+        CT_SHOTS       ///< mean shots slick_player takes to win
+    };
+
+
+    /// A calibrated difficulty
+    struct calib_point{
+        calib_target  kind;        ///< what target is
+        double        target;      ///< win rate or shots aimed at
+        float         peek_prob;   ///< difficulty of slick_player found
+        double        value;       ///< value measured at peek_prob
+        double        half_width;  ///< half width of the confidence interval of value (valid at any stop)
+        uint64_t      games;       ///< games played at peek_prob
+    };
+
+
+    /// Settings of the calibration
+    struct calib_config{
+        int       threads     = 1;        ///< threads playing games
+        uint64_t  batch       = 256;      ///< games per thread between two tests
+        uint64_t  max_games   = 200000;   ///< games of one difficulty at most
+        double    tolerance   = 0.01;     ///< half width of the confidence interval that is tight enough
+        double    z           = 2.576;    ///< normal quantile of the confidence level of a whole measure (99%)
+        float     resolution  = 1.0f / 1024;  ///< difficulty interval at which the search stops
+    };
+
+
+    class difficulty_calibrator;
+
+
+    /// Writes a difficulty table, false on error
+    bool save_difficulty_table(const std::string& path, const std::string& reference,
+                               const std::vector<calib_point>& table);
+
+
+    /*!
+        @brief Read a difficulty table
+
+        @param path Table written by save_difficulty_table()
+        @param reference Filled with the reference bot of the table (may be nullptr)
+        @return The entries, empty if the file can not be read
+    */
+    std::vector<calib_point> load_difficulty_table(const std::string& path, std::string *reference=nullptr);
+
+}
+
+
+
+/*!
+    @class difficulty_calibrator
+
+    @brief Finds the peek_prob of slick_player giving a target strength
+
+    Measures slick_player against a reference bot in batches of games on
+    several threads (half of the games with each player moving first), and
+    after every batch runs a sequential test on the running mean: measuring
+    stops as soon as the confidence interval is either clear of the target
+    (the difficulty is too low or too high, which is all the search needs)
+    or tighter than the tolerance around it. The intervals form a confidence
+    sequence (a normal mixture boundary, about 1.4 times wider than a fixed
+    sample interval), which covers the value at every batch at once, so that
+    stopping at the first clear one keeps the confidence level. The win rate and the shots to
+    win are monotonic in peek_prob, so a bisection over [0, 1] finds the
+    difficulty; most of its steps are far from the target and take a single
+    batch, only the last ones play many games
+*/
+class bship::difficulty_calibrator{
+public:
+
+    /// Creates a bot given its name (see placement_stats::sample())
+    typedef std::function<bs_player*(const std::string&)> bot_factory;
+
+
+    /*!
+        @brief Constructor
+
+        @param make_reference Factory of the reference opponent (called once per thread and batch)
+        @param config Threads, batch size and stopping rules
+    */
+    difficulty_calibrator(const bot_factory& make_reference, const calib_config& config=calib_config());
+
+
+    /*!
+        @brief Measure a difficulty
+
+        @param kind What is measured
+        @param peek_prob Difficulty of slick_player
+        @param target Value the test is against (the interval only has to be clear of it)
+        @return Measured value, its confidence interval and games
+    */
+    calib_point measure(calib_target kind, float peek_prob, double target);
+
+
+    /*!
+        @brief Find the difficulty of a target
+
+        @param kind What the target is
+        @param target Win rate (in [0, 1]) or mean shots to win
+        @return The difficulty found, with its measure (the closest to the
+                target if the search reaches the resolution without a measure
+                matching it)
+    */
+    calib_point calibrate(calib_target kind, double target);
+
+
+    /// Calibrates every target
+    std::vector<calib_point> table(calib_target kind, const std::vector<double>& targets);
+
+
+    /// Games played so far
+    uint64_t get_games() const;
+
+
+private:
+
+    /// Plays a batch on every thread, adds slick_player's results
+    void play_batch(float peek_prob, running_stats& wins, running_stats& shots);
+
+
+    bot_factory     make_ref;   ///< reference opponent
+    calib_config    cfg;        ///< settings
+    uint64_t        games;      ///< games played so far
+
+};
+
+
+#endif
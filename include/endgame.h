@@ -0,0 +1,146 @@
+/*!
+    Exact endgame search for the shooting phase
+*/
+
+#ifndef ENDGAME_HPP
+#define ENDGAME_HPP
+
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "bitboard.h"
+#include "bs_grid.h"
+#include "fleet_counter.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+    class endgame_solver;
+}
+
+
+
+/*!
+    @class endgame_solver
+
+    @brief Endgame solver
+
+    Finds the shot minimizing the expected number of shots left until the whole
+    fleet is sunk, by an expectimax search over all fleet layouts consistent with
+    a hit grid. Every cell of the actual layout has to be shot anyway, so the
+    search minimizes the expected number of misses, which lets it cut off any
+    shot that misses more often than the best one found so far.
+
+    Layouts and observations are bitboards. Inside a search, positions are keyed
+    in a transposition table by the set of layouts left (all the expected number
+    of misses depends on), so different shot orders reaching the same set are
+    searched once. Final results are also kept by observation (shot and hit cells),
+    which stays valid across moves and games of the same size and fleet.
+
+    The search only runs when the number of consistent layouts (counted with
+    fleet_counter) is at most max_layouts, and gives up after a fixed number of
+    nodes. Otherwise best_shot() returns false and the caller keeps using its own
+    heuristic, which makes the solver a drop-in for the shooting phase of any bs_player:
+
+        size_t r, c;
+        if(endgame.best_shot(*hit_grid, r, c)) game->shoot_at(r, c);
+        else ...   // heuristic shot
+*/
+class bship::endgame_solver{
+public:
+
+    /*!
+        @brief Constructor with grid size and fleet
+
+        @param width, height Dimensions of the grid (at most 128 cells)
+        @param fleet Number of ships per type (same format as bs_grid::get_max_n_ships())
+        @param max_layouts Largest number of consistent layouts to search over (at most 64)
+    */
+    endgame_solver(size_t width, size_t height, const std::map<ship_type, uint8_t>& fleet, size_t max_layouts=64);
+
+
+    /// Constructs a solver for the size and fleet of the given grid
+    explicit endgame_solver(const bs_grid& grid, size_t max_layouts=64);
+
+
+    /*!
+        @brief Best shot
+
+        Searches for the shot minimizing the expected number of remaining shots
+
+        @param obs Observation grid (the player's hit grid)
+        @param row, col Set to the coordinates of the best shot if the search ran
+        @return false if the observation has too many consistent layouts
+                (or none at all), true otherwise
+    */
+    bool best_shot(bs_grid& obs, size_t& row, size_t& col);
+
+
+    /// Expected number of shots left (including the best shot) found by the last successful best_shot()
+    double expected_shots() const;
+
+
+    /// Number of consistent layouts counted by the last best_shot()
+    size_t num_layouts() const;
+
+
+    /// Largest number of layouts searched over
+    size_t get_max_layouts() const;
+
+
+    /// Number of entries in the transposition table
+    size_t table_size() const;
+
+
+private:
+
+    /// observation of the search: cells shot and cells hit
+    struct tt_key{
+        bitboard shot;
+        bitboard hit;
+        bool operator==(const tt_key& o) const { return shot == o.shot && hit == o.hit; }
+    };
+
+    /// hash of tt_key
+    struct tt_hash{
+        size_t operator()(const tt_key& k) const { return k.shot.hash() ^ (k.hit.hash() * 31); }
+    };
+
+    /// result of a search
+    struct tt_entry{
+        double  value;   ///< expected number of shots (misses inside the search) left
+        int     cell;    ///< best cell to shoot
+    };
+
+
+    /// Fills layouts with all fleet layouts consistent with the observation
+    bool enumerate(const bitboard& shot, const bitboard& hit);
+
+    /// Places ships covering the hits for enumerate(), left holds the number of ships left per length
+    void place_hits(std::vector<int>& left, const bitboard& occ, const bitboard& missed, const bitboard& hit);
+
+    /// Places the ships left (of length len and shorter) once every hit is covered
+    void place_free(std::vector<int>& left, size_t len, int min_idx, const bitboard& occ, const bitboard& missed);
+
+    /// Expectimax over the layouts in cand (bits index layouts, none of them finished), returns expected misses left
+    double search(const bitboard& shot, uint64_t cand, int& best);
+
+
+    size_t                                        width;        ///< width of the grid
+    size_t                                        height;       ///< height of the grid
+    size_t                                        max_layouts;  ///< search limit
+    fleet_counter                                 counter;      ///< counts layouts before enumerating them
+    std::vector<int>                              ships;        ///< number of ships per length
+    std::vector<std::vector<bitboard>>            placements;   ///< all placements of each ship length
+    std::vector<bitboard>                         layouts;      ///< consistent layouts
+    size_t                                        nodes;        ///< enumeration or search nodes visited (bounded)
+    std::unordered_map<tt_key, tt_entry, tt_hash> table;        ///< results by observation
+    std::unordered_map<uint64_t, tt_entry>        subsets;      ///< transposition table of the current search, by layouts left
+    double                                        last_value;   ///< result of the last search
+    size_t                                        last_count;   ///< number of layouts counted by the last best_shot()
+
+};
+
+
+#endif
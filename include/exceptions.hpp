@@ -8,12 +8,15 @@
 #include <iostream>
 #include <exception>
 #include <string>
+#include "metrics.h"
 
 
 namespace bship{
     class bship_exception;
     class index_exception;
     class illegal_move_exception;
+    class time_exception;
+    class protocol_exception;
 }
 
 
@@ -27,6 +30,12 @@ namespace bship{
 class bship::bship_exception : public std::exception{
 public:
 
+    /// Constructor, counts the exception (see metrics)
+    bship_exception(){
+        BS_COUNT(MC_EXCEPTIONS);
+    }
+
+
     /*!
         @brief Base class what()
 
@@ -54,24 +63,24 @@ public:
 class bship::index_exception : public bship_exception{
     int          _row_idx;   //< row index
     int          _col_idx;   //< column index
-    std::string  _msg;       //< message of the exception
+    const char  *_detail;    //< custom message (not copied)
+    std::string  _msg;       //< message of the exception (built by what())
 
 public:
 
     /*!
         @brief Index exception constructor
 
-        Constructs an index_exception given indices and a message
+        Constructs an index_exception given indices and a message.
+        Nothing is allocated until what() is called
 
         @param row Row index
         @param col Column index
-        @param msg Custom message (default: "Error at index")
+        @param msg Custom message, a string literal (default: "Error at index")
     */
     index_exception(int row, int col, const char* msg = "Error at index")
-    :   _row_idx(row), _col_idx(col)
-    {
-        _msg = std::string("Index exception: ") + std::string(msg) + " (" + std::to_string(_row_idx) + ", " + std::to_string(_col_idx) + ")";
-    }
+    :   _row_idx(row), _col_idx(col), _detail(msg)
+    {}
 
 
     /*!
@@ -80,6 +89,8 @@ public:
         @return User-supplied message or default "Error at index (i, j)"
     */
     const char *what(){
+        if(_msg.empty())
+            _msg = std::string("Index exception: ") + std::string(_detail) + " (" + std::to_string(_row_idx) + ", " + std::to_string(_col_idx) + ")";
     	return _msg.c_str();
     }
 
@@ -95,19 +106,21 @@ public:
     This exception is thrown in case an invalid game move is attempted
 */
 class bship::illegal_move_exception : public bship_exception{
-    std::string  _msg;       //< message of the exception
+    const char  *_detail;    //< custom message (not copied)
+    std::string  _msg;       //< message of the exception (built by what())
 
 public:
 
     /*!
         @brief Illegal move exception constructor
 
-        Constructs an illegal_move_exception given a message
+        Constructs an illegal_move_exception given a message.
+        Nothing is allocated until what() is called
 
-        @param msg Custom message (default: "Illegal move")
+        @param msg Custom message, a string literal (default: "Illegal move")
     */
     explicit illegal_move_exception(const char* msg = "Illegal move")
-    :   _msg(std::string("Illegal move exception: ") + msg)
+    :   _detail(msg)
     {}
 
 
@@ -116,6 +129,88 @@ public:
 
         @return User-supplied message or default "Illegal move"
     */
+    const char *what(){
+        if(_msg.empty()) _msg = std::string("Illegal move exception: ") + _detail;
+    	return _msg.c_str();
+    }
+
+};
+
+
+
+/*!
+    @class time_exception
+
+    @brief Time control exception
+
+    This exception is thrown when a player moves after its deadline
+    (see battleship::set_time_control()). The move is not made; it
+    unwinds the player's move() back to the game, which applies its
+    overrun policy
+*/
+class bship::time_exception : public bship_exception{
+    const char  *_detail;    //< custom message (not copied)
+    std::string  _msg;       //< message of the exception (built by what())
+
+public:
+
+    /*!
+        @brief Time exception constructor
+
+        Constructs a time_exception given a message.
+        Nothing is allocated until what() is called
+
+        @param msg Custom message, a string literal (default: "Out of time")
+    */
+    explicit time_exception(const char* msg = "Out of time")
+    :   _detail(msg)
+    {}
+
+
+    /*!
+        @brief Overridden what()
+
+        @return User-supplied message or default "Out of time"
+    */
+    const char *what(){
+        if(_msg.empty()) _msg = std::string("Time exception: ") + _detail;
+    	return _msg.c_str();
+    }
+
+};
+
+
+
+/*!
+    @class protocol_exception
+
+    @brief External player protocol exception
+
+    This exception is thrown when an external player (see external_player)
+    can not be started or breaks the protocol
+*/
+class bship::protocol_exception : public bship_exception{
+    std::string  _msg;       //< message of the exception
+
+public:
+
+    /*!
+        @brief Protocol exception constructor
+
+        Constructs a protocol_exception given a message
+
+        @param msg Custom message (default: "Protocol error")
+    */
+    explicit protocol_exception(const std::string& msg = "Protocol error")
+    :   _msg(std::string("Protocol exception: ") + msg)
+    {}
+
+
+    /*!
+        @brief Overridden what()
+
+        @return User-supplied message or default "Protocol error"
+    */
     const char *what(){
     	return _msg.c_str();
     }
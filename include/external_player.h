@@ -0,0 +1,169 @@
+/*!
+    A battleship player running as a separate program
+*/
+
+#ifndef EXTERNAL_PLAYER_HPP
+#define EXTERNAL_PLAYER_HPP
+
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+    class battleship;
+    class external_player;
+}
+
+
+
+/*!
+    @class external_player
+
+    @brief External battleship player
+
+    Runs a bot executable as a child process and talks to it over its
+    standard input and output, one message per line (in the spirit of
+    chess engines' UCI). Bots can be written in any language.
+
+        engine -> bot                          bot -> engine
+        bship 1                                bshipok [name]
+        newgame <width> <height> <len>x<n>...
+        place <id> [ms]                        placement <id> <len> <row> <col> <h|v> ...
+        shoot <id> [ms]                        shot <id> <row> <col>
+        result <row> <col> <miss|hit|sink>
+        gameover <win|loss>
+        quit
+                                               info <anything>
+
+    The whole fleet is placed with a single placement message, listing
+    every ship. A shot's result is sent before the next request. Requests
+    carry an id the reply must repeat (replies to stale requests are
+    dropped) and the time left for the reply in milliseconds, if the game
+    has time control (see battleship::set_time_control()). Lines starting
+    with info are ignored, anything else is a protocol error.
+
+    Messages are buffered and written with one system call per request.
+    The round-trip time of every request is measured. A bot that closed
+    its input makes the write throw protocol_exception, without a SIGPIPE
+    and without changing the signal handling of the process.
+
+    Illegal placements or shots from the bot are replaced with random
+    ones. If the bot does not reply before the deadline, move() returns
+    without moving and the game applies its overrun policy
+*/
+class bship::external_player : public bs_player {
+public:
+
+    /*!
+        @brief Constructor with command line
+
+        Starts the bot and waits for its handshake
+
+        @param argv Command line of the bot (program and arguments, the program is looked up in PATH)
+        @param nm Name of the player (the bot's own name is used if empty)
+        @throw protocol_exception if the bot can not be started or does not answer the handshake
+    */
+    external_player(const std::vector<std::string>& argv, std::string nm="");
+
+
+    /// Destructor asks the bot to quit (and kills it if it does not)
+    ~external_player();
+
+
+    void move();
+
+
+    /// Tells the bot the game is over
+    void on_update();
+
+
+    /// Number of requests answered by the bot
+    size_t get_num_requests() const;
+
+
+    /// Mean round-trip time of the requests
+    std::chrono::nanoseconds get_mean_latency() const;
+
+
+    /// Largest round-trip time of a request
+    std::chrono::nanoseconds get_max_latency() const;
+
+
+private:
+
+    /// A ship of the bot's placement
+    struct placement{
+        ship_type         type;
+        size_t            row;
+        size_t            col;
+        ship_orientation  orient;
+    };
+
+
+    /// Starts the child process
+    void launch(const std::vector<std::string>& argv);
+
+
+    /// Closes the pipes and reaps the child, killed if it does not exit within grace_ms
+    void stop(int grace_ms);
+
+
+    /// Queues a line to be sent with the next flush()
+    void send(const std::string& line);
+
+
+    /// Writes the queued lines to the bot
+    void flush();
+
+
+    /// Reads the next line from the bot, false on timeout (negative: no timeout)
+    bool read_line(std::string& line, int timeout_ms);
+
+
+    /*!
+        @brief Sends a request and waits for its reply
+
+        @param cmd Request (place or shoot)
+        @param reply Set to the reply, without its keyword and id
+        @return false if the deadline passed first
+    */
+    bool request(const std::string& cmd, std::string& reply);
+
+
+    /// Starts a new game on the bot side
+    void new_game();
+
+
+    /// Places a random ship (when the bot's placement is unusable)
+    void place_random();
+
+
+    /// Tells the bot the game is over
+    void end_game();
+
+
+    pid_t                     pid;          ///< child process
+    int                       to_bot;       ///< write end of the bot's stdin
+    int                       from_bot;     ///< read end of the bot's stdout
+    std::string               out_buf;      ///< lines waiting for flush()
+    std::string               in_buf;       ///< bytes read but not yet split into lines
+    unsigned long             next_id;      ///< id of the next request
+    bool                      in_game;      ///< the bot knows about the game in progress
+    bool                      moving;       ///< inside move() (the last shot's result goes before gameover)
+    bool                      fleet_known;  ///< the bot's placement has been requested
+    std::vector<placement>    fleet;        ///< bot's placement of the game in progress
+    size_t                    fleet_idx;    ///< next ship of fleet to place
+    size_t                    n_requests;   ///< number of answered requests
+    std::chrono::nanoseconds  total_rtt;    ///< sum of the round-trip times
+    std::chrono::nanoseconds  max_rtt;      ///< largest round-trip time
+
+};
+
+
+#endif
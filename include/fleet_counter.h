@@ -0,0 +1,161 @@
+/*!
+    Exact fleet arrangement counter
+*/
+
+#ifndef FLEET_COUNTER_HPP
+#define FLEET_COUNTER_HPP
+
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "bs_grid.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+
+    /// Number of fleet arrangements (a standard 10x10 game needs ~34 bits, 128 leaves plenty of room)
+    typedef unsigned __int128 arr_count;
+
+
+    /// Decimal representation of an arrangement count
+    std::string to_string(arr_count n);
+
+
+    class fleet_counter;
+
+}
+
+
+
+/*!
+    @class fleet_counter
+
+    @brief Exact arrangement counter
+
+    Counts the fleet arrangements consistent with a partial observation (a hit grid)
+    and the number of them covering each cell, which gives the exact hit probability
+    of every cell. Same-type ships are indistinguishable, so every set of placements
+    is counted once.
+
+    Uses a broken-profile DP over the cells in row-major order. The state is the
+    remaining length of a vertical ship crossing each column, the remaining length
+    of the horizontal ship in the current row and the ships not placed yet.
+    Layers are memoized in hash tables; per-cell counts use a forward-backward
+    pass that keeps forward layers only at row boundaries and recomputes the
+    current row, so memory stays at a couple of rows worth of states.
+
+    The shorter grid dimension must not exceed 16 cells (the grid is transposed
+    internally if needed)
+*/
+class bship::fleet_counter{
+public:
+
+    /*!
+        @brief Constructor with grid size and fleet
+
+        @param width, height Dimensions of the grid
+        @param fleet Number of ships per type (same format as bs_grid::get_max_n_ships())
+    */
+    fleet_counter(size_t width, size_t height, const std::map<ship_type, uint8_t>& fleet);
+
+
+    /// Constructs a counter for the size and fleet of the given grid
+    explicit fleet_counter(const bs_grid& grid);
+
+
+    /*!
+        @brief Count arrangements
+
+        Counts the arrangements consistent with the observation without computing
+        per-cell counts. Cells of the observation in state CS_MISSED must stay empty,
+        cells in state CS_DESTROYED must be covered, any other cell is unknown.
+
+        @param obs Observation grid (usually a player's hit grid)
+        @return Number of consistent arrangements
+    */
+    arr_count count(bs_grid& obs);
+
+
+    /*!
+        @brief Count arrangements and per-cell coverage
+
+        Same as count(), but also computes the number of consistent arrangements
+        covering each cell (see cover_count() and hit_prob())
+
+        @param obs Observation grid (usually a player's hit grid)
+        @return Number of consistent arrangements
+    */
+    arr_count solve(bs_grid& obs);
+
+
+    /// Arrangement count of the last count() or solve()
+    arr_count get_count() const;
+
+
+    /// Number of arrangements covering the cell (valid after solve())
+    arr_count cover_count(size_t row, size_t col) const;
+
+
+    /// Probability that the cell contains a ship (valid after solve(), 0 if nothing is consistent)
+    double hit_prob(size_t row, size_t col) const;
+
+
+    /*!
+        @brief Set stop flag
+
+        count() and solve() poll the flag once per cell and give up (returning 0,
+        with no per-cell counts) as soon as it is set, so that work started on a
+        background thread can be cancelled
+
+        @param flag Flag to poll, nullptr to never stop
+    */
+    void set_stop_flag(const std::atomic<bool>* flag);
+
+
+private:
+
+    /// True if the stop flag is set
+    bool stop_requested() const;
+
+    /// Reads the observation into obs_cells (in internal, possibly transposed, order)
+    void read_obs(bs_grid& obs);
+
+    /// Index of grid cell (row, col) in internal order
+    size_t cell_index(size_t row, size_t col) const;
+
+    /// Calls emit(next_state, covered) for every transition of state s over internal cell i
+    template<class Emit>
+    void expand(uint64_t s, size_t i, Emit emit) const;
+
+    /// Forward pass only, with counts of type Count
+    template<class Count>
+    arr_count run_count();
+
+    /// Forward-backward pass filling covers, with counts of type Count
+    template<class Count>
+    arr_count run_solve();
+
+    size_t                  width;       ///< width of the grid
+    size_t                  height;      ///< height of the grid
+    size_t                  dp_cols;     ///< internal width (shorter dimension)
+    size_t                  dp_rows;     ///< internal height (longer dimension)
+    bool                    transposed;  ///< internal order is column-major
+    bool                    wide;        ///< counts may not fit in 64 bits
+    std::vector<size_t>     lens;        ///< length of each ship type
+    std::vector<uint64_t>   radix;       ///< place value of each ship type in the fleet part of the state
+    std::vector<uint64_t>   radix_span;  ///< place value of the next ship type (to extract a digit)
+    uint64_t                full_fleet;  ///< fleet part of the initial state
+    std::vector<uint8_t>    obs_cells;   ///< observation: 0 unknown, 1 must be empty, 2 must be covered
+    arr_count               total;       ///< result of the last count
+    std::vector<arr_count>  covers;      ///< per-cell cover counts (internal order)
+    std::vector<uint8_t>    solved_obs;  ///< observation covers belong to (memoized)
+    const std::atomic<bool> *stop_flag;  ///< cancels a running count when set
+
+};
+
+
+#endif
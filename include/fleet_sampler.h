@@ -0,0 +1,158 @@
+/*!
+    Random fleet layouts in bulk
+*/
+
+#ifndef FLEET_SAMPLER_HPP
+#define FLEET_SAMPLER_HPP
+
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "bitboard.h"
+#include "bs_grid.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+
+    /// Distribution of the sampled layouts
+    enum sampler_mode{
+        SM_UNIFORM,   ///< exactly uniform over all legal layouts
+        SM_FAST       ///< ships placed one after the other (biased towards the edges, like bs_player)
+    };
+
+
+    /// Placement of one ship
+    struct ship_placement{
+        ship_type         type;    ///< type of the ship
+        uint8_t           row;     ///< row of the upper-left cell
+        uint8_t           col;     ///< column of the upper-left cell
+        ship_orientation  orient;  ///< orientation
+    };
+
+
+    class fleet_sampler;
+
+}
+
+
+
+/*!
+    @class fleet_sampler
+
+    @brief Random fleet layout generator
+
+    Draws complete legal layouts of a fleet without going through a game:
+    every placement of every ship length is precomputed as a bitboard, so
+    drawing a layout is a few random numbers and bitboard tests.
+
+    In SM_UNIFORM mode, every ship (largest first) is drawn uniformly among
+    all its placements and the whole layout is drawn again as soon as a ship
+    overlaps another one. The accepted layouts are uniform over the ordered
+    layouts, and every unordered layout (same-type ships are interchangeable)
+    is the same number of ordered ones, so they are uniform over the legal
+    layouts too. About 2 in 5 draws are accepted on the standard 10x10 game.
+
+    In SM_FAST mode, every ship is drawn again until it fits among the ships
+    already placed, which never draws a whole layout again (except from a
+    dead end) but over-weights the placements left after the first ships.
+
+    Every sampler has its own random generator (splitmix64): use one per thread
+*/
+class bship::fleet_sampler{
+public:
+
+    /*!
+        @brief Constructor with grid size and fleet
+
+        @param width, height Dimensions of the grid (at most 128 cells)
+        @param fleet Number of ships per type (same format as bs_grid::get_max_n_ships())
+        @param mode Distribution of the layouts
+        @param seed Seed of the random generator
+    */
+    fleet_sampler(size_t width, size_t height, const std::map<ship_type, uint8_t>& fleet,
+                  sampler_mode mode=SM_UNIFORM, uint64_t seed=0x9E3779B97F4A7C15ull);
+
+
+    /// Constructs a sampler for the size and fleet of the given grid
+    explicit fleet_sampler(const bs_grid& grid, sampler_mode mode=SM_UNIFORM, uint64_t seed=0x9E3779B97F4A7C15ull);
+
+
+    /*!
+        @brief Draw a layout
+
+        @param out Placements of the ships, largest first (get_n_ships() of them)
+        @return Cells covered by the layout
+    */
+    bitboard sample(ship_placement *out);
+
+
+    /// Draws a layout, returns its placements (valid until the next draw)
+    const std::vector<ship_placement>& sample();
+
+
+    /*!
+        @brief Draw a layout onto a grid
+
+        Places every ship of a new layout with bs_grid::place_ship(); the
+        grid must be empty (see bs_grid::reset()) and have the same size and fleet
+
+        @param grid Grid to place the ships on
+    */
+    void place(bs_grid& grid);
+
+
+    /// Number of ships of a layout
+    size_t get_n_ships() const;
+
+
+    /// Distribution of the layouts
+    sampler_mode get_mode() const;
+
+
+    /// Grid width
+    size_t get_width() const;
+
+
+    /// Grid height
+    size_t get_height() const;
+
+
+    /// Number of ships per type
+    const std::map<ship_type, uint8_t>& get_fleet() const;
+
+
+    /// Reseeds the random generator
+    void seed(uint64_t s);
+
+
+private:
+
+    /// Next random number (splitmix64)
+    inline uint64_t next(){
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+
+    /// Uniform random number in [0, n)
+    inline size_t below(size_t n){ return (size_t) (((next() >> 32) * n) >> 32); }
+
+
+    size_t                                      width;       ///< grid width
+    size_t                                      height;      ///< grid height
+    std::map<ship_type, uint8_t>                fleet;       ///< ships per type
+    sampler_mode                                mode;        ///< distribution of the layouts
+    uint64_t                                    state;       ///< random generator state
+    std::vector<ship_type>                      ships;       ///< ships of a layout, largest first
+    std::vector<std::vector<bitboard>>          masks;       ///< cells of every placement, by ship length
+    std::vector<std::vector<ship_placement>>    positions;   ///< every placement, by ship length
+    std::vector<ship_placement>                 layout;      ///< last layout drawn by sample()
+
+};
+
+
+#endif
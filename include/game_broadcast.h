@@ -0,0 +1,142 @@
+/*!
+    Fan-out of game events to spectators
+*/
+
+#ifndef GAME_BROADCAST_HPP
+#define GAME_BROADCAST_HPP
+
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "battleship.h"
+#include "game_listener.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+
+    /// Encoded event, shared by every spectator it is sent to
+    typedef std::shared_ptr<const std::string> event_buffer;
+
+
+    class game_broadcast;
+
+}
+
+
+
+/*!
+    @class game_broadcast
+
+    @brief Spectator broadcast of a game
+
+    Listens to a game and encodes each event once, as a line of text, into a
+    reference-counted buffer. Every subscriber gets a pointer to the same
+    buffer in its queue, so the cost of an event does not depend on its size
+    and nothing is copied per spectator. Messages:
+
+        shot <A|B> <row> <col> <miss|hit|sink>
+        gameover <A|B>
+        snapshot <width> <height> <A|B to move> <total shots>
+        grid <A|B> <cells>     (after snapshot, one character per cell in row-major
+                                order: . not shot, S ship, o missed, X hit)
+
+    Spectators may be players of the game, so nothing tells where a ship is
+    before it is hit: placements are not broadcast and, until the game is
+    over, the grids show the ship cells not shot yet as empty. The game over
+    message is followed by a snapshot with the whole fleets
+
+    Queues are bounded: a subscriber that falls max_queue events behind has
+    its queue replaced by a snapshot of the game (snapshot and grid lines
+    in one buffer, also shared between the subscribers resynced at the same
+    point), so a slow spectator never holds up the game nor grows without
+    bound. New subscribers start with a snapshot too.
+
+    Events are published on the thread making the moves; poll() may be
+    called from any thread. subscribe() reads the game and must be called
+    from the game's thread
+*/
+class bship::game_broadcast : public game_listener {
+public:
+
+    /*!
+        @brief Constructor with game
+
+        Registers the broadcast as a listener of the game
+
+        @param gm Game to broadcast
+        @param max_queue Most events queued per subscriber before it is resynced
+    */
+    explicit game_broadcast(battleship *gm, size_t max_queue=256);
+
+
+    /// Destructor unregisters the broadcast from its game
+    ~game_broadcast();
+
+
+    /// Adds a subscriber, returns its id
+    size_t subscribe();
+
+
+    /// Removes a subscriber
+    void unsubscribe(size_t id);
+
+
+    /*!
+        @brief Poll events
+
+        Moves the events queued for a subscriber to the end of out
+
+        @param id Subscriber id
+        @param out Buffers to append to
+        @return Number of buffers appended
+    */
+    size_t poll(size_t id, std::vector<event_buffer>& out);
+
+
+    /// Encodes the current state of the game (snapshot and grid lines, fleets hidden until the game is over), from the game's thread only
+    event_buffer snapshot();
+
+
+    /// Number of subscribers
+    size_t num_subscribers();
+
+
+    /// Number of times a subscriber was resynced
+    size_t num_resyncs();
+
+
+    void on_place(battleship& game, bool by_pa, ship_type type, size_t row, size_t col, ship_orientation orient);
+    void on_shot(battleship& game, bool by_pa, size_t row, size_t col, std::pair<shot_result, int> res);
+    void on_game_over(battleship& game, bool pa_won);
+
+
+private:
+
+    /// Queues an event for every subscriber
+    void publish(const std::string& msg);
+
+
+    /// Queues an encoded event for every subscriber
+    void publish(const event_buffer& buf);
+
+
+    battleship                                  *game;       ///< game broadcast
+    size_t                                       max_queue;  ///< queue bound
+    std::mutex                                   mtx;        ///< guards subs and resyncs
+    std::map<size_t, std::deque<event_buffer>>   subs;       ///< queued events by subscriber
+    size_t                                       next_id;    ///< id of the next subscriber
+    size_t                                       resyncs;    ///< number of resyncs
+    uint64_t                                     seq;        ///< number of events published
+    event_buffer                                 snap;       ///< last snapshot
+    uint64_t                                     snap_seq;   ///< seq of the last snapshot
+
+};
+
+
+#endif
@@ -0,0 +1,68 @@
+/*!
+    Observer of battleship game events
+*/
+
+#ifndef GAME_LISTENER_HPP
+#define GAME_LISTENER_HPP
+
+
+#include <utility>
+#include "bs_grid.h"
+
+
+namespace bship{
+    class battleship;
+    class game_listener;
+}
+
+
+
+/*!
+    @class game_listener
+
+    @brief Game event listener
+
+    Receives the moves of a game as they are made (see battleship::add_listener()).
+    Listeners are called synchronously on the thread making the move, after
+    the game state has been updated. All the handlers do nothing by default
+*/
+class bship::game_listener{
+public:
+
+    /// Base class destructor must be virtual
+    virtual ~game_listener();
+
+
+    /*!
+        @brief Ship placed
+
+        @param game Game the ship was placed in
+        @param by_pa true if player A placed the ship
+        @param type, row, col, orient Placement (see battleship::place_ship())
+    */
+    virtual void on_place(battleship& game, bool by_pa, ship_type type, size_t row, size_t col, ship_orientation orient);
+
+
+    /*!
+        @brief Shot made
+
+        @param game Game the shot was made in
+        @param by_pa true if player A shot
+        @param row, col Cell shot at
+        @param res Result of the shot (see battleship::shoot_at())
+    */
+    virtual void on_shot(battleship& game, bool by_pa, size_t row, size_t col, std::pair<shot_result, int> res);
+
+
+    /*!
+        @brief Game over
+
+        @param game Finished game
+        @param pa_won true if player A won
+    */
+    virtual void on_game_over(battleship& game, bool pa_won);
+
+};
+
+
+#endif
@@ -0,0 +1,200 @@
+/*!
+    Multi-session battleship server
+*/
+
+#ifndef GAME_SERVER_HPP
+#define GAME_SERVER_HPP
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "battleship.h"
+#include "bs_player.h"
+#include "game_broadcast.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+    class battleship;
+    class game_server;
+}
+
+
+
+/*!
+    @class game_server
+
+    @brief Battleship game server
+
+    Hosts any number of concurrent games in a single thread. Clients connect
+    over a Unix domain socket (or, optionally, loopback TCP) and play
+    against an in-process bot (bs_player or slick_player), one game per
+    connection at a time. Messages are lines of text:
+
+        client -> server                server -> client
+        new [random|slick] [diff]       newgame <width> <height> <len>x<n>...
+        place <len> <row> <col> <h|v>   ok
+        shoot <row> <col>               result <row> <col> <miss|hit|sink>
+                                        opp <row> <col> <miss|hit|sink>   (bot's shots)
+                                        gameover <win|loss>
+        list                            games <id>...
+        watch <id>                      ok, then the game's events (see game_broadcast)
+        unwatch                         ok
+        quit
+                                        err <message>                     (on any error)
+
+    The client places first, and shoots first. The bot moves right after the
+    client's move, in the server thread, so a game only advances when its
+    client's input arrives.
+
+    Any client can watch the game of another one. Events are encoded once
+    per game and written to every spectator straight from the shared buffers
+    (with scatter-gather writes); a spectator that does not keep up is
+    resynced from a snapshot instead of slowing down the game.
+
+    The event loop uses epoll with non-blocking sockets and per-connection
+    input and output buffers: all the complete lines read from a client are
+    handled before the replies are written with a single system call, and
+    output that does not fit into the socket waits for it to become writable.
+    On quit (or end of input) a client is not read any more, and is closed
+    once its output is written, or after a bounded linger if it does not read
+    it. No client can block the server
+*/
+class bship::game_server{
+public:
+
+    /*!
+        @brief Constructor with socket path
+
+        Creates the Unix domain socket (replacing any existing file at the path)
+
+        @param socket_path Path of the socket
+        @throw protocol_exception if the socket can not be created
+    */
+    explicit game_server(const std::string& socket_path);
+
+
+    /// Destructor closes every connection and removes the socket file
+    ~game_server();
+
+
+    /*!
+        @brief Listen on TCP
+
+        Also accepts clients on the loopback interface
+
+        @param port TCP port (0 picks any free port)
+        @return Port listened on
+        @throw protocol_exception if the port can not be listened on
+    */
+    uint16_t listen_tcp(uint16_t port);
+
+
+    /// Runs the event loop until stop() is called
+    void run();
+
+
+    /// Stops run() (may be called from any thread or a signal handler)
+    void stop();
+
+
+    /// Number of connected clients
+    size_t num_sessions() const;
+
+
+    /// Number of games finished so far
+    size_t num_games_played() const;
+
+
+private:
+
+    /// A connected client and its game
+    struct session{
+        int                        fd;        ///< client socket
+        std::string                in;        ///< bytes read but not handled yet
+        std::string                out;       ///< replies not written yet
+        bool                       writing;   ///< waiting for the socket to become writable
+        bool                       closing;   ///< quit: closed once out and feed are written
+        std::chrono::steady_clock::time_point linger;  ///< closed then at the latest (if closing)
+        battleship                *game;      ///< game in progress (nullptr if none)
+        bs_player                 *client;    ///< the client's side of the game
+        bs_player                 *bot;       ///< the bot's side of the game
+        game_broadcast            *cast;      ///< spectator broadcast of the game
+        std::vector<int>           watchers;  ///< spectators of the game
+        int                        watching;  ///< game watched (session socket, -1 if none)
+        size_t                     sub_id;    ///< subscriber id in the watched game's broadcast
+        std::deque<event_buffer>   feed;      ///< events of the watched game not written yet
+        size_t                     feed_off;  ///< bytes of the first event already written
+
+        explicit session(int f);
+        ~session();
+
+        /// Deletes the game and its players
+        void end_game();
+    };
+
+
+    /// Creates a listening socket from a socket address
+    int add_listener(int domain, const void *addr, size_t addr_len);
+
+    /// Accepts all pending connections of a listening socket
+    void accept_all(int lfd);
+
+    /// Reads and handles all input of a client, false if it has to be closed
+    bool on_readable(session& s);
+
+    /// Writes pending output of a client, false if it has to be closed
+    bool on_writable(session& s);
+
+    /// Stops reading a client that quit, false if it can be closed right away
+    bool start_closing(session& s);
+
+    /// Closes the clients whose linger is over, returns the epoll_wait() timeout until the next one
+    int expire_lingering();
+
+    /// Writes as much output as possible: -1 on error, 0 if the socket is full, 1 if all is written
+    int flush_session(session& s);
+
+    /// Writes the new events of a game to its spectators
+    void pump(session& s);
+
+    /// Stops a client from watching
+    void unwatch(session& s);
+
+    /// Ends the game of a client (its spectators stop watching)
+    void drop_game(session& s);
+
+    /// Handles one line from a client, false on quit
+    bool handle_line(session& s, const std::string& line);
+
+    /// Starts a new game for a client
+    void new_game(session& s, const std::string& bot, float diff);
+
+    /// Lets the bot move until it is the client's turn or the game is over
+    void run_bot(session& s);
+
+    /// Sends gameover if the game is over
+    void check_finished(session& s);
+
+    /// Closes a connection
+    void close_session(int fd);
+
+
+    std::string                             path;       ///< socket path
+    int                                     epfd;       ///< epoll instance
+    int                                     wakefd;     ///< eventfd waking run() up for stop()
+    std::vector<int>                        listeners;  ///< listening sockets
+    std::unordered_map<int, session*>       sessions;   ///< connected clients by socket
+    std::deque<std::pair<std::chrono::steady_clock::time_point, int>> lingering;  ///< closing clients by linger end
+    size_t                                  n_games;    ///< games finished
+    std::atomic<bool>                       stopping;   ///< stop() was called
+
+};
+
+
+#endif
@@ -0,0 +1,87 @@
+/*!
+    A battleship bot placing its fleet where the opponent shoots last
+*/
+
+#ifndef HIDING_PLAYER_HPP
+#define HIDING_PLAYER_HPP
+
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "battleship.h"
+#include "layout_optimizer.h"
+#include "model_player.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+    class battleship;
+    class hiding_player;
+}
+
+
+
+/*!
+    @class hiding_player
+
+    @brief Adversarial placement battleship player
+
+    Places its fleet with a layout_optimizer against a model of the
+    opponent's shots, searching for the given time budget at the first
+    placement of every game (on the empty grid), and shoots like
+    model_player. A ship of the layout blocked by a ship the game placed for
+    the player is placed randomly. A budget of a millisecond suits batch simulations, tens of milliseconds are not
+    noticed in interactive play
+*/
+class bship::hiding_player : public model_player {
+public:
+
+    /*!
+        @brief Name constructor
+
+        @param nm Name of the player
+        @param model Density model of the opponent's shots
+        @param budget Search time of a layout
+        @param prior_dir Directory of the opponents' placement priors (see model_player)
+    */
+    hiding_player(std::string nm, density_model model=DM_PARITY,
+                  std::chrono::microseconds budget=std::chrono::microseconds(1000),
+                  const std::string& prior_dir="");
+
+
+    void move();
+
+
+    /*!
+        @brief Set a learned shot density
+
+        Used by the following layouts instead of the model given to the constructor
+
+        @param density Shot density per cell (row-major)
+    */
+    void set_density(const std::vector<double>& density);
+
+
+    /// Score of the last layout (see layout_optimizer::score())
+    double get_last_score() const;
+
+
+private:
+
+    /// Creates the optimizer once the grid is known
+    void init_optimizer();
+
+
+    std::unique_ptr<layout_optimizer>  optimizer;   ///< layout search (created on the first placement)
+    density_model                      dmodel;      ///< density model of the opponent
+    std::chrono::microseconds          budget;      ///< search time of a layout
+    std::vector<double>                learned;     ///< density given with set_density() (empty if none)
+    std::vector<ship_placement>        layout;      ///< layout of the game
+    double                             last_score;  ///< score of the layout
+
+};
+
+
+#endif
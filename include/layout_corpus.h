@@ -0,0 +1,207 @@
+/*!
+    Binary corpus of fleet layouts, shared between processes
+*/
+
+#ifndef LAYOUT_CORPUS_HPP
+#define LAYOUT_CORPUS_HPP
+
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "bs_grid.h"
+#include "fleet_sampler.h"
+
+
+namespace bship{
+
+    /*!
+        @brief Header of a corpus file
+
+        Followed by count records of n_ships bytes, one per ship in the order
+        of types[]: bits 0-6 are the index of the upper-left cell (row * width + col),
+        bit 7 is set for vertical ships. All fields are little-endian
+    */
+    struct corpus_header{
+        char      magic[4];     ///< "BSLC"
+        uint32_t  version;      ///< format version (1)
+        uint32_t  width;        ///< grid width
+        uint32_t  height;       ///< grid height
+        uint32_t  n_ships;      ///< ships per layout (bytes per record)
+        uint32_t  reserved;     ///< 0
+        uint64_t  count;        ///< number of records
+        uint8_t   types[16];    ///< type of every ship of a layout
+    };
+
+
+    class corpus_writer;
+    class layout_corpus;
+
+}
+
+
+
+/*!
+    @class corpus_writer
+
+    @brief Writes a layout corpus file
+
+    Layouts are appended with add() (see fleet_sampler) and the record count
+    is written into the header by close()
+*/
+class bship::corpus_writer{
+public:
+
+    /// Constructor, no file open
+    corpus_writer();
+
+
+    /// Destructor, closes the file
+    ~corpus_writer();
+
+
+    corpus_writer(const corpus_writer&) = delete;
+    corpus_writer& operator=(const corpus_writer&) = delete;
+
+
+    /*!
+        @brief Create a corpus file
+
+        @param path File to write (overwritten)
+        @param width, height Dimensions of the grid (at most 128 cells)
+        @param fleet Number of ships per type (same format as bs_grid::get_max_n_ships())
+        @return false if the file can not be created or the grid or the fleet are too large
+    */
+    bool open(const std::string& path, size_t width, size_t height, const std::map<ship_type, uint8_t>& fleet);
+
+
+    /// Appends a layout, ships largest first (as drawn by fleet_sampler::sample())
+    void add(const ship_placement *ships);
+
+
+    /// Writes the header and closes the file, false on a write error
+    bool close();
+
+
+    /// Number of layouts added
+    uint64_t size() const;
+
+
+    /*!
+        @brief Write a corpus of random layouts
+
+        @param path File to write (overwritten)
+        @param count Number of layouts
+        @param sampler Sampler drawing the layouts (its size and fleet are those of the corpus)
+        @return false on error
+    */
+    static bool generate(const std::string& path, uint64_t count, fleet_sampler& sampler);
+
+
+private:
+
+    std::FILE              *file;    ///< corpus file (nullptr when closed)
+    corpus_header           header;  ///< header written by close()
+    std::vector<uint8_t>    record;  ///< record being written
+    bool                    failed;  ///< a write failed
+
+};
+
+
+
+/*!
+    @class layout_corpus
+
+    @brief Read-only corpus of fleet layouts
+
+    The file is memory-mapped (shared, read-only), so every process reading
+    the same corpus shares its pages through the page cache instead of
+    loading a private copy, and opening it costs nothing whatever its size.
+    Records are decoded on access; any thread can read concurrently.
+*/
+class bship::layout_corpus{
+public:
+
+    /// Constructor, no file open
+    layout_corpus();
+
+
+    /// Destructor, unmaps the file
+    ~layout_corpus();
+
+
+    layout_corpus(const layout_corpus&) = delete;
+    layout_corpus& operator=(const layout_corpus&) = delete;
+
+
+    /*!
+        @brief Map a corpus file
+
+        @param path Corpus file
+        @return false if the file can not be mapped or is not a valid corpus
+    */
+    bool open(const std::string& path);
+
+
+    /// Unmaps the file
+    void close();
+
+
+    /// Number of layouts (0 if not open)
+    uint64_t size() const;
+
+
+    /// Grid width
+    size_t get_width() const;
+
+
+    /// Grid height
+    size_t get_height() const;
+
+
+    /// Ships per layout
+    size_t get_n_ships() const;
+
+
+    /*!
+        @brief Decode a layout
+
+        @param i Index of the layout, less than size()
+        @param out Placements of the ships (get_n_ships() of them)
+    */
+    void get(uint64_t i, ship_placement *out) const;
+
+
+    /// True if the grid has the size and fleet of the corpus (what apply() needs)
+    bool matches(const bs_grid& grid) const;
+
+
+    /*!
+        @brief Place a layout onto a grid
+
+        The grid must be empty (see bs_grid::reset()) and match the corpus,
+        which is checked once with matches() rather than on every layout.
+        Throws index_exception if i is out of range, illegal_move_exception
+        for a ship the grid's fleet has no room for
+
+        @param i Index of the layout
+        @param grid Grid to place the ships on
+        @return false if a ship of the layout does not fit (the ships before
+                it stay placed)
+    */
+    bool apply(uint64_t i, bs_grid& grid) const;
+
+
+private:
+
+    const uint8_t          *data;     ///< mapped file (nullptr when closed)
+    size_t                  length;   ///< mapped length
+    const corpus_header    *header;   ///< header of the mapped file
+    const uint8_t          *records;  ///< first record
+
+};
+
+
+#endif
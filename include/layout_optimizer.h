@@ -0,0 +1,176 @@
+/*!
+    Fleet layouts chosen against an opponent's shot density
+*/
+
+#ifndef LAYOUT_OPTIMIZER_HPP
+#define LAYOUT_OPTIMIZER_HPP
+
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "bs_grid.h"
+#include "fleet_sampler.h"
+
+
+namespace bship{
+
+    /// Where the opponent is expected to shoot first
+    enum density_model{
+        DM_UNIFORM,   ///< where ships fit most often (the cells a probability-driven hunter tries first)
+        DM_PARITY,    ///< the same, but one checkerboard colour first (a parity hunter)
+        DM_LEARNED    ///< a heat map given with set_density()
+    };
+
+
+    class layout_optimizer;
+
+}
+
+
+
+/*!
+    @class layout_optimizer
+
+    @brief Adversarial fleet placement
+
+    Looks for a layout whose cells the opponent is unlikely to shoot early.
+    The score of a layout is the sum of the shot density over its cells
+    (the density averages 1 per cell), plus a penalty for every pair of
+    ship cells side by side, since a hit next to a ship leads a targeting
+    shooter onto the other one. Lower is better.
+
+    The search is simulated annealing over single ship moves: a random ship
+    goes to a random free placement of its length, and only the cells it
+    leaves and takes are scored again, so a move costs a few dozen
+    operations. It starts from a uniformly random layout and stops at a
+    deadline, returning the best layout seen, so a game can give it a fixed
+    budget (a millisecond is thousands of moves); different seeds or runs
+    give different layouts of similar scores, so that the opponent can not
+    simply learn one layout
+*/
+class bship::layout_optimizer{
+public:
+
+    /*!
+        @brief Constructor with grid size and fleet
+
+        @param width, height Dimensions of the grid (at most 128 cells)
+        @param fleet Number of ships per type (same format as bs_grid::get_max_n_ships())
+        @param model Density model of the opponent (DM_LEARNED starts uniform)
+        @param seed Seed of the search
+    */
+    layout_optimizer(size_t width, size_t height, const std::map<ship_type, uint8_t>& fleet,
+                     density_model model=DM_UNIFORM, uint64_t seed=1);
+
+
+    /// Constructs an optimizer for the size and fleet of the given grid
+    explicit layout_optimizer(const bs_grid& grid, density_model model=DM_UNIFORM, uint64_t seed=1);
+
+
+    /*!
+        @brief Set a learned density
+
+        Switches to DM_LEARNED. The heat map is rescaled to a mean of 1
+
+        @param density Shot density per cell (row-major, width * height non-negative values)
+    */
+    void set_density(const std::vector<double>& density);
+
+
+    /// Penalty of two ship cells side by side (default 0.5)
+    void set_touch_penalty(double penalty);
+
+
+    /*!
+        @brief Search a layout
+
+        @param budget Time to search
+        @param out Placements of the ships, largest first (get_n_ships() of them)
+        @return Score of the layout
+    */
+    double optimize(std::chrono::microseconds budget, ship_placement *out);
+
+
+    /// Score of a layout (ships largest first, as returned by optimize())
+    double score(const ship_placement *fleet) const;
+
+
+    /// Density of the opponent's shots per cell
+    const std::vector<double>& get_density() const;
+
+
+    /// Density model
+    density_model get_model() const;
+
+
+    /// Number of ships of a layout
+    size_t get_n_ships() const;
+
+
+    /// Moves tried by the last optimize()
+    uint64_t get_moves() const;
+
+
+private:
+
+    /// Placement of a ship of some length
+    struct slot{
+        ship_placement   place;   ///< ship placement
+        uint8_t          cells[ST_FIVE];  ///< cells covered
+        double           dens;    ///< density over the cells
+    };
+
+
+    /// Builds the density of the model
+    void init_density();
+
+
+    /// Recomputes the densities of the slots
+    void update_slots();
+
+
+    /// Ship cells next to the cells of a slot, other than ship k
+    int contacts(const slot& s, size_t len, int k) const;
+
+
+    /// Whether the cells of a slot are free (or ship k)
+    bool free_for(const slot& s, size_t len, int k) const;
+
+
+    /// Puts ship k on a slot, or takes it off (k = -1)
+    void mark(const slot& s, size_t len, int k);
+
+
+    /// Next random number (splitmix64)
+    inline uint64_t next(){
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+
+    /// Uniform random number in [0, 1)
+    inline double uniform(){ return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+
+    size_t                          width;     ///< grid width
+    size_t                          height;    ///< grid height
+    density_model                   model;     ///< density model
+    double                          touch;     ///< penalty of two ship cells side by side
+    uint64_t                        state;     ///< random generator state
+    uint64_t                        moves;     ///< moves tried by the last search
+    fleet_sampler                   sampler;   ///< starting layouts
+    std::vector<ship_type>          ships;     ///< ships of a layout, largest first
+    std::vector<double>             density;   ///< shot density per cell
+    std::vector<std::vector<slot>>  slots;     ///< every placement, by ship length
+    std::vector<int8_t>             owner;     ///< ship on each cell during the search (-1: none)
+    std::vector<size_t>             current;   ///< slot of each ship during the search
+    std::vector<size_t>             best;      ///< slots of the best layout
+
+};
+
+
+#endif
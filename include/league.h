@@ -0,0 +1,192 @@
+/*!
+    Rating ladder of bots, with Glicko ratings updated game batch by game batch
+*/
+
+#ifndef LEAGUE_HPP
+#define LEAGUE_HPP
+
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "bs_player.h"
+
+
+namespace bship{
+
+    /// Glicko rating
+    struct glicko_rating{
+        double  rating = 1500;   ///< rating (Elo scale)
+        double  rd     = 350;    ///< rating deviation, the standard deviation of the rating
+    };
+
+
+    /// A game of a rating period
+    struct glicko_game{
+        glicko_rating  opponent;   ///< rating of the opponent before the period
+        double         score;      ///< 1 won, 0 lost
+    };
+
+
+    /*!
+        @brief Glicko update of a rating period
+
+        Glickman's Glicko-1 update: the games of the period are scored
+        against the opponents' ratings before the period
+
+        @param r Rating to update
+        @param games, n Games of the period
+        @param min_rd Smallest deviation after the update (keeps the rating moving)
+    */
+    void glicko_update(glicko_rating& r, const glicko_game *games, size_t n, double min_rd=0);
+
+
+    /// Probability that a rating beats another, given their deviations
+    double glicko_expected(const glicko_rating& r, const glicko_rating& opp);
+
+
+    /// A player of the league and its results
+    struct league_standing{
+        std::string     spec;     ///< player configuration (given to the factory)
+        glicko_rating   rating;   ///< current rating
+        uint64_t        games;    ///< games played
+        uint64_t        wins;     ///< games won
+    };
+
+
+    /// Settings of a league run
+    struct league_config{
+        int       threads   = 1;   ///< threads playing games
+        uint64_t  batch     = 32;  ///< games of a pairing per rating period (half with each player first)
+        double    rd_growth = 30;  ///< growth of a deviation per rating period (Glicko's c)
+    };
+
+
+    class league;
+
+}
+
+
+
+/*!
+    @class league
+
+    @brief Rating ladder over a registry of player configurations
+
+    Plays batches of games between pairs of registered players on several
+    threads and updates both ratings after every batch, each batch being a
+    Glicko rating period, so that the standings are current at any time of
+    the run, from any thread, at the cost of a lock per batch. Before every
+    period the deviations of both players grow by rd_growth in quadrature
+    (Glicko's c), so that a rating keeps following its results once it is
+    known, and the ratings move back toward the unrated 1500 by as much: the
+    unrated prior stays the long-run distribution of a rating, which bounds
+    the rating of a player nobody beats, while the pull on the ratings of
+    players with results is a few points.
+
+    Games go where they change the ranking: the next pairing is the one
+    most likely to be ordered wrong, the normal probability that the
+    ratings are the other way round, weighted by the deviation of the
+    difference (new players first) and divided by the batches of the
+    pairing in progress on other threads. The schedule uses the deviations
+    without the growth, which keep shrinking with the games, or two players
+    of the same strength would take every game once both have settled
+*/
+class bship::league{
+public:
+
+    /// Creates a player of a configuration with a name (the league names the players after their configurations)
+    typedef std::function<bs_player*(const std::string& spec, const std::string& name)> bot_factory;
+
+
+    /*!
+        @brief Constructor
+
+        @param make_bot Factory of the players
+        @param config Threads, batch size and deviation growth
+    */
+    league(const bot_factory& make_bot, const league_config& config=league_config());
+
+
+    /*!
+        @brief Register a player
+
+        Not while run() is in progress
+
+        @param spec Configuration of the player (e.g. "slick:0.5")
+        @param initial Starting rating (unrated by default)
+        @return Index of the player, or of the configuration already registered
+    */
+    size_t add(const std::string& spec, const glicko_rating& initial=glicko_rating());
+
+
+    /*!
+        @brief Play games
+
+        Blocks until the games are played or stop() is called. Can be called
+        again to continue the run
+
+        @param games Games to play (rounded up to whole batches)
+        @return Games played
+    */
+    uint64_t run(uint64_t games);
+
+
+    /// Stops a run() in progress after the batches being played (thread-safe)
+    void stop();
+
+
+    /// Chooses the next pairing (the players, by index); false with less than two players
+    bool next_pairing(size_t& a, size_t& b);
+
+
+    /// Standings by decreasing rating (thread-safe)
+    std::vector<league_standing> standings() const;
+
+
+    /// Games played so far (thread-safe)
+    uint64_t get_games() const;
+
+
+    /// Text report of the standings
+    std::string to_text() const;
+
+
+    /// JSON array of the standings
+    std::string to_json() const;
+
+
+private:
+
+    /// Chooses the next pairing, with the lock held
+    bool choose(size_t& a, size_t& b) const;
+
+
+    /// Plays a batch of a pairing, returns the wins of player a
+    uint64_t play_batch(size_t a, size_t b);
+
+
+    /// Updates both ratings with the result of a batch
+    void report(size_t a, size_t b, uint64_t wins_a, uint64_t games);
+
+
+    /// Ages a rating by a rating period before its update
+    void decay(glicko_rating& r) const;
+
+
+    bot_factory                    make;         ///< player factory
+    league_config                  cfg;          ///< settings
+    mutable std::mutex             mtx;          ///< guards the players and the pairings
+    std::vector<league_standing>   players;      ///< registered players
+    std::vector<double>            sched_rd;     ///< deviations without the growth, by player
+    std::vector<uint32_t>          in_progress;  ///< batches being played, by pairing (a * n + b)
+    std::atomic<uint64_t>          played;       ///< games played
+    std::atomic<bool>              stopping;     ///< stop() was called
+
+};
+
+
+#endif
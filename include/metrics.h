@@ -0,0 +1,163 @@
+/*!
+    Counters and latency histograms of the engine and the bots
+*/
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+
+namespace bship{
+
+    /// Counted events
+    enum metric_counter{
+        MC_PLACEMENTS,           ///< ship placements attempted
+        MC_PLACEMENTS_REJECTED,  ///< ship placements refused (illegal or throwing)
+        MC_SHOTS,                ///< shots made
+        MC_EXCEPTIONS,           ///< bship exceptions created
+        MC_RETRIES,              ///< random moves tried again by the bots
+        MC_PEEKS,                ///< shots where slick_player peeked at the opponent's grid
+        MC_COUNT                 ///< number of counters
+    };
+
+
+    class latency_histogram;
+    class metrics_snapshot;
+    class metrics;
+
+}
+
+
+
+/*!
+    @class latency_histogram
+
+    @brief Latency histogram
+
+    Log2 buckets: bucket i counts the latencies in [2^i, 2^(i+1)) ns
+    (bucket 0 also counts 0 ns)
+*/
+class bship::latency_histogram{
+public:
+
+    /// Number of buckets
+    static const int N_BUCKETS = 40;
+
+
+    /// Constructor, empty histogram
+    latency_histogram();
+
+
+    /// Adds a latency
+    void add(std::chrono::nanoseconds d);
+
+
+    /// Adds all the latencies of another histogram
+    void merge(const latency_histogram& other);
+
+
+    /// Approximate quantile (upper bound of the bucket), q in [0, 1]
+    std::chrono::nanoseconds quantile(double q) const;
+
+
+    /// Mean latency
+    std::chrono::nanoseconds mean() const;
+
+
+    uint64_t  count;               ///< number of latencies
+    uint64_t  sum_ns;              ///< sum of the latencies
+    uint64_t  max_ns;              ///< largest latency
+    uint64_t  buckets[N_BUCKETS];  ///< latencies per bucket
+
+};
+
+
+
+/*!
+    @class metrics_snapshot
+
+    @brief Merged values of the metrics of all threads
+*/
+class bship::metrics_snapshot{
+public:
+
+    /// Constructor, everything zero
+    metrics_snapshot();
+
+
+    /// Value of a counter
+    uint64_t get(metric_counter c) const;
+
+
+    /// Text report, one value per line
+    std::string to_text() const;
+
+
+    /// JSON object with "counters" and "move_latency" (per player)
+    std::string to_json() const;
+
+
+    /// Name of a counter (as used in the reports)
+    static const char *counter_name(metric_counter c);
+
+
+    uint64_t                                   counters[MC_COUNT];  ///< counter values
+    std::map<std::string, latency_histogram>   moves;               ///< move latencies by player name
+
+};
+
+
+
+/*!
+    @class metrics
+
+    @brief Engine metrics
+
+    Every thread updates its own counters and histograms (no contention and
+    no shared cache lines between the threads of a simulation), and the
+    values of all threads are merged on read. The values of finished threads
+    are kept.
+
+    The engine and the bots use the BS_COUNT, BS_COUNT_N and BS_MOVE_TIME
+    macros, that compile to nothing unless BSHIP_METRICS is defined (CMake
+    option of the same name)
+*/
+class bship::metrics{
+public:
+
+    /// Adds n to a counter of the calling thread
+    static void add(metric_counter c, uint64_t n=1);
+
+
+    /// Records the latency of a move of a player in the calling thread
+    static void record_move(const std::string& player, std::chrono::nanoseconds d);
+
+
+    /// Merges the values of all threads
+    static metrics_snapshot snapshot();
+
+
+    /// Resets the values of all threads
+    static void reset();
+
+};
+
+
+
+#ifdef BSHIP_METRICS
+    #define BS_COUNT(c)                bship::metrics::add(c)
+    #define BS_COUNT_N(c, n)           bship::metrics::add(c, n)
+    #define BS_MOVE_TIME(player, d)    bship::metrics::record_move(player, d)
+#else
+    #define BS_COUNT(c)                ((void) 0)
+    #define BS_COUNT_N(c, n)           ((void) 0)
+    #define BS_MOVE_TIME(player, d)    ((void) 0)
+#endif
+
+
+#endif
@@ -0,0 +1,111 @@
+/*!
+    A battleship bot learning where an opponent places its fleet
+*/
+
+#ifndef MODEL_PLAYER_HPP
+#define MODEL_PLAYER_HPP
+
+
+#include <string>
+#include <vector>
+#include "battleship.h"
+#include "bs_player.h"
+#include "placement_prior.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+    class battleship;
+    class model_player;
+}
+
+
+
+/*!
+    @class model_player
+
+    @brief Opponent-modelling battleship player
+
+    Keeps a placement_prior per opponent, in a directory of prior files
+    named after the opponents (see placement_prior::path_for()), and uses
+    the one of the player it is connected to. When a game ends, the
+    opponent's whole fleet is revealed (the hidden grid is read once the
+    game is over, never before) and added to its prior file. The shots are
+    ordered by that prior: while hunting, the unshot cell of one checkerboard
+    colour where the opponent most often put a ship, and around a hit that
+    did not sink yet, the neighbour the opponent most often used, cells in
+    line with two hits first. Against an opponent with placement habits it
+    finds the ships sooner, and with an empty prior it plays a parity
+    hunt/target game. Places its ships randomly
+*/
+class bship::model_player : public bs_player {
+public:
+
+    /*!
+        @brief Name constructor
+
+        @param nm Name of the player
+        @param prior_dir Directory of the opponents' prior files (the files are
+                         created if needed); empty to keep no prior
+    */
+    model_player(std::string nm, const std::string& prior_dir="");
+
+
+    /// Default constructor initializes everything to nullptr
+    model_player();
+
+
+    void move();
+
+
+    /// Records the opponent's fleet at the end of the game
+    void on_update();
+
+
+    void reset();
+
+
+    /// Clears the state of the game, as reset()
+    void set_hidden_grid(bs_grid *hidden);
+
+
+    /// Prior of the current opponent (closed before the first shot)
+    const placement_prior& get_prior() const;
+
+
+    /// False if the prior of the current opponent can not be opened (the player plays without it)
+    bool prior_ok() const;
+
+
+private:
+
+    /// Clears the state of the game
+    void new_game();
+
+
+    /// Maps the prior file of the opponent, once it and the grid size are known
+    void open_prior();
+
+
+    /// Best cell to shoot at
+    size_t pick_shot();
+
+
+    /// Marks the ship sunk by a shot: the longest line of hit cells through it
+    void mark_sunk(size_t row, size_t col);
+
+
+    /// Whether a cell was hit (and not known to be sunk)
+    bool open_hit(long row, long col);
+
+
+    placement_prior       prior;      ///< placements of the opponent
+    std::string           dir;        ///< directory of the prior files (empty for none)
+    std::string           opponent;   ///< opponent of the prior (tried to open)
+    bool                  recorded;   ///< the fleet of this game was recorded
+    std::vector<uint8_t>  sunk;       ///< cells of the ships known to be sunk
+
+};
+
+
+#endif
@@ -0,0 +1,208 @@
+/*!
+    Streaming statistics of game outcomes
+*/
+
+#ifndef OUTCOME_STATS_HPP
+#define OUTCOME_STATS_HPP
+
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "game_listener.h"
+
+
+namespace bship{
+    class battleship;
+    class running_stats;
+    struct game_outcome;
+    class outcome_stats;
+    class outcome_recorder;
+}
+
+
+
+/*!
+    @class running_stats
+
+    @brief Running mean and variance
+
+    Welford's online algorithm: constant memory, numerically stable, and
+    two accumulators merge exactly (Chan et al.), so every thread can keep
+    its own and they are combined at the end
+*/
+class bship::running_stats{
+public:
+
+    /// Constructor, no sample
+    running_stats();
+
+
+    /// Adds a sample
+    void add(double x);
+
+
+    /// Adds all the samples of another accumulator
+    void merge(const running_stats& other);
+
+
+    /// Number of samples
+    uint64_t count() const;
+
+
+    /// Mean (0 without samples)
+    double mean() const;
+
+
+    /// Sample variance (0 with less than 2 samples)
+    double variance() const;
+
+
+    /// Sample standard deviation
+    double stddev() const;
+
+
+    /// Smallest sample
+    double min() const;
+
+
+    /// Largest sample
+    double max() const;
+
+
+private:
+
+    uint64_t  n;     ///< number of samples
+    double    mu;    ///< mean
+    double    m2;    ///< sum of squared differences from the mean
+    double    lo;    ///< smallest sample
+    double    hi;    ///< largest sample
+
+};
+
+
+
+/*!
+    @brief Outcome of one game
+
+    Shot counts are per side; first hit and first sink are the number of
+    shots the side had made when it hit (sank) a ship for the first time,
+    0 if it never did
+*/
+struct bship::game_outcome{
+    bool  pa_won;           ///< player A won
+    int   shots[2];         ///< shots by A, B
+    int   first_hit[2];     ///< shot of the first hit of A, B
+    int   first_sink[2];    ///< shot of the first sink of A, B
+};
+
+
+
+/*!
+    @class outcome_stats
+
+    @brief Statistics of game outcomes per pairing
+
+    Fed one game at a time (see outcome_recorder), in constant memory per
+    pairing whatever the number of games: win counts, running statistics
+    and a full histogram of the total shots, and running statistics of the
+    shots, first hit and first sink of each side.
+
+    Not thread-safe: every thread feeds its own, and merge() combines them
+    once the threads are done (or whenever a thread hands its accumulator
+    over), without any lock on the way
+*/
+class bship::outcome_stats{
+public:
+
+    /// Statistics of one pairing
+    struct pairing{
+        uint64_t                games;          ///< games played
+        uint64_t                wins_a;         ///< games won by player A
+        running_stats           total_shots;    ///< shots by both sides
+        std::vector<uint64_t>   shots_hist;     ///< games by total shots
+        running_stats           shots[2];       ///< shots by A, B
+        running_stats           first_hit[2];   ///< first hit of A, B (games where it happened)
+        running_stats           first_sink[2];  ///< first sink of A, B (games where it happened)
+
+        pairing();
+
+        /// Win rate of player A
+        double win_rate_a() const;
+    };
+
+
+    /*!
+        @brief Record a game
+
+        @param name Pairing (e.g. "slick vs random"), player A first
+        @param o Outcome of the game
+    */
+    void record(const std::string& name, const game_outcome& o);
+
+
+    /// Adds the games of another accumulator
+    void merge(const outcome_stats& other);
+
+
+    /// Statistics of a pairing (empty if it never played)
+    pairing get(const std::string& name) const;
+
+
+    /// Recorded pairings by name
+    const std::map<std::string, pairing>& get_pairings() const;
+
+
+    /// Text report
+    std::string to_text() const;
+
+
+    /// JSON object, by pairing
+    std::string to_json() const;
+
+
+private:
+
+    std::map<std::string, pairing>  pairings;  ///< statistics by pairing
+
+};
+
+
+
+/*!
+    @class outcome_recorder
+
+    @brief Records the games of a battleship into an outcome_stats
+
+    Game listener following the shots of a game and recording its outcome
+    when it is over. Add it to a game (battleship::add_listener()); it can
+    stay through battleship::reset() and record every game played
+*/
+class bship::outcome_recorder : public game_listener {
+public:
+
+    /*!
+        @brief Constructor
+
+        @param st Statistics to record into
+        @param name Pairing of the recorded games
+    */
+    outcome_recorder(outcome_stats& st, const std::string& name);
+
+
+    void on_place(battleship& game, bool by_pa, ship_type type, size_t row, size_t col, ship_orientation orient);
+    void on_shot(battleship& game, bool by_pa, size_t row, size_t col, std::pair<shot_result, int> res);
+    void on_game_over(battleship& game, bool pa_won);
+
+
+private:
+
+    outcome_stats  &stats;    ///< statistics recorded into
+    std::string     name;     ///< pairing
+    game_outcome    current;  ///< game in progress
+
+};
+
+
+#endif
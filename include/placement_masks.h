@@ -0,0 +1,135 @@
+/*!
+    Compile-time cell masks of every ship placement
+*/
+
+#ifndef PLACEMENT_MASKS_HPP
+#define PLACEMENT_MASKS_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include "bitboard.h"
+
+
+namespace bship{
+
+    template<size_t W, size_t H> struct placement_masks;
+
+
+    /*!
+        @brief Mask table of a grid size
+
+        @param width, height Dimensions of the grid
+        @return Table of placement_masks<width, height> for the standard sizes
+                (8x8 and 10x10), nullptr for any other size
+    */
+    const bitboard *placement_table(size_t width, size_t height);
+
+
+    /// Index of a placement in the table of a width x height grid (see placement_masks::index())
+    constexpr size_t placement_index(size_t width, size_t height, size_t len, size_t row, size_t col, bool vertical){
+        return ((len * height + row) * width + col) * 2 + vertical;
+    }
+
+
+    namespace detail{
+
+        /// Compile-time sequence of indices
+        template<size_t... I> struct index_seq{};
+
+        template<class A, class B> struct concat_seq;
+        template<size_t... A, size_t... B> struct concat_seq<index_seq<A...>, index_seq<B...>>{
+            typedef index_seq<A..., (sizeof...(A) + B)...> type;
+        };
+
+        /// index_seq<0, ..., N-1>, in logarithmic template depth
+        template<size_t N> struct make_seq{
+            typedef typename concat_seq<typename make_seq<N / 2>::type, typename make_seq<N - N / 2>::type>::type type;
+        };
+        template<> struct make_seq<0>{ typedef index_seq<> type; };
+        template<> struct make_seq<1>{ typedef index_seq<0> type; };
+
+
+        /// Bit of cell i in word w of a bitboard
+        constexpr uint64_t cell_bit(size_t i, size_t w){
+            return ((i >> 6) == w) ? (1ull << (i & 63)) : 0;
+        }
+
+        /// Bits in word w of len cells from cell i, step cells apart
+        constexpr uint64_t line_bits(size_t i, size_t step, size_t len, size_t w){
+            return (len == 0) ? 0 : cell_bit(i, w) | line_bits(i + step, step, len - 1, w);
+        }
+
+
+        template<size_t W, size_t H, class Seq> struct mask_table;
+        template<size_t W, size_t H, size_t... I> struct mask_table<W, H, index_seq<I...>>{
+            static constexpr bitboard table[sizeof...(I)] = { placement_masks<W, H>::mask_at(I)... };
+        };
+
+        template<size_t W, size_t H, size_t... I>
+        constexpr bitboard mask_table<W, H, index_seq<I...>>::table[sizeof...(I)];
+
+    }
+
+}
+
+
+
+/*!
+    @brief Cell masks of every placement on a W x H grid
+
+    The mask of a ship of length len (1 to MAX_LEN) with its upper-left cell
+    at (row, col) is table[index(len, row, col, vertical)], generated at
+    compile time; placements out of the grid have an empty mask. Checking a
+    placement against the cells already taken is then a single bitboard AND
+    (see bs_grid::place_ship())
+*/
+template<size_t W, size_t H>
+struct bship::placement_masks{
+
+    static_assert(W * H <= bitboard::CAPACITY, "grid too large for a bitboard");
+
+
+    /// Longest ship
+    static const size_t MAX_LEN = 5;
+
+
+    /// Number of masks
+    static const size_t SIZE = (MAX_LEN + 1) * H * W * 2;
+
+
+    /// Index of a placement in the table
+    static constexpr size_t index(size_t len, size_t row, size_t col, bool vertical){
+        return placement_index(W, H, len, row, col, vertical);
+    }
+
+
+    /// Whether a placement is inside the grid
+    static constexpr bool inside(size_t len, size_t row, size_t col, bool vertical){
+        return len > 0 && row < H && col < W && ((vertical) ? row + len <= H : col + len <= W);
+    }
+
+
+    /// Mask of a placement
+    static constexpr bitboard mask(size_t len, size_t row, size_t col, bool vertical){
+        return (!inside(len, row, col, vertical)) ? bitboard() :
+            bitboard(detail::line_bits(row * W + col, (vertical) ? W : 1, len, 0),
+                     detail::line_bits(row * W + col, (vertical) ? W : 1, len, 1));
+    }
+
+
+    /// Mask of the placement with the given index
+    static constexpr bitboard mask_at(size_t i){
+        return mask(i / (2 * W * H), (i / (2 * W)) % H, (i / 2) % W, i % 2);
+    }
+
+
+    /// Masks of all the placements
+    static constexpr const bitboard *table(){
+        return detail::mask_table<W, H, typename detail::make_seq<SIZE>::type>::table;
+    }
+
+};
+
+
+#endif
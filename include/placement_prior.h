@@ -0,0 +1,121 @@
+/*!
+    Persistent heat map of the fleets placed by an opponent
+*/
+
+#ifndef PLACEMENT_PRIOR_HPP
+#define PLACEMENT_PRIOR_HPP
+
+
+#include <cstdint>
+#include <string>
+#include "bitboard.h"
+#include "bs_grid.h"
+
+
+namespace bship{
+
+    /*!
+        @brief Header of a placement prior file
+
+        Followed by width * height 64-bit counts, the number of recorded
+        fleets covering each cell (row-major). All fields are little-endian
+    */
+    struct prior_header{
+        char      magic[4];     ///< "BSPP"
+        uint32_t  version;      ///< format version (1)
+        uint32_t  width;        ///< grid width
+        uint32_t  height;       ///< grid height
+        uint64_t  fleets;       ///< number of recorded fleets
+    };
+
+
+    class placement_prior;
+
+}
+
+
+
+/*!
+    @class placement_prior
+
+    @brief Opponent placement heat map, memory-mapped
+
+    One file per opponent (see path_for()) holds how many of its recorded
+    fleets covered each cell. The file is mapped read-write and shared:
+    record() adds a fleet with one atomic increment per ship cell straight
+    into the mapping, and weight() is one load, so neither costs anything
+    next to a move. Several games, threads or processes can record into the
+    same file at once, the page cache writes it back.
+
+    The weight of a cell is its smoothed frequency, (count + 1) / (fleets + 2),
+    so that an opponent seen in few games is close to uniform
+*/
+class bship::placement_prior{
+public:
+
+    /// Constructor, no file open
+    placement_prior();
+
+
+    /// Destructor, unmaps the file
+    ~placement_prior();
+
+
+    placement_prior(const placement_prior&) = delete;
+    placement_prior& operator=(const placement_prior&) = delete;
+
+
+    /*!
+        @brief Map a prior file, creating it if needed
+
+        @param path Prior file
+        @param width, height Dimensions of the grid (the file must match them)
+        @return false if the file can not be created or mapped, or is not a
+                prior of this grid size
+    */
+    bool open(const std::string& path, size_t width, size_t height);
+
+
+    /// Unmaps the file
+    void close();
+
+
+    /// Whether a file is mapped
+    bool is_open() const;
+
+
+    /// Adds a fleet, given by the cells it covers
+    void record(const bitboard& fleet);
+
+
+    /// Adds the fleet of a grid (every cell holding a ship part, hit or not)
+    void record(bs_grid& grid);
+
+
+    /// Number of recorded fleets
+    uint64_t fleets() const;
+
+
+    /// Number of recorded fleets covering a cell
+    uint64_t count(size_t cell) const;
+
+
+    /// Smoothed frequency of a ship on a cell (0.5 without any fleet, or if closed)
+    double weight(size_t cell) const;
+
+
+    /// File of an opponent in a directory (the name is reduced to [A-Za-z0-9_-])
+    static std::string path_for(const std::string& dir, const std::string& opponent);
+
+
+private:
+
+    prior_header   *header;   ///< mapped file (nullptr when closed)
+    uint64_t       *counts;   ///< counts after the header
+    size_t          length;   ///< mapped length
+    size_t          cells;    ///< cells of the grid
+
+};
+
+
+#endif
@@ -0,0 +1,139 @@
+/*!
+    Distribution of the fleet placements of a bot
+*/
+
+#ifndef PLACEMENT_STATS_HPP
+#define PLACEMENT_STATS_HPP
+
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "bs_grid.h"
+
+
+namespace bship{
+    class bs_player;
+    class placement_stats;
+}
+
+
+
+/*!
+    @class placement_stats
+
+    @brief Per-cell occupancy counts of many fleet placements
+
+    Counts, for every ship type and every cell, how many of the recorded
+    fleets covered the cell, which gives the heat map of a bot's placements.
+    The heat map is compared with the uniform distribution over the legal
+    fleets (computed exactly by fleet_counter) with a chi-squared statistic.
+
+    Counts are flat arrays (type-major, cells in row-major order) so that
+    merging the counts of several threads is a plain vectorizable loop.
+    Not thread-safe: every thread records into its own, see sample()
+*/
+class bship::placement_stats{
+public:
+
+    /*!
+        @brief Constructor, no fleet recorded
+
+        @param width, height Dimensions of the grid
+        @param fleet Number of ships per type (same format as bs_grid::get_max_n_ships())
+    */
+    placement_stats(size_t width, size_t height, const std::map<ship_type, uint8_t>& fleet);
+
+
+    /// Records a placed ship (placements must be legal, they are not checked)
+    void add_ship(ship_type type, size_t row, size_t col, ship_orientation orient);
+
+
+    /// Records that n more fleets were completed
+    void add_fleets(uint64_t n);
+
+
+    /// Adds the counts of another accumulator (same grid and fleet)
+    void merge(const placement_stats& other);
+
+
+    /// Number of fleets recorded
+    uint64_t get_fleets() const;
+
+
+    /// Fleets in which a ship of the type covered the cell
+    uint64_t occupancy(ship_type type, size_t row, size_t col) const;
+
+
+    /// Fleets in which any ship covered the cell
+    uint64_t occupancy(size_t row, size_t col) const;
+
+
+    /// Fraction of the fleets covering the cell
+    double frequency(size_t row, size_t col) const;
+
+
+    /*!
+        @brief Per-cell occupancy probability of a uniform legal fleet
+
+        Exact, from fleet_counter (takes seconds on a 10x10 grid)
+
+        @return Probabilities in row-major order
+    */
+    std::vector<double> uniform() const;
+
+
+    /*!
+        @brief Chi-squared statistic against expected probabilities
+
+        Sum over the cells of (O - E)^2 / E with O the occupancy and E the
+        expected occupancy (fleets times the probability). Cells that can
+        never be covered are skipped.
+
+        @param expected Per-cell probabilities in row-major order (see uniform())
+    */
+    double chi_squared(const std::vector<double>& expected) const;
+
+
+    /// Text heat maps (percent of the fleets), overall then per type
+    std::string heat_map() const;
+
+
+    /// JSON report, with the chi-squared statistic if expected probabilities are given
+    std::string to_json(const std::vector<double>& expected=std::vector<double>()) const;
+
+
+    /*!
+        @brief Records the placement phase of a bot, many times
+
+        Plays the placement phase only, in one game slot per thread with two
+        instances of the bot, both of which are recorded.
+
+        @param make Creates a bot from its name
+        @param width, height Dimensions of the grid
+        @param fleets Number of fleets to record (rounded up to an even number)
+        @param threads Number of threads
+        @return Merged counts of all threads
+    */
+    static placement_stats sample(const std::function<bs_player*(const std::string&)>& make,
+                                  size_t width, size_t height, uint64_t fleets, int threads);
+
+
+private:
+
+    /// Index of a type in the counts
+    static size_t type_index(ship_type type);
+
+
+    size_t                            width;     ///< grid width
+    size_t                            height;    ///< grid height
+    std::map<ship_type, uint8_t>      fleet;     ///< ships per type
+    uint64_t                          fleets;    ///< fleets recorded
+    std::vector<uint64_t>             counts;    ///< occupancy per type and cell
+
+};
+
+
+#endif
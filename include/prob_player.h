@@ -0,0 +1,78 @@
+/*!
+    A battleship bot shooting by exact hit probabilities
+*/
+
+#ifndef PROB_PLAYER_HPP
+#define PROB_PLAYER_HPP
+
+
+#include "battleship.h"
+#include "async_player.h"
+#include "fleet_counter.h"
+#include "endgame.h"
+#include "exceptions.hpp"
+
+
+namespace bship{
+    class battleship;
+    class prob_player;
+}
+
+
+
+/*!
+    @class prob_player
+
+    @brief Probabilistic battleship player
+
+    Places its ships randomly, then always shoots the unresolved cell covered
+    by the largest number of fleet arrangements consistent with its hit grid
+    (see fleet_counter). Once few arrangements are left, the shot comes from
+    an exact endgame search instead (see endgame_solver).
+    Unlike slick_player, it never looks at the opponent's grid.
+    Shots are computed in the background as soon as the position is
+    known (see async_player)
+*/
+class bship::prob_player : public async_player {
+public:
+
+    /*!
+        @brief Constructor with grid and game pointers
+
+        Constructs a player with given grids and game. The grids are pointers
+        to bs_grid objects inside the relevant game object. Players get
+        all game state information through their grids. Players are free
+        to keep track of any additional data they deem useful.
+        The game is a pointer to the game on which the player makes moves
+
+        @param hdg, htg Hidden and hit grid pointers of the player
+        @param gm Pointer to the game
+    */
+    prob_player(std::string& n, bs_grid* hdg, bs_grid* htg, battleship *gm);
+
+
+    /// Name constructor
+    prob_player(std::string nm);
+
+
+    /// Default constructor initializes everything to nullptr
+    prob_player();
+
+
+    /// Destructor frees the counter and the endgame solver
+    ~prob_player();
+
+
+protected:
+
+    /// Shot by arrangement counts (or endgame search), stops with the count
+    bool think(bs_grid& obs, const std::atomic<bool>& stop, size_t& row, size_t& col);
+
+
+    fleet_counter   *counter = nullptr;   ///< arrangement counter (created on the first shot)
+    endgame_solver  *endgame = nullptr;   ///< endgame search (created on the first shot)
+
+};
+
+
+#endif
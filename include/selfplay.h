@@ -0,0 +1,320 @@
+/*!
+    Training data from bot games: samples, shards and the self-play pipeline
+*/
+
+#ifndef SELFPLAY_HPP
+#define SELFPLAY_HPP
+
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include "bitboard.h"
+#include "bounded_queue.h"
+#include "bs_player.h"
+#include "game_listener.h"
+
+
+namespace bship{
+
+    /// One move of a game with what the mover knew before it
+    struct train_sample{
+        bitboard  hits;      ///< cells of the mover's hit grid shot with a hit
+        bitboard  misses;    ///< cells shot with a miss
+        bitboard  sunk;      ///< cells of the ships sunk by the mover
+        uint32_t  game;      ///< index of the game
+        uint16_t  move;      ///< index of the shot among the mover's shots
+        uint8_t   cell;      ///< cell shot (row * width + col)
+        uint8_t   flags;     ///< SF_* bits
+    };
+
+
+    /// Bits of train_sample::flags
+    enum sample_flag : uint8_t {
+        SF_BY_PA   = 1,      ///< the mover is player A
+        SF_WON     = 2,      ///< the mover won the game
+        SF_HIT     = 4,      ///< the shot hit a ship
+        SF_SINK    = 8       ///< the shot sank a ship
+    };
+
+
+    /*!
+        @brief Header of a shard file
+
+        Followed by chunks, each a shard_chunk then its data: the samples
+        of the chunk field by field (hits, misses and sunk as two 64-bit
+        words each, game, move, cell, flags), every field of all the samples
+        in a row so that the compressor sees long runs of similar bytes.
+        All fields are little-endian
+    */
+    struct shard_header{
+        char      magic[4];     ///< "BSSP"
+        uint32_t  version;      ///< format version (1)
+        uint16_t  width;        ///< grid width
+        uint16_t  height;       ///< grid height
+        uint32_t  codec;        ///< 0: stored, 1: zlib
+    };
+
+
+    /// Header of a chunk of a shard
+    struct shard_chunk{
+        uint32_t  n_samples;    ///< samples in the chunk
+        uint32_t  raw_size;     ///< bytes of the samples
+        uint32_t  stored_size;  ///< bytes following this header
+    };
+
+
+    /// Settings of the self-play pipeline
+    struct selfplay_config{
+        uint64_t     games          = 1000;        ///< games to play
+        int          threads        = 1;           ///< threads playing games (the writer has its own)
+        size_t       queue_capacity = 1 << 16;     ///< samples between the players and the writer
+        size_t       chunk_samples  = 1 << 14;     ///< samples per chunk
+        size_t       shard_chunks   = 64;          ///< chunks per shard file
+        int          level          = 6;           ///< compression level (0: stored)
+        std::string  prefix         = "selfplay";  ///< shards are prefix-00000.bss, prefix-00001.bss...
+    };
+
+
+    /// What the self-play pipeline did
+    struct selfplay_report{
+        uint64_t  games         = 0;  ///< games played
+        uint64_t  samples       = 0;  ///< samples written
+        uint64_t  shards        = 0;  ///< shard files written
+        uint64_t  chunks        = 0;  ///< chunks written
+        uint64_t  raw_bytes     = 0;  ///< bytes of the samples
+        uint64_t  stored_bytes  = 0;  ///< bytes written (headers included)
+        uint64_t  stalls        = 0;  ///< pushes that waited for the writer
+        double    seconds       = 0;  ///< wall time
+        bool      ok            = true;  ///< no write error
+    };
+
+
+    class sample_recorder;
+    class shard_writer;
+    class shard_reader;
+    class selfplay_pipeline;
+
+}
+
+
+
+/*!
+    @class sample_recorder
+
+    @brief Turns games into training samples
+
+    Listens to a game (see battleship::add_listener()) and keeps, for both
+    players, the planes of their hit grid: a sample is made of the planes
+    before a shot and the shot. The outcome is only known at the end: the
+    samples of a game are kept until then and pushed to the queue at once.
+    One recorder per game, and per thread
+*/
+class bship::sample_recorder : public bship::game_listener{
+public:
+
+    /*!
+        @brief Constructor
+
+        @param q Queue to push the samples to
+        @param width Width of the grid of the games
+    */
+    sample_recorder(bounded_queue<train_sample>& q, size_t width=10);
+
+
+    /// Sets the index written into the samples of the next game
+    void set_game(uint32_t game);
+
+
+    void on_place(battleship& game, bool by_pa, ship_type type, size_t row, size_t col, ship_orientation orient);
+    void on_shot(battleship& game, bool by_pa, size_t row, size_t col, std::pair<shot_result, int> res);
+    void on_game_over(battleship& game, bool pa_won);
+
+
+private:
+
+    /// Forgets the game in progress
+    void clear();
+
+
+    /// Hit grid of one player
+    struct planes{
+        bitboard   hits;        ///< cells hit
+        bitboard   misses;      ///< cells missed
+        bitboard   sunk;        ///< cells of the sunk ships
+        bitboard   ships[16];   ///< cells hit per ship id
+        uint16_t   shots;       ///< shots so far
+    };
+
+
+    bounded_queue<train_sample>    *queue;     ///< where the samples go
+    std::vector<train_sample>       samples;   ///< samples of the game in progress
+    planes                          side[2];   ///< B's and A's hit grids
+    uint32_t                        game_id;   ///< index of the game in progress
+    size_t                          width;     ///< grid width
+
+};
+
+
+
+/*!
+    @class shard_writer
+
+    @brief Writes samples into compressed shard files
+
+    Samples are gathered into chunks, every chunk is compressed on its own
+    (zlib, when the library was built with it) and appended to the current
+    shard, and a new shard is started every shard_chunks chunks, so that a
+    reader can start anywhere on a shard boundary and never needs more than
+    one chunk in memory
+*/
+class bship::shard_writer{
+public:
+
+    /// Constructor, no file written until the first chunk is full
+    shard_writer(const selfplay_config& config, size_t width, size_t height);
+
+
+    /// Destructor, writes the last chunk
+    ~shard_writer();
+
+
+    shard_writer(const shard_writer&) = delete;
+    shard_writer& operator=(const shard_writer&) = delete;
+
+
+    /// Adds a sample
+    void add(const train_sample& s);
+
+
+    /// Writes the last chunk and closes the shard, false if any write failed
+    bool close();
+
+
+    /// Counters of the samples, chunks, shards and bytes written (the other fields are left)
+    void report(selfplay_report& r) const;
+
+
+    /// Name of shard i of a prefix
+    static std::string shard_name(const std::string& prefix, uint64_t i);
+
+
+private:
+
+    /// Encodes, compresses and writes the pending samples
+    void flush();
+
+
+    selfplay_config             cfg;        ///< chunk and shard sizes, prefix
+    shard_header                header;     ///< header of every shard
+    std::vector<train_sample>   pending;    ///< samples of the chunk being filled
+    std::vector<uint8_t>        raw;        ///< encoded chunk
+    std::vector<uint8_t>        packed;     ///< compressed chunk
+    std::FILE                  *file;       ///< current shard (nullptr between shards)
+    size_t                      in_shard;   ///< chunks in the current shard
+    uint64_t                    samples;    ///< samples written
+    uint64_t                    chunks;     ///< chunks written
+    uint64_t                    shards;     ///< shards started
+    uint64_t                    raw_bytes;  ///< bytes of the samples written
+    uint64_t                    stored;     ///< bytes written
+    bool                        failed;     ///< a write failed
+
+};
+
+
+
+/*!
+    @class shard_reader
+
+    @brief Reads the samples of a shard file, one chunk at a time
+*/
+class bship::shard_reader{
+public:
+
+    /// Constructor, no file open
+    shard_reader();
+
+
+    /// Destructor, closes the file
+    ~shard_reader();
+
+
+    shard_reader(const shard_reader&) = delete;
+    shard_reader& operator=(const shard_reader&) = delete;
+
+
+    /// Opens a shard, false if it can not be read or is not a shard
+    bool open(const std::string& path);
+
+
+    /*!
+        @brief Read the next chunk
+
+        @param out Samples of the chunk (replaced)
+        @return false at the end of the shard or on an error (see failed())
+    */
+    bool next(std::vector<train_sample>& out);
+
+
+    /// Whether reading stopped on an error (corrupt chunk, unknown codec)
+    bool failed() const;
+
+
+    /// Grid width
+    size_t get_width() const;
+
+
+    /// Grid height
+    size_t get_height() const;
+
+
+    /// Closes the file
+    void close();
+
+
+private:
+
+    std::FILE              *file;     ///< shard (nullptr when closed)
+    shard_header            header;   ///< header of the shard
+    std::vector<uint8_t>    raw;      ///< decoded chunk
+    std::vector<uint8_t>    packed;   ///< chunk as stored
+    bool                    error;    ///< reading stopped on an error
+
+};
+
+
+
+/*!
+    @class selfplay_pipeline
+
+    @brief Harvests training samples from bot games
+
+    Worker threads play games between two bots, each in one game slot reset
+    between the games, and push the samples of every finished game into a
+    bounded lock-free queue. A writer thread drains the queue into shards.
+    When the writer falls behind, the queue fills up and the workers wait
+    in push(): memory stays bounded by the queue, one game per worker and
+    one chunk, whatever the number of games
+*/
+class bship::selfplay_pipeline{
+public:
+
+    /// Creates a bot given its name (see placement_stats::sample())
+    typedef std::function<bs_player*(const std::string&)> bot_factory;
+
+
+    /*!
+        @brief Play games and write their samples
+
+        @param make_a, make_b Factories of players A and B (called once per worker)
+        @param config Number of games, threads, queue, chunk and shard sizes
+        @return Counters of the run
+    */
+    static selfplay_report run(const bot_factory& make_a, const bot_factory& make_b, const selfplay_config& config);
+
+};
+
+
+#endif
@@ -0,0 +1,195 @@
+/*!
+    Bit-sliced engine playing 64 games at once
+*/
+
+#ifndef SLICED_ENGINE_HPP
+#define SLICED_ENGINE_HPP
+
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+#include "bs_grid.h"
+#include "fleet_sampler.h"
+#include "outcome_stats.h"
+
+
+namespace bship{
+
+    /// Shot orders of the bit-sliced engine
+    enum sliced_policy{
+        SP_RANDOM,       ///< every cell once, in random order
+        SP_PARITY,       ///< the cells of one checkerboard colour first, then the others, both in random order (not reacting to hits)
+        SP_HUNT_TARGET   ///< parity hunt, then the neighbours of a hit: not supported, refused with illegal_move_exception
+    };
+
+
+    class sliced_engine;
+
+}
+
+
+
+/*!
+    @class sliced_engine
+
+    @brief Bit-sliced game engine
+
+    Plays 64 independent games in lockstep: bit g of every word belongs to
+    game g. For every ship of a fleet, one word per cell holds the games
+    whose ship covers the cell, and the cells each ship has left are a 3-bit
+    counter sliced across three words. A shot is then a handful of bitwise
+    operations for all 64 games: hits, sinks and the end of the fleet.
+
+    A word per cell needs every game to shoot the same cell at every step,
+    so a side has one shot order per batch. The games still shoot orders of
+    their own: the ship cells of every game are moved by a random
+    permutation of the cells first (keeping their checkerboard colour for
+    SP_PARITY), which is the same as that game shooting the shared order
+    permuted the other way at its true layout. The 64 games of a batch are
+    thus independent samples of their policies. Policies reacting to hits
+    (SP_HUNT_TARGET) would need a different shot per game and are refused.
+
+    The rules are those of battleship: player A shoots first, a hit gives
+    another shot. Since a side's shots do not depend on the other side, both
+    sides are played to the end separately, and the turns are interleaved
+    afterwards to find the winner and the shots each side took, which gives
+    outcomes comparable with the scalar engine (see outcome_recorder)
+*/
+class bship::sliced_engine{
+public:
+
+    /// Games per batch
+    static const int LANES = 64;
+
+
+    /*!
+        @brief Constructor with grid size and fleet
+
+        @param width, height Dimensions of the grid (at most 128 cells)
+        @param fleet Number of ships per type (same format as bs_grid::get_max_n_ships())
+        @param mode Distribution of the random layouts
+        @param seed Seed of the layouts and shot orders
+    */
+    sliced_engine(size_t width, size_t height, const std::map<ship_type, uint8_t>& fleet,
+                  sampler_mode mode=SM_UNIFORM, uint64_t seed=1);
+
+
+    /// Constructs an engine for the size and fleet of the given grid
+    explicit sliced_engine(const bs_grid& grid, sampler_mode mode=SM_UNIFORM, uint64_t seed=1);
+
+
+    /*!
+        @brief Play a batch of games with random layouts
+
+        The games are independent, each with its own layouts and shot orders.
+        Throws illegal_move_exception for SP_HUNT_TARGET
+
+        @param pol_a, pol_b Policies of players A and B
+        @param out Outcomes of the LANES games
+    */
+    void play(sliced_policy pol_a, sliced_policy pol_b, game_outcome *out);
+
+
+    /*!
+        @brief Play a batch of given games
+
+        Every game shoots the given orders, the outcomes of the batch are
+        correlated through them (see play() for independent games)
+
+        @param fleet_a, fleet_b Layouts of the fleets of A and B, get_n_ships()
+                                placements per game (largest first, see fleet_sampler)
+        @param order_a, order_b Shot orders of A and B, every cell index (row * width + col) once
+        @param out Outcomes of the LANES games
+    */
+    void play(const ship_placement *fleet_a, const ship_placement *fleet_b,
+              const uint8_t *order_a, const uint8_t *order_b, game_outcome *out);
+
+
+    /// Draws a shot order of a policy (get_width() * get_height() cells), illegal_move_exception for SP_HUNT_TARGET
+    void draw_order(sliced_policy pol, uint8_t *order);
+
+
+    /// Number of ships of a fleet
+    size_t get_n_ships() const;
+
+
+    /// Grid width
+    size_t get_width() const;
+
+
+    /// Grid height
+    size_t get_height() const;
+
+
+private:
+
+    /// Shots of one side against the fleet of the other
+    struct side{
+        std::vector<uint64_t>  ship;        ///< games with ship k on cell c, [k * cells + c]
+        std::vector<uint64_t>  hits;        ///< games where the shot of step t hit, [t]
+        int                    finish[LANES];      ///< step sinking the last ship
+        int                    first_hit[LANES];   ///< step of the first hit
+        int                    first_sink[LANES];  ///< step of the first sink
+    };
+
+
+    /// Fills the ship words of a side from the layouts of the games
+    void load(side& s, const ship_placement *fleet);
+
+
+    /*!
+        @brief Fills the ship words of a side from the layouts of the games, permuted
+
+        Every game moves its ship cells to distinct random cells (of the same
+        colour for SP_PARITY): the cells a random permutation of its own takes
+        them to, drawn only where a ship is
+
+        @param s Side to fill
+        @param fleet Layouts of the games
+        @param pol Policy of the shooting side
+    */
+    void load_permuted(side& s, const ship_placement *fleet, sliced_policy pol);
+
+
+    /// Plays the shots of both sides and fills the outcomes
+    void finish(const uint8_t *order_a, const uint8_t *order_b, game_outcome *out);
+
+
+    /// Next random number of the permutations (splitmix64)
+    inline uint64_t next(){
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+
+    /// Plays the shots of a side until every game has sunk the whole fleet
+    void shoot(side& s, const uint8_t *order);
+
+
+    /// Shots of the side up to its n-th miss in game g (0 for n = 0)
+    int shots_to_miss(const side& s, int g, int n) const;
+
+
+    size_t                          width;     ///< grid width
+    size_t                          height;    ///< grid height
+    size_t                          cells;     ///< number of cells
+    std::vector<ship_type>          ships;     ///< ships of a fleet, largest first
+    int                             n_cells;   ///< cells covered by a fleet
+    fleet_sampler                   sampler;   ///< random layouts
+    std::mt19937_64                 rng;       ///< random shot orders
+    uint64_t                        state;     ///< random generator state of the permutations
+    std::vector<uint8_t>            by_colour; ///< cells of one checkerboard colour, then of the other
+    size_t                          n_even;    ///< cells of the first colour
+    side                            sides[2];  ///< A shooting at B, B shooting at A
+    std::vector<uint64_t>           counter;   ///< cells left of ship k, bit i in [3 * k + i]
+    std::vector<ship_placement>     fleets[2]; ///< random layouts of the batch
+    std::vector<uint8_t>            orders[2]; ///< random shot orders of the batch
+
+};
+
+
+#endif
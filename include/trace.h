@@ -0,0 +1,122 @@
+/*!
+    Timeline tracing in the Chrome trace event format
+*/
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+
+namespace bship{
+    class tracer;
+    class trace_span;
+}
+
+
+
+/*!
+    @class tracer
+
+    @brief Timeline tracer
+
+    Records spans (name, category, start and duration) into a JSON file in
+    the Chrome trace event format, that can be opened in chrome://tracing or
+    Perfetto. Every thread buffers its spans in memory; a buffer is written
+    to the file when it reaches the flush threshold, when its thread
+    finishes and on stop().
+
+    While tracing is off a span costs a relaxed atomic load. Names and
+    categories are not copied: they must be string literals (or outlive
+    the trace)
+*/
+class bship::tracer{
+public:
+
+    /*!
+        @brief Start tracing
+
+        @param path Trace file (overwritten)
+        @param flush_events Spans buffered per thread before they are written
+        @return false if the file can not be opened or tracing is on already
+    */
+    static bool start(const std::string& path, size_t flush_events=8192);
+
+
+    /// Stops tracing, writes every buffered span and closes the file
+    static void stop();
+
+
+    /// Whether tracing is on
+    static bool enabled(){ return on.load(std::memory_order_relaxed); }
+
+
+    /// Records a span of the calling thread
+    static void complete(const char *name, const char *cat,
+                         std::chrono::steady_clock::time_point begin,
+                         std::chrono::steady_clock::time_point end);
+
+
+    /// Number of spans written so far
+    static size_t num_events();
+
+
+private:
+
+    static std::atomic<bool> on;   ///< tracing is on
+
+};
+
+
+
+/*!
+    @class trace_span
+
+    @brief Scoped trace span
+
+    Records a span from its construction to its destruction (see BS_TRACE)
+*/
+class bship::trace_span{
+public:
+
+    /// Constructor, starts the span if tracing is on
+    trace_span(const char *nm, const char *ct)
+    :   name(nm), cat(ct), active(tracer::enabled())
+    {
+        if(active) begin = std::chrono::steady_clock::now();
+    }
+
+
+    /// Destructor, records the span
+    ~trace_span(){
+        if(active) tracer::complete(name, cat, begin, std::chrono::steady_clock::now());
+    }
+
+
+    trace_span(const trace_span&) = delete;
+    trace_span& operator=(const trace_span&) = delete;
+
+
+private:
+
+    const char                              *name;    ///< span name
+    const char                              *cat;     ///< span category
+    bool                                     active;  ///< tracing was on at the start
+    std::chrono::steady_clock::time_point    begin;   ///< start time
+
+};
+
+
+
+#define BS_TRACE_CONCAT_(a, b) a ## b
+#define BS_TRACE_CONCAT(a, b) BS_TRACE_CONCAT_(a, b)
+
+/// Traces the rest of the enclosing scope
+#define BS_TRACE(name, cat) bship::trace_span BS_TRACE_CONCAT(bs_trace_span_, __LINE__)(name, cat)
+
+
+#endif
@@ -0,0 +1,205 @@
+/*!
+    Batched shooting environments for reinforcement learning
+*/
+
+#ifndef VEC_ENV_HPP
+#define VEC_ENV_HPP
+
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bs_grid.h"
+#include "fleet_sampler.h"
+
+
+namespace bship{
+
+    /// Observation planes of an environment, each get_width() * get_height() floats
+    enum obs_plane{
+        PL_HIT,          ///< 1 on the cells shot with a hit (sunk ships included)
+        PL_MISS,         ///< 1 on the cells shot with a miss
+        PL_SUNK,         ///< 1 on the cells of the sunk ships
+        PL_COUNT         ///< number of planes
+    };
+
+
+    /// Rewards of the shots and episode limits
+    struct env_rewards{
+        float  miss    = 0.0f;   ///< shot into the water
+        float  hit     = 1.0f;   ///< shot hitting a ship without sinking it
+        float  sink    = 1.0f;   ///< shot sinking a ship (but not the last one)
+        float  win     = 1.0f;   ///< shot sinking the last ship
+        float  illegal = -1.0f;  ///< cell out of the grid or shot before (nothing happens)
+        int    max_steps = 0;    ///< steps after which an episode is cut (0: twice the number of cells)
+    };
+
+
+    class vec_env;
+
+}
+
+
+
+/*!
+    @class vec_env
+
+    @brief Vectorized shooting environments
+
+    Owns N independent games in which the agent shoots at a hidden random
+    fleet (see fleet_sampler) until it is sunk: the shooting side of a
+    battleship game, one shot per step. step() takes one action per
+    environment (a cell index, row * width + col), plays them all and writes
+    the observations, rewards and done flags into buffers of the caller laid
+    out contiguously, environment after environment. An environment whose
+    episode ends is reset at once: its done flag is set and its observation
+    is already the first one of the next episode.
+
+    The observation of an environment is the hit grid of the shooter as
+    PL_COUNT planes of floats (see obs_plane), kept up to date shot by
+    shot and copied out. Nothing is allocated after construction.
+
+    With several threads, the environments are split into contiguous slices
+    stepped by workers that live as long as the vec_env, so a step costs two
+    wake-ups and no thread creation. The layouts of each environment are
+    drawn from a seed of its own, so the episodes do not depend on the
+    number of threads. A vec_env is not itself thread-safe: one caller steps it.
+
+    A plain C interface to the same environments is in bship_c.h
+*/
+class bship::vec_env{
+public:
+
+    /*!
+        @brief Constructor with grid size
+
+        The fleet is the standard one of bs_grid
+
+        @param n_envs Number of environments
+        @param width, height Dimensions of the grid (at most 128 cells)
+        @param n_threads Threads stepping the environments (1: the caller only)
+        @param seed Seed of the layouts
+        @param rewards Rewards of the shots
+    */
+    vec_env(size_t n_envs, size_t width, size_t height, int n_threads=1, uint64_t seed=1,
+            const env_rewards& rewards=env_rewards());
+
+
+    /// Destructor, stops the workers
+    ~vec_env();
+
+
+    vec_env(const vec_env&) = delete;
+    vec_env& operator=(const vec_env&) = delete;
+
+
+    /*!
+        @brief Reset every environment
+
+        @param obs Observations, get_n_envs() * get_obs_size() floats (may be nullptr)
+    */
+    void reset(float *obs);
+
+
+    /*!
+        @brief Step every environment
+
+        An illegal action (out of the grid or a cell shot before) costs the
+        illegal reward and changes nothing else. Any of the output buffers may
+        be nullptr when not needed
+
+        @param actions One cell index per environment
+        @param obs Observations after the step, get_n_envs() * get_obs_size() floats
+        @param rewards One reward per environment
+        @param dones 1 where the episode ended (and the environment was reset), 0 elsewhere
+    */
+    void step(const int32_t *actions, float *obs, float *rewards, uint8_t *dones);
+
+
+    /// Number of environments
+    size_t get_n_envs() const;
+
+
+    /// Floats of the observation of one environment (PL_COUNT * width * height)
+    size_t get_obs_size() const;
+
+
+    /// Grid width
+    size_t get_width() const;
+
+
+    /// Grid height
+    size_t get_height() const;
+
+
+    /// Shots of the last finished episode of an environment (0 if none)
+    int get_last_length(size_t env) const;
+
+
+private:
+
+    /// One game
+    struct env{
+        bs_grid   grid;      ///< fleet shot at
+        uint64_t  seed;      ///< seed of the layouts of the environment
+        uint64_t  episode;   ///< episodes started
+        int       steps;     ///< steps of the current episode
+        int       last;      ///< steps of the last finished episode
+
+        env(size_t width, size_t height) : grid(width, height), seed(0), episode(0), steps(0), last(0) {}
+    };
+
+
+    /// Slice of the environments stepped by one thread
+    struct slice{
+        size_t         begin;     ///< first environment
+        size_t         end;       ///< past the last environment
+        fleet_sampler  sampler;   ///< layouts of the slice (reseeded per episode)
+
+        slice(size_t b, size_t e, const bs_grid& grid) : begin(b), end(e), sampler(grid) {}
+    };
+
+
+    /// Starts a new episode of environment i
+    void reset_env(size_t i, fleet_sampler& sampler);
+
+
+    /// Steps the environments of a slice
+    void step_slice(slice& s);
+
+
+    /// Loop of worker thread t (slice t + 1, slice 0 is stepped by the caller)
+    void worker(size_t t);
+
+
+    size_t                      width;      ///< grid width
+    size_t                      height;     ///< grid height
+    size_t                      cells;      ///< cells of a grid
+    size_t                      obs_size;   ///< floats per observation
+    env_rewards                 rew;        ///< rewards of the shots
+    int                         max_steps;  ///< steps after which an episode is cut
+    std::vector<env>            envs;       ///< the environments
+    std::vector<float>          planes;     ///< observations of all the environments
+    std::vector<slice>          slices;     ///< one per thread
+
+    // buffers of the step in progress
+    const int32_t              *in_actions;
+    float                      *out_obs;
+    float                      *out_rewards;
+    uint8_t                    *out_dones;
+
+    // workers
+    std::vector<std::thread>    workers;    ///< threads stepping slices 1 and up
+    std::mutex                  mtx;        ///< guards the fields below
+    std::condition_variable     go;         ///< a new step (or the end) is ready
+    std::condition_variable     done;       ///< a worker finished its slice
+    uint64_t                    generation; ///< steps started
+    size_t                      pending;    ///< workers still stepping
+    bool                        stopping;   ///< the workers have to exit
+
+};
+
+
+#endif
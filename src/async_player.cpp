@@ -0,0 +1,138 @@
+#include "async_player.h"
+
+namespace bship{
+
+
+async_player::async_player(std::string& n, bs_grid* hdg, bs_grid* htg, battleship *gm)
+:   bs_player(n, hdg, htg, gm),
+    stop(false),
+    snapshot(nullptr),
+    job_row(0),
+    job_col(0)
+{}
+
+
+async_player::async_player(std::string nm)
+:   bs_player(nm),
+    stop(false),
+    snapshot(nullptr),
+    job_row(0),
+    job_col(0)
+{}
+
+
+async_player::async_player()
+:   bs_player(),
+    stop(false),
+    snapshot(nullptr),
+    job_row(0),
+    job_col(0)
+{}
+
+
+async_player::~async_player(){
+    // the derived part (used by think()) is already destroyed at this point,
+    // derived classes should call stop_pondering() in their own destructor
+    stop_pondering();
+    delete snapshot;
+}
+
+
+void async_player::stop_pondering(){
+    if(!job.valid()) return;
+    stop = true;
+    job.wait();
+    job = std::future<bool>();
+    position.clear();
+}
+
+
+bool async_player::on_current_position(){
+    if(!job.valid() || position.size() != hit_grid->get_width() * hit_grid->get_height())
+        return false;
+
+    size_t k = 0;
+    for(size_t i=0; i<hit_grid->get_height(); ++i)
+        for(size_t j=0; j<hit_grid->get_width(); ++j)
+            if(hit_grid->cell_at(i, j).state != position[k++]) return false;
+
+    return true;
+}
+
+
+void async_player::start_job(){
+    // snapshot the position, the game keeps changing the hit grid meanwhile
+    if(snapshot == nullptr) snapshot = new bs_grid(*hit_grid);
+    else *snapshot = *hit_grid;
+
+    position.clear();
+    for(size_t i=0; i<hit_grid->get_height(); ++i)
+        for(size_t j=0; j<hit_grid->get_width(); ++j)
+            position.push_back(hit_grid->cell_at(i, j).state);
+
+    stop = false;
+    job = std::async(std::launch::async, [this](){
+        return think(*snapshot, stop, job_row, job_col);
+    });
+}
+
+
+void async_player::reset(){
+    stop_pondering();
+    bs_player::reset();
+}
+
+
+void async_player::on_update(){
+    if(game == nullptr || hidden_grid == nullptr || hit_grid == nullptr) return;
+
+    // nothing to think about before the player's ships are placed or after the game
+    if(!hidden_grid->is_ready() || game->is_finished()){
+        stop_pondering();
+        return;
+    }
+
+    if(on_current_position()) return;
+    stop_pondering();
+
+    start_job();
+}
+
+
+void async_player::move(){
+
+    if(game == nullptr || hidden_grid == nullptr || hit_grid == nullptr){
+        std::cout << "Can't move on a nullptr {game, hidden_grid, hit_grid}" << std::endl;
+        throw illegal_move_exception("Move on nullptr");
+    }
+
+    // placement is random
+    if(!hidden_grid->is_ready()){
+        bs_player::move();
+        return;
+    }
+
+    // no background work on this position (e.g. the game never notified us)
+    if(!on_current_position()){
+        stop_pondering();
+        start_job();
+    }
+
+    // under time control, give up with some of the budget left to move randomly
+    std::chrono::nanoseconds left = game->time_left();
+    if(left != std::chrono::nanoseconds::max() && job.wait_for(left - left/8) != std::future_status::ready){
+        stop_pondering();
+        bs_player::move();
+        return;
+    }
+
+    bool found = job.get();
+    size_t row = job_row, col = job_col;
+    position.clear();
+
+    if(found && hit_grid->cell_at(row, col).can_shoot()) game->shoot_at(row, col);
+    else bs_player::move();
+}
+
+
+}
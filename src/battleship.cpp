@@ -1,5 +1,8 @@
 #include "battleship.h"
 #include "console_game.h"
+#include "trace.h"
+#include <algorithm>
+#include <vector>
 
 namespace bship{
 
@@ -15,7 +18,12 @@ battleship::battleship(size_t width, size_t height, output_mode om)
     ships_placed(false),
     pa_turn(true),
     pa_won(false),
-    output(om)
+    output(om),
+    timed(false),
+    moved(false),
+    clock_pa(true),
+    pa_time(0),
+    pb_time(0)
 {
     pa = nullptr;
     pb = nullptr;
@@ -37,21 +45,182 @@ void battleship::set_pb(bs_player *p){ pb = p; }
 bs_player * battleship::get_winner(){ return (!finished) ? nullptr : (pa_won) ? pa : pb; }
 
 
+bs_player * battleship::get_current_player(){ return (pa_turn) ? pa : pb; }
+
+
 int battleship::get_total_shots(){ return total_shots; }
 
 
+bool battleship::is_finished(){ return finished; }
+
+
+void battleship::notify_players(){
+    if(pa) pa->on_update();
+    if(pb) pb->on_update();
+}
+
+
+void battleship::set_time_control(const time_control& t){ tc = t; }
+
+
+time_control battleship::get_time_control(){ return tc; }
+
+
+std::chrono::nanoseconds battleship::time_left(){
+    if(!timed) return std::chrono::nanoseconds::max();
+    clock::duration left = deadline - clock::now();
+    return std::max(std::chrono::nanoseconds(0), std::chrono::duration_cast<std::chrono::nanoseconds>(left));
+}
+
+
+std::chrono::nanoseconds battleship::get_time_used(bs_player *p){
+    if(p == nullptr) return std::chrono::nanoseconds(0);
+    if(p == pa) return std::chrono::duration_cast<std::chrono::nanoseconds>(pa_time);
+    if(p == pb) return std::chrono::duration_cast<std::chrono::nanoseconds>(pb_time);
+    return std::chrono::nanoseconds(0);
+}
+
+
+void battleship::add_listener(game_listener *l){
+    if(l && std::find(listeners.begin(), listeners.end(), l) == listeners.end())
+        listeners.push_back(l);
+}
+
+
+void battleship::remove_listener(game_listener *l){
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), l), listeners.end());
+}
+
+
+void battleship::finish(bool a_won){
+    finished = true;
+    pa_won = a_won;
+    for(game_listener *l : listeners) l->on_game_over(*this, pa_won);
+    notify_players();
+}
+
+
+void battleship::start_clock(){
+    move_start = clock::now();
+    moved      = false;
+    clock_pa   = pa_turn;
+    timed      = false;
+
+    if(tc.per_move.count() > 0){
+        deadline = move_start + tc.per_move;
+        timed = true;
+    }
+
+    // the rest of the game budget may be shorter than a move (or already spent)
+    if(tc.per_game.count() > 0){
+        clock::time_point end = move_start + (tc.per_game - ((pa_turn) ? pa_time : pb_time));
+        if(!timed || end < deadline) deadline = end;
+        timed = true;
+    }
+}
+
+
+bool battleship::stop_clock(){
+    clock::time_point now = clock::now();
+    ((clock_pa) ? pa_time : pb_time) += now - move_start;
+
+    BS_MOVE_TIME(((clock_pa) ? pa : pb)->get_name(), std::chrono::duration_cast<std::chrono::nanoseconds>(now - move_start));
+
+    bool late = timed && now > deadline;
+    timed = false;
+    return late;
+}
+
+
+void battleship::check_deadline(){
+    if(!timed || clock::now() <= deadline) return;
+
+    // only the first late move is replaced, any further one is refused
+    if(!moved && !finished) overrun();
+    throw time_exception("Move after the deadline");
+}
+
+
+void battleship::overrun(){
+    if(output == OM_BOTH || output == OM_TXTONLY){
+        std::string pl = (pa_turn) ? pa->get_name() : pb->get_name();
+        std::cout << pl << " ran out of time";
+        std::cout << ((tc.policy == OP_FORFEIT) ? ", forfeits" : ", moving randomly");
+        std::cout << std::endl;
+    }
+
+    if(tc.policy == OP_RANDOM_MOVE) random_move();
+    else finish(!pa_turn);
+}
+
+
+void battleship::random_move(){
+    bs_grid& hidden = (pa_turn) ? pa_hidden_grid : pb_hidden_grid;
+    bs_grid& hit    = (pa_turn) ? pa_hit_grid    : pb_hit_grid;
+
+    if(!hidden.is_ready()){
+        // the ship the player would place next (see bs_player::next_ship()), so
+        // that it carries on with the following one
+        bs_player *pl = (pa_turn) ? pa : pb;
+        ship_type type = pl->next_ship();
+
+        for(int tries=0; tries<1000; ++tries){
+            size_t r = rand() % hidden.get_height();
+            size_t c = rand() % hidden.get_width();
+            try{
+                if(do_place_ship(type, r, c, (rand() % 2) ? SO_HOR : SO_VERT)) return;
+            }
+            catch(bship_exception& e){}
+        }
+
+        // the fleet does not fit (tiny grid), there is no legal move
+        finish(!pa_turn);
+        return;
+    }
+
+    std::vector<std::pair<size_t, size_t>> cells;
+    for(size_t i=0; i<hit.get_height(); ++i)
+        for(size_t j=0; j<hit.get_width(); ++j)
+            if(hit.cell_at(i, j).can_shoot()) cells.push_back(std::make_pair(i, j));
+
+    if(!cells.empty()){
+        std::pair<size_t, size_t> cl = cells[rand() % cells.size()];
+        do_shoot_at(cl.first, cl.second);
+    }
+}
+
+
 bool battleship::place_ship(ship_type type, size_t row, size_t col, ship_orientation orient){
+    check_deadline();
+    return do_place_ship(type, row, col, orient);
+}
+
+
+std::pair<shot_result, int> battleship::shoot_at(size_t row, size_t col){
+    check_deadline();
+    return do_shoot_at(row, col);
+}
+
+
+bool battleship::do_place_ship(ship_type type, size_t row, size_t col, ship_orientation orient){
     bool res;
+    BS_COUNT(MC_PLACEMENTS);
 
     // place the ship on current player's hidden grid
     // may throw illegal_move_exception
-    if(pa_turn){
-        res = pa_hidden_grid.place_ship(type, row, col, orient);
-        if(pa_hidden_grid.is_ready()) ships_placed = true;
+    try{
+        if(pa_turn){
+            res = pa_hidden_grid.place_ship(type, row, col, orient);
+            if(pa_hidden_grid.is_ready()) ships_placed = true;
+        }
+        else{
+            res = pb_hidden_grid.place_ship(type, row, col, orient);
+            if(pb_hidden_grid.is_ready()) ships_placed = true;
+        }
     }
-    else{
-        res = pb_hidden_grid.place_ship(type, row, col, orient);
-        if(pb_hidden_grid.is_ready()) ships_placed = true;
+    catch(bship_exception& e){
+        BS_COUNT(MC_PLACEMENTS_REJECTED);
+        throw;
     }
 
     // go to next turn if this turn was successful
@@ -63,8 +232,12 @@ bool battleship::place_ship(ship_type type, size_t row, size_t col, ship_orienta
             std::cout << std::endl;
         }
         pa_turn = !pa_turn;
+        moved = true;
+        for(game_listener *l : listeners) l->on_place(*this, !pa_turn, type, row, col, orient);
+        notify_players();
     }
     else{
+        BS_COUNT(MC_PLACEMENTS_REJECTED);
         if(output == OM_BOTH || output == OM_TXTONLY){
             std::string pl = (pa_turn) ? pa->get_name() : pb->get_name();
             std::cout << pl << " tried to place a " << (int) type << "-cell ship at (" << row << ", " << col << ") ";
@@ -77,7 +250,7 @@ bool battleship::place_ship(ship_type type, size_t row, size_t col, ship_orienta
 }
 
 
-std::pair<shot_result, int> battleship::shoot_at(size_t row, size_t col){
+std::pair<shot_result, int> battleship::do_shoot_at(size_t row, size_t col){
     std::pair<shot_result, int> res;
     // instead of doing the same thing in two branches, pointers are kept
     bs_grid *opponent_hidden_grid, *player_hit_grid;
@@ -93,10 +266,8 @@ std::pair<shot_result, int> battleship::shoot_at(size_t row, size_t col){
     player_hit_grid->cell_at(row, col).state = (res.first == SR_MISS) ? CS_MISSED : CS_DESTROYED;
 
     // if the hit ship was the last one
-    if(res.first == SR_SINK && opponent_hidden_grid->get_num_alive_ships() == 0){
-        finished = true;
-        if(pa_turn) pa_won = true;
-    }
+    const bool by_pa = pa_turn;
+    const bool won   = (res.first == SR_SINK && opponent_hidden_grid->get_num_alive_ships() == 0);
 
     // next player moves if current player misses
     if(res.first == SR_MISS) pa_turn = !pa_turn;
@@ -111,29 +282,87 @@ std::pair<shot_result, int> battleship::shoot_at(size_t row, size_t col){
     }
 
     ++total_shots;
+    moved = true;
+    BS_COUNT(MC_SHOTS);
+    for(game_listener *l : listeners) l->on_shot(*this, by_pa, row, col, res);
+
+    if(won) finish(by_pa);
+    else notify_players();
 
     return res;
 }
 
 
 void battleship::start(){
+    BS_TRACE("game", "game");
+
+    // the placement and shooting phases are traced as they end
+    std::chrono::steady_clock::time_point phase_start = std::chrono::steady_clock::now();
+    bool placing = true;
+
     while(!finished){
-        std::system("clear");
         if(pa_turn){
             if(output != OM_TXTONLY && (output == OM_BOTH || output == OM_PA)){
+                std::system("clear");
                 std::cout << pa->get_name() << "'s grids:" << std::endl;
                 print_grids(&pa_hidden_grid, &pa_hit_grid);
             }
-            pa->move();
         }
         else{
             if(output != OM_TXTONLY && (output == OM_BOTH || output == OM_PB)){
+                std::system("clear");
                 std::cout << pb->get_name() << "'s grids:" << std::endl;
                 print_grids(&pb_hidden_grid, &pb_hit_grid);
             }
-            pb->move();
+        }
+
+        {
+            BS_TRACE((pa_turn) ? "move A" : "move B", "move");
+            start_clock();
+            try{
+                if(pa_turn) pa->move();
+                else pb->move();
+            }
+            catch(time_exception& e){
+                // late move, the overrun policy has been applied
+            }
+
+            // returned late without moving
+            if(stop_clock() && !moved && !finished) overrun();
+        }
+
+        if(placing && ((pa_hidden_grid.is_ready() && pb_hidden_grid.is_ready()) || finished)){
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            tracer::complete("placement", "game", phase_start, now);
+            phase_start = now;
+            placing = false;
         }
     }
+
+    if(!placing && pa_hidden_grid.is_ready() && pb_hidden_grid.is_ready())
+        tracer::complete("shooting", "game", phase_start, std::chrono::steady_clock::now());
+}
+
+
+void battleship::reset(){
+    pa_hidden_grid.reset();
+    pa_hit_grid.reset();
+    pb_hidden_grid.reset();
+    pb_hit_grid.reset();
+
+    total_shots  = 0;
+    finished     = false;
+    ships_placed = false;
+    pa_turn      = true;
+    pa_won       = false;
+    timed        = false;
+    moved        = false;
+    clock_pa     = true;
+    pa_time      = clock::duration(0);
+    pb_time      = clock::duration(0);
+
+    if(pa) pa->reset();
+    if(pb) pb->reset();
 }
 
 
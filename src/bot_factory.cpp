@@ -0,0 +1,31 @@
+#include <cstdlib>
+#include "bot_factory.h"
+#include "hiding_player.h"
+#include "model_player.h"
+#include "prob_player.h"
+#include "slick_player.h"
+
+namespace bship{
+
+
+const char *const BOT_SPECS = "random, slick[:difficulty], prob, model[:prior dir], hide[:parity|uniform]";
+
+
+bs_player *make_bot(const std::string& spec, const std::string& name){
+    // the settings follow the bot's name after a colon
+    std::string arg = (spec.find(':') != std::string::npos) ? spec.substr(spec.find(':') + 1) : "";
+    std::string bot = spec.substr(0, spec.find(':'));
+
+    if(bot == "random" && arg.empty()) return new bs_player(name);
+    if(bot == "prob" && arg.empty()) return new prob_player(name);
+    if(bot == "slick") return new slick_player(name, (arg.empty()) ? 0.2 : atof(arg.c_str()));
+    if(bot == "model") return new model_player(name, arg);
+    if(bot == "hide"){
+        if(arg.empty() || arg == "parity") return new hiding_player(name, DM_PARITY);
+        if(arg == "uniform") return new hiding_player(name, DM_UNIFORM);
+    }
+    return nullptr;
+}
+
+
+}
@@ -13,7 +13,9 @@ bs_grid::bs_grid(size_t width_, size_t height_)
         {ST_FIVE,  1}
     }),
     state(GS_PLACING),
-    alive_ships(0)
+    alive_ships(0),
+    masks(placement_table(width_, height_)),
+    stale(false)
 {
 
     if(width == 0 || height == 0){
@@ -30,6 +32,48 @@ bs_grid::bs_grid(size_t width_, size_t height_)
 }
 
 
+bs_grid::bs_grid(const bs_grid& other)
+:   width(other.width),
+    height(other.height),
+    state(other.state),
+    n_ships(other.n_ships),
+    max_n_ships(other.max_n_ships),
+    alive_ships(other.alive_ships),
+    cur_ship_id(other.cur_ship_id),
+    masks(other.masks),
+    taken(other.taken),
+    stale(other.stale)
+{
+    data = new cell[width * height];
+    std::copy(other.data, other.data + width*height, data);
+}
+
+
+bs_grid& bs_grid::operator=(const bs_grid& other){
+    if(this == &other) return *this;
+
+    // reallocate only if the size changes
+    if(width * height != other.width * other.height){
+        delete[] data;
+        data = new cell[other.width * other.height];
+    }
+
+    width       = other.width;
+    height      = other.height;
+    state       = other.state;
+    n_ships     = other.n_ships;
+    max_n_ships = other.max_n_ships;
+    alive_ships = other.alive_ships;
+    cur_ship_id = other.cur_ship_id;
+    masks       = other.masks;
+    taken       = other.taken;
+    stale       = other.stale;
+    std::copy(other.data, other.data + width*height, data);
+
+    return *this;
+}
+
+
 bs_grid::~bs_grid(){
     delete[] data;
 }
@@ -44,29 +88,31 @@ size_t bs_grid::get_height() const { return height; }
 bool bs_grid::is_ready() const { return state == GS_READY; }
 
 
-int bs_grid::get_num_alive_ships() const { return alive_ships; }
-
+void bs_grid::reset(){
+    std::fill(data, data + width*height, cell());
+    for(auto& tp : n_ships) tp.second = 0;
+    state       = GS_PLACING;
+    alive_ships = 0;
+    cur_ship_id = 0;
+    taken       = bitboard();
+    stale       = false;
+}
 
-std::map<ship_type, uint8_t> bs_grid::get_n_ships() const { return n_ships; }
 
+int bs_grid::get_num_alive_ships() const { return alive_ships; }
 
-std::map<ship_type, uint8_t> bs_grid::get_max_n_ships() const { return max_n_ships; }
 
+const std::map<ship_type, uint8_t>& bs_grid::get_n_ships() const { return n_ships; }
 
-inline cell& bs_grid::cell_at(size_t row, size_t col){
-    if(row >= height || col >= width)
-        throw index_exception(row, col, "Index out of bounds: ");
 
-    // row-major order
-    return data[row*width + col];
-}
+const std::map<ship_type, uint8_t>& bs_grid::get_max_n_ships() const { return max_n_ships; }
 
 
-inline bool bs_grid::ship_sunk(int ship_id){
+bool bs_grid::ship_sunk(int ship_id){
     for(size_t i=0; i<height; ++i){
         for(size_t j=0; j<width; ++j){
             // if there exists at least one cell containing part of ship with given id that has not been destroyed
-            if(cell_at(i, j).ship_id == ship_id && cell_at(i, j).state == CS_FULL)
+            if(at(i, j).ship_id == ship_id && at(i, j).state == CS_FULL)
                 return false;
         }
     }
@@ -74,11 +120,11 @@ inline bool bs_grid::ship_sunk(int ship_id){
 }
 
 
-inline bool bs_grid::all_ships_sunk(){
+bool bs_grid::all_ships_sunk(){
     // check all populated cells, and if any of them is not hit, return false
     for(size_t i=0; i<height; ++i){
         for(size_t j=0; j<width; ++j){
-            if(cell_at(i, j).state == CS_FULL)
+            if(at(i, j).state == CS_FULL)
                 return false;
         }
     }
@@ -99,34 +145,15 @@ bool bs_grid::place_ship(ship_type type, size_t row, size_t col, ship_orientatio
         throw illegal_move_exception("Ship type has been placed MAX times already");
     }
 
-    // holds cells to place ship on if placement is possible
-    std::vector<std::pair<size_t, size_t>> to_place;
-    size_t r = row, c = col;
-
-    // loop over the ship length and add cells to vector for later placement
-    for(int sz=0; sz<type; ++sz){
-
-        try{
-            // if any of the cells are not available, the placement cannot be done
-            if(!cell_at(r, c).can_place()) return false;
-        }
-        catch(index_exception& e){
-            // placement is not possible if a coordinate is out of bounds
-            return false;
-        }
-
-        // if the cell is okay to place, add it to vector
-        to_place.push_back({r, c});
-
-        // increment column or row value according to orientation
-        if(orient == SO_HOR) ++c;
-        else ++r;
-    }
+    if(!can_place_ship(type, row, col, orient)) return false;
 
     // place ship
-    for(auto& coord : to_place){
-        cell_at(coord.first, coord.second).state = CS_FULL;
-        cell_at(coord.first, coord.second).ship_id = cur_ship_id;
+    size_t dr = (orient == SO_HOR) ? 0 : 1, dc = (orient == SO_HOR) ? 1 : 0;
+    if(masks) taken |= masks[placement_index(width, height, type, row, col, orient == SO_VERT)];
+    for(int sz=0; sz<type; ++sz){
+        cell& cl = at(row + dr*sz, col + dc*sz);
+        cl.state   = CS_FULL;
+        cl.ship_id = cur_ship_id;
     }
     
     // there is one more ship of type TYPE now
@@ -146,25 +173,51 @@ bool bs_grid::place_ship(ship_type type, size_t row, size_t col, ship_orientatio
 }
 
 
+bool bs_grid::can_place_ship(ship_type type, size_t row, size_t col, ship_orientation orient){
+
+    // placement is not possible if a coordinate is out of bounds
+    size_t dr = (orient == SO_HOR) ? 0 : 1, dc = (orient == SO_HOR) ? 1 : 0;
+    if(row >= height || col >= width || row + dr*(type-1) >= height || col + dc*(type-1) >= width) return false;
+
+    // standard sizes: none of the cells of the mask may be taken
+    if(masks && stale) rebuild_taken();
+    if(masks) return !masks[placement_index(width, height, type, row, col, orient == SO_VERT)].intersects(taken);
+
+    // if any of the cells are not available, the placement cannot be done
+    for(int sz=0; sz<type; ++sz)
+        if(!at(row + dr*sz, col + dc*sz).can_place()) return false;
+    return true;
+}
+
+
+void bs_grid::rebuild_taken(){
+    taken = bitboard();
+    for(size_t i=0; i<width*height; ++i)
+        if(!data[i].can_place()) taken.set(i);
+    stale = false;
+}
+
+
 std::pair<shot_result, int> bs_grid::shoot_at(size_t row, size_t col){
     
     // the move is illegal if the cell has been shot before
-    // cell_at() may also throw index_exception
-    if(!cell_at(row, col).can_shoot())
+    // at() may also throw index_exception
+    if(!at(row, col).can_shoot())
         throw illegal_move_exception("Cell has been shot before");
 
     shot_result sr;
     int shot_ship_id = -1;
 
     // change state of the cell depending on previous state
-    if(cell_at(row, col).state == CS_EMPTY){
-        cell_at(row, col).state = CS_MISSED;
+    if(at(row, col).state == CS_EMPTY){
+        at(row, col).state = CS_MISSED;
+        if(masks) taken.set(row * width + col);
         sr = SR_MISS;
     }
-    else if(cell_at(row, col).state == CS_FULL){
-        cell_at(row, col).state = CS_DESTROYED;
+    else if(at(row, col).state == CS_FULL){
+        at(row, col).state = CS_DESTROYED;
         sr = SR_HIT;
-        shot_ship_id = cell_at(row, col).ship_id;
+        shot_ship_id = at(row, col).ship_id;
 
         // if ship is sunk
         if(ship_sunk(shot_ship_id)){
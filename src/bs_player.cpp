@@ -7,16 +7,14 @@ bs_player::bs_player(std::string& n, bs_grid* hdg, bs_grid* htg, battleship *gm)
 :   name(n),
     hidden_grid(hdg),
     hit_grid(htg),
-    game(gm),
-    sindex(0)
+    game(gm)
 {}
 
 bs_player::bs_player(std::string nm)
 :   name(nm),
     hidden_grid(nullptr),
     hit_grid(nullptr),
-    game(nullptr),
-    sindex(0)
+    game(nullptr)
 {}
 
 
@@ -24,15 +22,14 @@ bs_player::bs_player()
 :   name("<Unknown>"),
     hidden_grid(nullptr),
     hit_grid(nullptr),
-    game(nullptr),
-    sindex(0)
+    game(nullptr)
 {}
 
 
 bs_player::~bs_player() = default;
 
 
-std::string bs_player::get_name(){ return name; }
+const std::string& bs_player::get_name() const { return name; }
 
 
 void bs_player::set_name(std::string& n){ name = n; }
@@ -60,27 +57,23 @@ void bs_player::move(){
     unsigned long tries = 0;
     ship_orientation ori;
     
-    if(stype.size() == 0){
-        // add possible ship types to array
-        for(auto& p : hidden_grid->get_max_n_ships()){
-            for(int i=0; i<p.second; ++i)
-                stype.push_back(p.first);
-        }
-    }
-
     if(!hidden_grid->is_ready()){
+        ship_type type = next_ship();
         while(!valid_move){
             ++tries;            
             r = rand() % hit_grid->get_height();
             c = rand() % hit_grid->get_width();
             ori = (rand() % 2) ? SO_HOR : SO_VERT;
 
+            // placements that do not fit are skipped without going through the game
+            if(!hidden_grid->can_place_ship(type, r, c, ori)) continue;
+
             try{
-                valid_move = game->place_ship(stype[sindex], r, c, ori);
-                if(valid_move) ++sindex;
+                valid_move = game->place_ship(type, r, c, ori);
             }
             catch(illegal_move_exception& e){}
         }
+        BS_COUNT_N(MC_RETRIES, tries - 1);
     }
     else{
          while(!valid_move){
@@ -88,14 +81,36 @@ void bs_player::move(){
             r = rand() % hit_grid->get_height();
             c = rand() % hit_grid->get_width();
 
+            // cells shot before are skipped without throwing
+            if(!hit_grid->cell_at(r, c).can_shoot()) continue;
+
             try{
                 sr = game->shoot_at(r, c);
                 valid_move = true;
             }
             catch(illegal_move_exception& e){}
         }
+        BS_COUNT_N(MC_RETRIES, tries - 1);
+    }
+}
+
+
+void bs_player::on_update(){}
+
+
+void bs_player::reset(){}
+
+
+ship_type bs_player::next_ship() const {
+    // smallest first; read from the grid, so that a ship placed by the game
+    // for the player (see battleship::random_move()) is not placed twice
+    const std::map<ship_type, uint8_t>& n = hidden_grid->get_n_ships();
+    for(auto& tp : hidden_grid->get_max_n_ships()){
+        auto it = n.find(tp.first);
+        if(it == n.end() || it->second < tp.second) return tp.first;
     }
+    throw illegal_move_exception("All ships placed");
 }
 
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,90 @@
+#include <exception>
+#include "bship_c.h"
+#include "vec_env.h"
+
+
+// the handle is the environments themselves
+struct bship_vec_env{
+    bship::vec_env  env;
+
+    bship_vec_env(size_t n_envs, size_t width, size_t height, int n_threads, uint64_t seed, const bship::env_rewards& r)
+    :   env(n_envs, width, height, n_threads, seed, r) {}
+};
+
+
+// no exception may cross the C interface
+extern "C" {
+
+
+void bship_default_rewards(bship_rewards *rewards){
+    bship::env_rewards r;
+    rewards->miss      = r.miss;
+    rewards->hit       = r.hit;
+    rewards->sink      = r.sink;
+    rewards->win       = r.win;
+    rewards->illegal   = r.illegal;
+    rewards->max_steps = r.max_steps;
+}
+
+
+bship_vec_env *bship_vec_env_create(size_t n_envs, size_t width, size_t height, int n_threads,
+                                    uint64_t seed, const bship_rewards *rewards){
+    bship::env_rewards r;
+    if(rewards){
+        r.miss      = rewards->miss;
+        r.hit       = rewards->hit;
+        r.sink      = rewards->sink;
+        r.win       = rewards->win;
+        r.illegal   = rewards->illegal;
+        r.max_steps = rewards->max_steps;
+    }
+
+    try{
+        return new bship_vec_env(n_envs, width, height, n_threads, seed, r);
+    }
+    catch(std::exception&){
+        return nullptr;
+    }
+}
+
+
+void bship_vec_env_destroy(bship_vec_env *env){ delete env; }
+
+
+size_t bship_vec_env_n_envs(const bship_vec_env *env){ return (env) ? env->env.get_n_envs() : 0; }
+
+
+size_t bship_vec_env_obs_size(const bship_vec_env *env){ return (env) ? env->env.get_obs_size() : 0; }
+
+
+int bship_vec_env_reset(bship_vec_env *env, float *obs){
+    if(env == nullptr) return -1;
+    try{
+        env->env.reset(obs);
+    }
+    catch(std::exception&){
+        return -1;
+    }
+    return 0;
+}
+
+
+int bship_vec_env_step(bship_vec_env *env, const int32_t *actions, float *obs, float *rewards, uint8_t *dones){
+    if(env == nullptr || actions == nullptr) return -1;
+    try{
+        env->env.step(actions, obs, rewards, dones);
+    }
+    catch(std::exception&){
+        return -1;
+    }
+    return 0;
+}
+
+
+int bship_vec_env_last_length(const bship_vec_env *env, size_t i){
+    if(env == nullptr || i >= env->env.get_n_envs()) return -1;
+    return env->env.get_last_length(i);
+}
+
+
+}
@@ -0,0 +1,71 @@
+/*!
+    Calibrates the difficulty of slick_player against a reference bot and
+    writes the table the game loads at startup (see calibration.h)
+
+    usage: bship_calibrate <table file> <reference bot> <threads> <win|shots> <targets...>
+
+    bots: random, slick[:difficulty], prob, model[:prior dir], hide[:parity|uniform]
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bot_factory.h"
+#include "calibration.h"
+
+using namespace bship;
+using namespace std;
+
+
+int main(int argc, char **argv){
+    if(argc < 6){
+        cerr << "usage: " << argv[0] << " <table file> <reference bot> <threads> <win|shots> <targets...>" << endl;
+        cerr << "bots: " << BOT_SPECS << endl;
+        cerr << "targets: win rates of slick_player (e.g. 0.25 0.5 0.75) or its mean shots to win" << endl;
+        return 1;
+    }
+    srand(time(NULL));
+
+    string path = argv[1], spec = argv[2], kind_name = argv[4];
+    if(kind_name != "win" && kind_name != "shots"){
+        cerr << "unknown target kind " << kind_name << endl;
+        return 1;
+    }
+    calib_target kind = (kind_name == "shots") ? CT_SHOTS : CT_WIN_RATE;
+
+    unique_ptr<bs_player> check(make_bot(spec, "check"));
+    if(!check){
+        cerr << "unknown bot" << endl;
+        return 1;
+    }
+
+    calib_config cfg;
+    cfg.threads = max(1, atoi(argv[3]));
+    if(kind == CT_SHOTS) cfg.tolerance = 0.005;
+
+    vector<double> targets;
+    for(int i=5; i<argc; ++i) targets.push_back(atof(argv[i]));
+
+    difficulty_calibrator calib([&](const string& name){ return make_bot(spec, name); }, cfg);
+    vector<calib_point> table;
+
+    auto start = chrono::steady_clock::now();
+    for(double t : targets){
+        calib_point pt = calib.calibrate(kind, t);
+        table.push_back(pt);
+        cout << kind_name << " " << t << ": peek_prob " << pt.peek_prob << ", measured "
+             << pt.value << " +- " << pt.half_width << " over " << pt.games << " games" << endl;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << calib.get_games() << " games in " << secs << " s" << endl;
+
+    if(!save_difficulty_table(path, spec, table)){
+        cerr << "can't write " << path << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include "battleship.h"
+#include "calibration.h"
+#include "slick_player.h"
+
+namespace bship{
+
+
+/// Counts the shots of each side of the games it listens to
+class shot_tally : public game_listener{
+public:
+    shot_tally(){ shots[0] = shots[1] = 0; }
+
+    void on_shot(battleship&, bool by_pa, size_t, size_t, std::pair<shot_result, int>){ ++shots[(by_pa) ? 0 : 1]; }
+
+    int shots[2];   ///< shots by A, B since the last reset
+};
+
+
+static const char *target_name(calib_target kind){ return (kind == CT_SHOTS) ? "shots" : "win"; }
+
+
+/*!
+    Half width, in standard deviations, of a confidence sequence of the mean
+    of n samples: the normal mixture boundary of Robbins, which holds at every
+    n at once, so that the running mean can be tested after every batch and
+    the test stopped at any of them with the confidence level of z. The
+    mixture is tuned to be narrowest at n_opt samples
+*/
+static double sequence_width(double n, double z, double n_opt){
+    double alpha = std::erfc(z / std::sqrt(2.0));
+    double rho2 = (-2 * std::log(alpha) + std::log(1 - 2 * std::log(alpha))) / n_opt;
+    double v = n * rho2 + 1;
+    return std::sqrt(2 * v / (n * n * rho2) * std::log(std::sqrt(v) / alpha));
+}
+
+
+
+difficulty_calibrator::difficulty_calibrator(const bot_factory& make_reference, const calib_config& config)
+:   make_ref(make_reference),
+    cfg(config),
+    games(0)
+{
+    cfg.threads = std::max(cfg.threads, 1);
+    cfg.batch = std::max<uint64_t>(cfg.batch, 2);
+}
+
+
+calib_point difficulty_calibrator::measure(calib_target kind, float peek_prob, double target){
+    running_stats wins, shots;
+    calib_point pt{kind, target, peek_prob, 0, 0, 0};
+
+    // narrowest around the games the tolerance takes at a standard deviation
+    // of half the target (or of a win rate of one half)
+    double n_opt = std::pow(cfg.z / (2 * cfg.tolerance), 2);
+
+    for(;;){
+        play_batch(peek_prob, wins, shots);
+        pt.games = wins.count();
+
+        if(kind == CT_WIN_RATE){
+            // Agresti-Coull: a batch without a single win (or loss) is not a certainty
+            double n = wins.count() + 4.0;
+            double p = (wins.mean() * wins.count() + 2.0) / n;
+            pt.value = wins.mean();
+            pt.half_width = std::sqrt(p * (1 - p)) * sequence_width(wins.count(), cfg.z, n_opt);
+        }
+        else{
+            // no win yet: nothing is known about the shots, except that they are many
+            pt.value = (shots.count()) ? shots.mean() : HUGE_VAL;
+            pt.half_width = (shots.count() > 1) ? shots.stddev() * sequence_width(shots.count(), cfg.z, n_opt) : HUGE_VAL;
+        }
+
+        bool clear = std::fabs(pt.value - target) > pt.half_width;
+        bool tight = pt.half_width <= cfg.tolerance * ((kind == CT_SHOTS) ? target : 1.0);
+        if(clear || tight || pt.games >= cfg.max_games) return pt;
+    }
+}
+
+
+calib_point difficulty_calibrator::calibrate(calib_target kind, double target){
+    // the bot gets stronger with peek_prob: more wins, fewer shots
+    // every step goes the wrong way with the probability of the confidence
+    // level at most, so at the resolution the closest difficulty seen is kept
+    float lo = 0, hi = 1;
+    calib_point best{kind, target, 0.5f, HUGE_VAL, HUGE_VAL, 0};
+    for(;;){
+        float mid = (lo + hi) / 2;
+        calib_point pt = measure(kind, mid, target);
+
+        bool too_weak = (kind == CT_WIN_RATE) ? pt.value < target : pt.value > target;
+        bool clear = std::fabs(pt.value - target) > pt.half_width;
+        if(!clear && pt.games < cfg.max_games) return pt;
+        if(std::fabs(pt.value - target) < std::fabs(best.value - target)) best = pt;
+        if(hi - lo <= cfg.resolution) return best;
+
+        if(too_weak) lo = mid;
+        else hi = mid;
+    }
+}
+
+
+std::vector<calib_point> difficulty_calibrator::table(calib_target kind, const std::vector<double>& targets){
+    std::vector<calib_point> out;
+    for(double t : targets) out.push_back(calibrate(kind, t));
+    return out;
+}
+
+
+uint64_t difficulty_calibrator::get_games() const { return games; }
+
+
+void difficulty_calibrator::play_batch(float peek_prob, running_stats& wins, running_stats& shots){
+    std::vector<running_stats> thread_wins(cfg.threads), thread_shots(cfg.threads);
+
+    // every thread has two game slots, slick_player moving first in one and
+    // second in the other, and alternates between them
+    auto worker = [&](int t){
+        std::unique_ptr<battleship> game[2];
+        std::unique_ptr<bs_player> slick[2], ref[2];
+        shot_tally tally[2];
+        for(int s=0; s<2; ++s){
+            game[s].reset(new battleship(10, 10, OM_SILENT));
+            slick[s].reset(new slick_player("slick", peek_prob));
+            ref[s].reset(make_ref("reference"));
+            if(s == 0) connect(game[s].get(), slick[s].get(), ref[s].get());
+            else connect(game[s].get(), ref[s].get(), slick[s].get());
+            game[s]->add_listener(&tally[s]);
+        }
+
+        for(uint64_t i=0; i<cfg.batch; ++i){
+            int s = i % 2;
+            game[s]->reset();
+            tally[s].shots[0] = tally[s].shots[1] = 0;
+            game[s]->start();
+
+            bool won = game[s]->get_winner() == slick[s].get();
+            thread_wins[t].add(won);
+            if(won) thread_shots[t].add(tally[s].shots[s]);
+        }
+        for(int s=0; s<2; ++s) game[s]->remove_listener(&tally[s]);
+    };
+
+    std::vector<std::thread> threads;
+    for(int t=0; t<cfg.threads; ++t) threads.emplace_back(worker, t);
+    for(auto& t : threads) t.join();
+
+    for(int t=0; t<cfg.threads; ++t){
+        wins.merge(thread_wins[t]);
+        shots.merge(thread_shots[t]);
+    }
+    games += cfg.batch * cfg.threads;
+}
+
+
+bool save_difficulty_table(const std::string& path, const std::string& reference,
+                           const std::vector<calib_point>& table){
+    std::ofstream out(path);
+    if(!out) return false;
+
+    out << "# difficulty table of slick_player against " << reference << "\n";
+    out << "# kind target peek_prob measured half_width games\n";
+    out << "reference " << reference << "\n";
+    for(const calib_point& pt : table){
+        out << target_name(pt.kind) << " " << pt.target << " " << pt.peek_prob << " "
+            << pt.value << " " << pt.half_width << " " << pt.games << "\n";
+    }
+    return (bool) out;
+}
+
+
+std::vector<calib_point> load_difficulty_table(const std::string& path, std::string *reference){
+    std::vector<calib_point> table;
+    std::ifstream in(path);
+    std::string line;
+
+    while(std::getline(in, line)){
+        if(line.empty() || line[0] == '#') continue;
+
+        std::istringstream ls(line);
+        std::string kind;
+        ls >> kind;
+        if(kind == "reference"){
+            if(reference) ls >> *reference;
+            continue;
+        }
+
+        calib_point pt;
+        pt.kind = (kind == "shots") ? CT_SHOTS : CT_WIN_RATE;
+        if((kind == "win" || kind == "shots")
+           && ls >> pt.target >> pt.peek_prob >> pt.value >> pt.half_width >> pt.games
+           && pt.peek_prob >= 0 && pt.peek_prob <= 1){
+            table.push_back(pt);
+        }
+    }
+    return table;
+}
+
+
+}
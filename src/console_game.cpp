@@ -1,4 +1,5 @@
 #include "console_game.h"
+#include "trace.h"
 
 namespace bship{
 
@@ -30,6 +31,7 @@ void console_game::start(){
 
 
 void print_grids(bship::bs_grid *g1, bship::bs_grid *g2){
+    BS_TRACE("print_grids", "render");
 
     // print top numbers
     std::cout << "   ";
@@ -0,0 +1,48 @@
+/*!
+    Writes a corpus of random fleet layouts (see layout_corpus.h), or
+    prints the header of one
+
+    usage: bship_corpus <file> <layouts> [uniform|fast] [seed]
+           bship_corpus <file>
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "bs_grid.h"
+#include "fleet_sampler.h"
+#include "layout_corpus.h"
+
+using namespace bship;
+using namespace std;
+
+
+int main(int argc, char **argv){
+    if(argc < 2){
+        cerr << "usage: " << argv[0] << " <file> <layouts> [uniform|fast] [seed]" << endl;
+        cerr << "       " << argv[0] << " <file>" << endl;
+        return 1;
+    }
+
+    if(argc == 2){
+        layout_corpus corpus;
+        if(!corpus.open(argv[1])){
+            cerr << argv[1] << " is not a layout corpus" << endl;
+            return 1;
+        }
+        cout << corpus.size() << " layouts of " << corpus.get_n_ships() << " ships on "
+             << corpus.get_width() << "x" << corpus.get_height() << endl;
+        return 0;
+    }
+
+    uint64_t count = strtoull(argv[2], nullptr, 10);
+    sampler_mode mode = (argc > 3 && string(argv[3]) == "fast") ? SM_FAST : SM_UNIFORM;
+    uint64_t seed = (argc > 4) ? strtoull(argv[4], nullptr, 10) : 1;
+
+    fleet_sampler sampler(bs_grid(10, 10), mode, seed);
+    if(!corpus_writer::generate(argv[1], count, sampler)){
+        cerr << "can't write the corpus to " << argv[1] << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,278 @@
+#include <cmath>
+#include "endgame.h"
+
+namespace bship{
+
+
+/// enumeration and search give up after visiting this many nodes
+#define ENDGAME_NODE_LIMIT   100000
+
+/// transposition table is cleared when it grows over this many entries
+#define ENDGAME_TABLE_LIMIT  (1 << 20)
+
+
+
+endgame_solver::endgame_solver(size_t width_, size_t height_, const std::map<ship_type, uint8_t>& fleet, size_t max_layouts_)
+:   width(width_),
+    height(height_),
+    max_layouts(max_layouts_),
+    counter(width_, height_, fleet),
+    nodes(0),
+    last_value(0),
+    last_count(0)
+{
+    if(width * height > bitboard::CAPACITY){
+        throw index_exception(width, height, "Grid too large for endgame_solver:");
+    }
+
+    // search nodes keep one bit per layout
+    if(max_layouts > 64) max_layouts = 64;
+
+    // number of ships of each length
+    for(auto& tp : fleet){
+        if(ships.size() <= (size_t) tp.first) ships.resize(tp.first + 1, 0);
+        ships[tp.first] += tp.second;
+    }
+
+    // every placement of every ship length, in the order of their upper-left cell
+    placements.resize(ships.size());
+    for(size_t len=1; len<placements.size(); ++len){
+        for(size_t r=0; r<height; ++r){
+            for(size_t c=0; c<width; ++c){
+                if(c + len <= width){
+                    bitboard b;
+                    for(size_t k=0; k<len; ++k) b.set(r*width + c + k);
+                    placements[len].push_back(b);
+                }
+                if(r + len <= height && len > 1){
+                    bitboard b;
+                    for(size_t k=0; k<len; ++k) b.set((r+k)*width + c);
+                    placements[len].push_back(b);
+                }
+            }
+        }
+    }
+}
+
+
+endgame_solver::endgame_solver(const bs_grid& grid, size_t max_layouts_)
+:   endgame_solver(grid.get_width(), grid.get_height(), grid.get_max_n_ships(), max_layouts_)
+{}
+
+
+double endgame_solver::expected_shots() const { return last_value; }
+
+
+size_t endgame_solver::num_layouts() const { return last_count; }
+
+
+size_t endgame_solver::get_max_layouts() const { return max_layouts; }
+
+
+size_t endgame_solver::table_size() const { return table.size(); }
+
+
+bool endgame_solver::best_shot(bs_grid& obs, size_t& row, size_t& col){
+    if(obs.get_width() != width || obs.get_height() != height)
+        throw index_exception(obs.get_width(), obs.get_height(), "Observation size mismatch:");
+
+    layouts.clear();
+
+    // observation as bitboards
+    bitboard shot, hit;
+    for(size_t i=0; i<height; ++i){
+        for(size_t j=0; j<width; ++j){
+            cell_state st = obs.cell_at(i, j).state;
+            if(st == CS_MISSED || st == CS_DESTROYED) shot.set(i*width + j);
+            if(st == CS_DESTROYED) hit.set(i*width + j);
+        }
+    }
+
+    // too many layouts to search over (counting is much cheaper than enumerating)
+    arr_count n = counter.count(obs);
+    last_count = (n > max_layouts) ? max_layouts + 1 : (size_t) n;
+    if(n == 0 || n > max_layouts) return false;
+
+    // same observation as before (e.g. pondered on, or seen in an earlier game)
+    int best;
+    auto it = table.find(tt_key{shot, hit});
+    if(it != table.end()){
+        best = it->second.cell;
+        last_value = it->second.value;
+        row = best / width;
+        col = best % width;
+        return true;
+    }
+
+    if(!enumerate(shot, hit)) return false;
+
+    // layouts equal to the hits would have ended the game
+    uint64_t cand = 0;
+    double cells_left = 0;
+    for(size_t i=0; i<layouts.size(); ++i){
+        if(layouts[i] == hit) continue;
+        cand |= 1ull << i;
+        cells_left += layouts[i].count() - hit.count();
+    }
+    if(cand == 0) return false;
+
+    // every shot that is not a miss is a cell of the layout that has to be shot anyway,
+    // so the search minimizes the expected number of misses
+    nodes = 0;
+    subsets.clear();
+    double misses = search(shot, cand, best);
+    if(nodes > ENDGAME_NODE_LIMIT) return false;
+    last_value = misses + cells_left / __builtin_popcountll(cand);
+
+    if(table.size() > ENDGAME_TABLE_LIMIT) table.clear();
+    table[tt_key{shot, hit}] = tt_entry{last_value, best};
+
+    row = best / width;
+    col = best % width;
+    return true;
+}
+
+
+bool endgame_solver::enumerate(const bitboard& shot, const bitboard& hit){
+    bitboard missed;
+    missed.w[0] = shot.w[0] & ~hit.w[0];
+    missed.w[1] = shot.w[1] & ~hit.w[1];
+
+    nodes = 0;
+    std::vector<int> left = ships;
+    place_hits(left, bitboard(), missed, hit);
+
+    // gave up (the count said it should not happen, but the node limit may)
+    return nodes <= ENDGAME_NODE_LIMIT && layouts.size() <= max_layouts;
+}
+
+
+void endgame_solver::place_hits(std::vector<int>& left, const bitboard& occ, const bitboard& missed, const bitboard& hit){
+    if(++nodes > ENDGAME_NODE_LIMIT || layouts.size() > max_layouts) return;
+
+    // first hit not covered yet
+    int h = -1;
+    if(hit.w[0] & ~occ.w[0]) h = __builtin_ctzll(hit.w[0] & ~occ.w[0]);
+    else if(hit.w[1] & ~occ.w[1]) h = 64 + __builtin_ctzll(hit.w[1] & ~occ.w[1]);
+
+    if(h < 0){
+        place_free(left, left.size() - 1, -1, occ, missed);
+        return;
+    }
+
+    // exactly one ship covers it, try every ship type and placement
+    for(size_t len=1; len<left.size(); ++len){
+        if(left[len] == 0) continue;
+        --left[len];
+        for(auto& p : placements[len]){
+            if(!p.test(h) || p.intersects(occ) || p.intersects(missed)) continue;
+            place_hits(left, occ | p, missed, hit);
+        }
+        ++left[len];
+    }
+}
+
+
+void endgame_solver::place_free(std::vector<int>& left, size_t len, int min_idx, const bitboard& occ, const bitboard& missed){
+    while(len > 0 && left[len] == 0){
+        --len;
+        min_idx = -1;
+    }
+
+    if(len == 0){
+        layouts.push_back(occ);
+        return;
+    }
+
+    if(++nodes > ENDGAME_NODE_LIMIT || layouts.size() > max_layouts) return;
+
+    // same-length ships go in increasing placement order, so every set is seen once
+    const std::vector<bitboard>& pl = placements[len];
+    --left[len];
+    for(int i=min_idx+1; i<(int) pl.size(); ++i){
+        if(pl[i].intersects(occ) || pl[i].intersects(missed)) continue;
+        place_free(left, len, i, occ | pl[i], missed);
+    }
+    ++left[len];
+}
+
+
+double endgame_solver::search(const bitboard& shot, uint64_t cand, int& best){
+    // the expected number of misses only depends on the layouts left: a cell covered
+    // by all of them costs no miss whether it has been shot already or not, and a
+    // cell covered by only some of them can not have been shot yet
+    auto it = subsets.find(cand);
+    if(it != subsets.end()){
+        best = it->second.cell;
+        return it->second.value;
+    }
+
+    // out of budget, the result is discarded by best_shot()
+    if(++nodes > ENDGAME_NODE_LIMIT) return 0;
+
+    const size_t ncells = width * height;
+    const double total  = __builtin_popcountll(cand);
+
+    // which of the layouts cover each unshot cell (one bit per layout)
+    std::vector<std::pair<uint64_t, int>> sig(ncells);
+    for(size_t x=0; x<ncells; ++x) sig[x] = {0, (int) x};
+    for(uint64_t ls = cand; ls; ls &= ls - 1){
+        const int i = __builtin_ctzll(ls);
+        for(int k=0; k<2; ++k){
+            for(uint64_t bits = layouts[i].w[k] & ~shot.w[k]; bits; bits &= bits - 1)
+                sig[64*k + __builtin_ctzll(bits)].first |= 1ull << i;
+        }
+    }
+
+    // cells splitting the layouts the same way are equivalent, try one of each:
+    // certain hits first (they never hurt, every ship cell has to be shot anyway),
+    // then the most balanced splits (they tend to be the best)
+    std::sort(sig.begin(), sig.end());
+    std::vector<std::pair<double, int>> order;
+    for(size_t x=0; x<ncells; ++x){
+        if(sig[x].first == 0 || (x > 0 && sig[x].first == sig[x-1].first)) continue;
+        const double n_hit = __builtin_popcountll(sig[x].first);
+        order.push_back({(n_hit == total) ? -1 : std::abs(2*n_hit - total), x});
+    }
+    std::sort(order.begin(), order.end());
+
+    double best_v = 0;
+    best = -1;
+
+    for(auto& o : order){
+        const uint64_t covering = sig[o.second].first;
+        const int      x        = sig[o.second].second;
+        const double   p_miss   = (total - __builtin_popcountll(covering)) / total;
+
+        if(best >= 0 && p_miss >= best_v) continue;
+
+        bitboard nshot = shot;
+        nshot.set(x);
+
+        // layouts shot completely are finished
+        uint64_t on_hit = 0, on_miss = cand & ~covering;
+        for(uint64_t ls = covering; ls; ls &= ls - 1){
+            const int i = __builtin_ctzll(ls);
+            if(!layouts[i].subset_of(nshot)) on_hit |= 1ull << i;
+        }
+
+        int b;
+        double v = p_miss;
+        if(on_miss) v += p_miss * search(nshot, on_miss, b);
+        if(best >= 0 && v >= best_v) continue;
+        if(on_hit) v += __builtin_popcountll(on_hit) / total * search(nshot, on_hit, b);
+
+        if(best < 0 || v < best_v){
+            best_v = v;
+            best = x;
+        }
+
+        // nothing beats a certain hit
+        if(p_miss == 0) break;
+    }
+
+    if(nodes <= ENDGAME_NODE_LIMIT) subsets[cand] = tt_entry{best_v, best};
+    return best_v;
+}
+
+}
@@ -0,0 +1,394 @@
+#include "external_player.h"
+#include "trace.h"
+#include <cerrno>
+#include <csignal>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace bship{
+
+
+/// Time the bot has to answer the handshake
+#define EXT_HANDSHAKE_MS 10000
+
+/// Time the bot has to exit after quit before being killed
+#define EXT_QUIT_MS 1000
+
+
+/*!
+    write() to a bot that fails with EPIPE instead of raising SIGPIPE when
+    the bot closed its input: the signal is blocked on the calling thread for
+    the write, and taken back if the write raised it, so that the signal
+    disposition of the process is left alone
+*/
+static ssize_t write_to_bot(int fd, const char *buf, size_t n){
+    sigset_t pipe_set, old, pending;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old);
+
+    // a SIGPIPE already pending is someone else's
+    sigpending(&pending);
+    bool was_pending = sigismember(&pending, SIGPIPE);
+
+    ssize_t res = write(fd, buf, n);
+    int err = errno;
+    if(res < 0 && err == EPIPE && !was_pending){
+        timespec zero = {0, 0};
+        while(sigtimedwait(&pipe_set, nullptr, &zero) < 0 && errno == EINTR){}
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old, nullptr);
+    errno = err;
+    return res;
+}
+
+
+external_player::external_player(const std::vector<std::string>& argv, std::string nm)
+:   bs_player(nm),
+    pid(-1),
+    to_bot(-1),
+    from_bot(-1),
+    next_id(1),
+    in_game(false),
+    moving(false),
+    fleet_known(false),
+    fleet_idx(0),
+    n_requests(0),
+    total_rtt(0),
+    max_rtt(0)
+{
+    if(argv.empty()) throw protocol_exception("Empty command line");
+
+    launch(argv);
+
+    // the destructor does not run if the constructor throws: the bot is stopped here
+    std::string line;
+    try{
+        send("bship 1");
+        flush();
+
+        while(true){
+            if(!read_line(line, EXT_HANDSHAKE_MS))
+                throw protocol_exception("No handshake from " + argv[0]);
+            if(line.compare(0, 4, "info") == 0) continue;
+            if(line.compare(0, 7, "bshipok") != 0)
+                throw protocol_exception("Unexpected handshake: " + line);
+            break;
+        }
+    }
+    catch(...){
+        stop(0);
+        throw;
+    }
+
+    if(name.empty()) name = (line.size() > 8) ? line.substr(8) : "external";
+}
+
+
+external_player::~external_player(){
+    try{
+        send("quit");
+        flush();
+    }
+    catch(bship_exception& e){}
+    stop(EXT_QUIT_MS);
+}
+
+
+size_t external_player::get_num_requests() const { return n_requests; }
+
+
+std::chrono::nanoseconds external_player::get_mean_latency() const {
+    return (n_requests == 0) ? std::chrono::nanoseconds(0) : total_rtt / (long) n_requests;
+}
+
+
+std::chrono::nanoseconds external_player::get_max_latency() const { return max_rtt; }
+
+
+void external_player::launch(const std::vector<std::string>& argv){
+    int in[2], out[2];
+
+    // close-on-exec, so that other bots do not inherit these pipes
+    if(pipe2(in, O_CLOEXEC) != 0) throw protocol_exception("Can't create pipe");
+    if(pipe2(out, O_CLOEXEC) != 0){
+        close(in[0]);
+        close(in[1]);
+        throw protocol_exception("Can't create pipe");
+    }
+
+    pid = fork();
+    if(pid < 0){
+        close(in[0]); close(in[1]);
+        close(out[0]); close(out[1]);
+        throw protocol_exception("Can't fork");
+    }
+
+    if(pid == 0){
+        // child: the pipes become stdin and stdout (dup2 clears close-on-exec)
+        dup2(in[0], 0);
+        dup2(out[1], 1);
+
+        std::vector<char*> args;
+        for(auto& a : argv) args.push_back(const_cast<char*>(a.c_str()));
+        args.push_back(nullptr);
+
+        execvp(args[0], args.data());
+        _exit(127);
+    }
+
+    close(in[0]);
+    close(out[1]);
+    to_bot   = in[1];
+    from_bot = out[0];
+}
+
+
+void external_player::stop(int grace_ms){
+    // the bot sees the end of its input
+    close(to_bot);
+
+    // give the bot a moment to exit on its own
+    int status;
+    bool exited = (waitpid(pid, &status, WNOHANG) == pid);
+    for(int i=0; i<grace_ms && !exited; ++i){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        exited = (waitpid(pid, &status, WNOHANG) == pid);
+    }
+    if(!exited){
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+    }
+
+    close(from_bot);
+}
+
+
+void external_player::send(const std::string& line){
+    out_buf += line;
+    out_buf += '\n';
+}
+
+
+void external_player::flush(){
+    BS_TRACE("write", "io");
+    size_t done = 0;
+    while(done < out_buf.size()){
+        ssize_t n = write_to_bot(to_bot, out_buf.data() + done, out_buf.size() - done);
+        if(n < 0){
+            if(errno == EINTR) continue;
+            out_buf.clear();
+            throw protocol_exception("Bot closed its input");
+        }
+        done += n;
+    }
+    out_buf.clear();
+}
+
+
+bool external_player::read_line(std::string& line, int timeout_ms){
+    BS_TRACE("read", "io");
+    std::chrono::steady_clock::time_point end =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while(true){
+        size_t nl = in_buf.find('\n');
+        if(nl != std::string::npos){
+            line = in_buf.substr(0, nl);
+            in_buf.erase(0, nl + 1);
+            if(!line.empty() && line.back() == '\r') line.pop_back();
+            return true;
+        }
+
+        if(timeout_ms >= 0){
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now());
+            pollfd pfd = {from_bot, POLLIN, 0};
+            int r = poll(&pfd, 1, std::max(0, (int) left.count()));
+            if(r < 0 && errno == EINTR) continue;
+            if(r == 0) return false;
+        }
+
+        char buf[4096];
+        ssize_t n = read(from_bot, buf, sizeof(buf));
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) throw protocol_exception("Bot closed its output");
+        in_buf.append(buf, n);
+    }
+}
+
+
+bool external_player::request(const std::string& cmd, std::string& reply){
+    BS_TRACE("request", "io");
+    const unsigned long id = next_id++;
+    const std::string expected = (cmd == "place") ? "placement" : "shot";
+
+    std::ostringstream os;
+    os << cmd << " " << id;
+    std::chrono::nanoseconds left = game->time_left();
+    bool timed = (left != std::chrono::nanoseconds::max());
+    if(timed) os << " " << std::chrono::duration_cast<std::chrono::milliseconds>(left).count();
+    send(os.str());
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    flush();
+
+    std::string line;
+    while(true){
+        int timeout = -1;
+        if(timed){
+            left = game->time_left();
+            timeout = std::chrono::duration_cast<std::chrono::milliseconds>(left).count();
+        }
+        if(!read_line(line, timeout)) return false;
+
+        std::istringstream is(line);
+        std::string keyword;
+        unsigned long rid = 0;
+        is >> keyword;
+        if(keyword == "info") continue;
+        if(keyword != expected || !(is >> rid) || rid > id)
+            throw protocol_exception("Unexpected message: " + line);
+
+        // late reply to an earlier request
+        if(rid < id) continue;
+
+        std::chrono::nanoseconds rtt = std::chrono::steady_clock::now() - t0;
+        ++n_requests;
+        total_rtt += rtt;
+        if(rtt > max_rtt) max_rtt = rtt;
+
+        std::getline(is, reply);
+        return true;
+    }
+}
+
+
+void external_player::new_game(){
+    std::ostringstream os;
+    os << "newgame " << hidden_grid->get_width() << " " << hidden_grid->get_height();
+    for(auto& tp : hidden_grid->get_max_n_ships())
+        if(tp.second > 0) os << " " << (int) tp.first << "x" << (int) tp.second;
+    send(os.str());
+
+    in_game     = true;
+    fleet_known = false;
+    fleet.clear();
+    fleet_idx   = 0;
+}
+
+
+void external_player::end_game(){
+    send((game->get_winner() == this) ? "gameover win" : "gameover loss");
+    flush();
+    in_game = false;
+}
+
+
+void external_player::on_update(){
+    if(in_game && !moving && game != nullptr && game->is_finished()) end_game();
+}
+
+
+void external_player::place_random(){
+    std::map<ship_type, uint8_t> n = hidden_grid->get_n_ships();
+    std::vector<ship_type> left;
+    for(auto& tp : hidden_grid->get_max_n_ships())
+        if(n[tp.first] < tp.second) left.push_back(tp.first);
+
+    while(true){
+        ship_type type = left[rand() % left.size()];
+        size_t r = rand() % hidden_grid->get_height();
+        size_t c = rand() % hidden_grid->get_width();
+        try{
+            if(game->place_ship(type, r, c, (rand() % 2) ? SO_HOR : SO_VERT)) return;
+        }
+        catch(time_exception& e){ throw; }
+        catch(bship_exception& e){}
+    }
+}
+
+
+void external_player::move(){
+
+    if(game == nullptr || hidden_grid == nullptr || hit_grid == nullptr){
+        std::cout << "Can't move on a nullptr {game, hidden_grid, hit_grid}" << std::endl;
+        throw illegal_move_exception("Move on nullptr");
+    }
+
+    if(!in_game) new_game();
+
+    std::string reply;
+
+    // placement: the whole fleet comes in one message, one ship is placed per move
+    if(!hidden_grid->is_ready()){
+        if(!fleet_known){
+            if(!request("place", reply)) return;
+            fleet_known = true;
+
+            std::istringstream is(reply);
+            int len;
+            size_t r, c;
+            std::string o;
+            std::map<ship_type, uint8_t> mx = hidden_grid->get_max_n_ships();
+            while(is >> len >> r >> c >> o){
+                if(mx.find((ship_type) len) == mx.end() || (o != "h" && o != "v")) continue;
+                fleet.push_back({(ship_type) len, r, c, (o == "h") ? SO_HOR : SO_VERT});
+            }
+        }
+
+        // skip the bot's illegal ships, the missing ones are placed randomly
+        while(fleet_idx < fleet.size()){
+            const placement& p = fleet[fleet_idx++];
+            try{
+                if(game->place_ship(p.type, p.row, p.col, p.orient)) return;
+            }
+            catch(time_exception& e){ throw; }
+            catch(bship_exception& e){}
+        }
+        place_random();
+        return;
+    }
+
+    // shooting
+    if(!request("shoot", reply)) return;
+
+    size_t r = 0, c = 0;
+    std::istringstream is(reply);
+    if(!(is >> r >> c) || r >= hit_grid->get_height() || c >= hit_grid->get_width() || !hit_grid->cell_at(r, c).can_shoot()){
+        // illegal shot, shoot a random cell instead
+        std::vector<std::pair<size_t, size_t>> cells;
+        for(size_t i=0; i<hit_grid->get_height(); ++i)
+            for(size_t j=0; j<hit_grid->get_width(); ++j)
+                if(hit_grid->cell_at(i, j).can_shoot()) cells.push_back(std::make_pair(i, j));
+        if(cells.empty()) return;
+        std::pair<size_t, size_t> cl = cells[rand() % cells.size()];
+        r = cl.first;
+        c = cl.second;
+    }
+
+    moving = true;
+    std::pair<shot_result, int> sr;
+    try{
+        sr = game->shoot_at(r, c);
+    }
+    catch(...){
+        moving = false;
+        throw;
+    }
+    moving = false;
+
+    std::ostringstream os;
+    os << "result " << r << " " << c << " " << ((sr.first == SR_MISS) ? "miss" : (sr.first == SR_HIT) ? "hit" : "sink");
+    send(os.str());
+
+    if(game->is_finished()) end_game();
+}
+
+
+}
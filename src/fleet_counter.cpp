@@ -0,0 +1,393 @@
+#include "fleet_counter.h"
+
+namespace bship{
+
+
+namespace{
+
+    /// observation of a cell
+    enum obs_cell : uint8_t {
+        OC_UNKNOWN,   ///< nothing is known about the cell
+        OC_EMPTY,     ///< the cell was missed, no ship can cover it
+        OC_COVERED    ///< the cell was hit, a ship has to cover it
+    };
+
+
+    /*!
+        @brief DP layer
+
+        Open addressing hash table from states to counts. Entries are kept
+        densely next to a hash index, so that clearing and iterating a layer
+        only touches the states it holds
+    */
+    template<class Count>
+    struct state_layer{
+
+        enum : uint32_t { NONE = 0xFFFFFFFF };   ///< empty slot of the index
+
+        std::vector<uint64_t>  keys;    ///< states
+        std::vector<Count>     vals;    ///< counts of states
+        std::vector<uint32_t>  index;   ///< hash index into keys/vals
+        uint64_t               mask;    ///< index size - 1
+
+
+        /// Clears the layer and sizes its index for about n entries
+        void clear(size_t n){
+            size_t cap = 64;
+            while(cap < 2*n) cap <<= 1;
+            keys.clear();
+            vals.clear();
+            index.assign(cap, NONE);
+            mask = cap - 1;
+        }
+
+
+        /// Slot of key in the index (either holding key or empty)
+        size_t slot(uint64_t key) const {
+            size_t h = (key * 0x9E3779B97F4A7C15ull) >> 20;
+            while(true){
+                h &= mask;
+                if(index[h] == NONE || keys[index[h]] == key) return h;
+                ++h;
+            }
+        }
+
+
+        /// Count of state key, inserted as 0 if not present
+        Count& at(uint64_t key){
+            size_t h = slot(key);
+            if(index[h] != NONE) return vals[index[h]];
+
+            if(2*(keys.size()+1) > index.size()){
+                // keep load factor under 1/2
+                std::vector<uint32_t>(index.size()*2, NONE).swap(index);
+                mask = index.size() - 1;
+                for(size_t i=0; i<keys.size(); ++i) index[slot(keys[i])] = i;
+                h = slot(key);
+            }
+
+            index[h] = keys.size();
+            keys.push_back(key);
+            vals.push_back(0);
+            return vals.back();
+        }
+
+
+        /// Count of state key, 0 if not present
+        Count get(uint64_t key) const {
+            size_t h = slot(key);
+            return (index[h] == NONE) ? 0 : vals[index[h]];
+        }
+
+
+        /// Drops the index, the layer can only be iterated afterwards
+        void freeze(){
+            std::vector<uint32_t>().swap(index);
+        }
+
+
+        size_t size() const { return keys.size(); }
+
+    };
+
+}
+
+
+
+std::string to_string(arr_count n){
+    if(n == 0) return "0";
+
+    std::string res;
+    while(n > 0){
+        res += (char) ('0' + (int) (n % 10));
+        n /= 10;
+    }
+    std::reverse(res.begin(), res.end());
+    return res;
+}
+
+
+
+fleet_counter::fleet_counter(size_t width_, size_t height_, const std::map<ship_type, uint8_t>& fleet)
+:   width(width_),
+    height(height_),
+    transposed(width_ > height_),
+    full_fleet(0),
+    total(0),
+    stop_flag(nullptr)
+{
+    if(width == 0 || height == 0){
+        throw index_exception(width, height, "Invalid size:");
+    }
+
+    // profile runs over the shorter dimension
+    dp_cols = (transposed) ? height : width;
+    dp_rows = (transposed) ? width : height;
+
+    // 3 bits of profile per column and 3 bits of horizontal run
+    if(dp_cols > 16){
+        throw index_exception(width, height, "Grid too large for fleet_counter:");
+    }
+
+    // fleet part of the state is a mixed radix number of remaining ships per type
+    uint64_t rdx = 1;
+    for(auto& tp : fleet){
+        if(tp.second == 0) continue;
+        if((int) tp.first > 8)
+            throw illegal_move_exception("Ship too long for fleet_counter");
+        lens.push_back(tp.first);
+        radix.push_back(rdx);
+        full_fleet += rdx * tp.second;
+        rdx *= tp.second + 1;
+    }
+    if(rdx > (1ull << (64 - 3*dp_cols - 3))){
+        throw illegal_move_exception("Fleet too large for fleet_counter");
+    }
+
+    // remaining counts of each type are needed to decode the fleet part
+    for(size_t t=0; t<lens.size(); ++t){
+        uint64_t next = (t+1 < radix.size()) ? radix[t+1] : rdx;
+        radix_span.push_back(next);
+    }
+
+    // product of the placement counts of all ships bounds every count in the DP,
+    // 64-bit counts are used when the bound allows it (twice less memory traffic)
+    long double bound = 1;
+    for(auto& tp : fleet){
+        long double placements = 0;
+        if((size_t) tp.first <= width)  placements += (width - tp.first + 1) * height;
+        if((size_t) tp.first <= height) placements += (height - tp.first + 1) * width;
+        for(int k=0; k<tp.second; ++k) bound *= placements;
+    }
+    wide = (bound >= 1.8e19L);
+}
+
+
+fleet_counter::fleet_counter(const bs_grid& grid)
+:   fleet_counter(grid.get_width(), grid.get_height(), grid.get_max_n_ships())
+{}
+
+
+arr_count fleet_counter::get_count() const { return total; }
+
+
+arr_count fleet_counter::cover_count(size_t row, size_t col) const {
+    if(row >= height || col >= width)
+        throw index_exception(row, col, "Index out of bounds: ");
+    if(covers.empty()) return 0;
+    return covers[cell_index(row, col)];
+}
+
+
+double fleet_counter::hit_prob(size_t row, size_t col) const {
+    if(total == 0) return 0.0;
+    return (double) ((long double) cover_count(row, col) / (long double) total);
+}
+
+
+void fleet_counter::set_stop_flag(const std::atomic<bool>* flag){
+    stop_flag = flag;
+}
+
+
+bool fleet_counter::stop_requested() const {
+    return stop_flag && stop_flag->load(std::memory_order_relaxed);
+}
+
+
+size_t fleet_counter::cell_index(size_t row, size_t col) const {
+    return (transposed) ? col*dp_cols + row : row*dp_cols + col;
+}
+
+
+void fleet_counter::read_obs(bs_grid& obs){
+    if(obs.get_width() != width || obs.get_height() != height)
+        throw index_exception(obs.get_width(), obs.get_height(), "Observation size mismatch:");
+
+    obs_cells.assign(width * height, OC_UNKNOWN);
+    for(size_t i=0; i<height; ++i){
+        for(size_t j=0; j<width; ++j){
+            cell_state st = obs.cell_at(i, j).state;
+            if(st == CS_MISSED) obs_cells[cell_index(i, j)] = OC_EMPTY;
+            else if(st == CS_DESTROYED) obs_cells[cell_index(i, j)] = OC_COVERED;
+        }
+    }
+}
+
+
+template<class Emit>
+inline void fleet_counter::expand(uint64_t s, size_t i, Emit emit) const {
+    const size_t   r     = i / dp_cols;
+    const size_t   c     = i % dp_cols;
+    const unsigned run   = 3*dp_cols;
+    const unsigned fl    = run + 3;
+    const uint8_t  o     = obs_cells[i];
+    const uint64_t v     = (s >> (3*c)) & 7;
+    const uint64_t h     = (s >> run) & 7;
+
+    // cell continues a vertical ship from above
+    if(v){
+        if(h || o == OC_EMPTY) return;
+        emit(s - (1ull << (3*c)), true);
+        return;
+    }
+
+    // cell continues a horizontal ship from the left
+    if(h){
+        if(o == OC_EMPTY) return;
+        emit(s - (1ull << run), true);
+        return;
+    }
+
+    // cell stays empty
+    if(o != OC_COVERED) emit(s, false);
+    if(o == OC_EMPTY) return;
+
+    // cell is the left- or upper-most cell of a new ship
+    const uint64_t f = s >> fl;
+    for(size_t t=0; t<lens.size(); ++t){
+        if((f % radix_span[t]) / radix[t] == 0) continue;
+
+        const size_t   len  = lens[t];
+        const uint64_t base = s - (radix[t] << fl);
+
+        if(c + len <= dp_cols){
+            // the rest of the row must be free of vertical ships and misses
+            bool ok = true;
+            for(size_t k=1; k<len && ok; ++k)
+                ok = ((s >> (3*(c+k))) & 7) == 0 && obs_cells[i+k] != OC_EMPTY;
+            if(ok) emit(base + ((uint64_t) (len-1) << run), true);
+        }
+
+        if(r + len <= dp_rows){
+            bool ok = true;
+            for(size_t k=1; k<len && ok; ++k)
+                ok = obs_cells[i + k*dp_cols] != OC_EMPTY;
+            if(ok) emit(base + ((uint64_t) (len-1) << (3*c)), true);
+        }
+    }
+}
+
+
+arr_count fleet_counter::count(bs_grid& obs){
+    read_obs(obs);
+    covers.clear();
+    solved_obs.clear();
+    total = (wide) ? run_count<arr_count>() : run_count<uint64_t>();
+    if(stop_requested()) total = 0;
+    return total;
+}
+
+
+arr_count fleet_counter::solve(bs_grid& obs){
+    read_obs(obs);
+
+    // same observation as the last solve (e.g. the empty grid of every new game)
+    if(!covers.empty() && obs_cells == solved_obs) return total;
+
+    covers.assign(dp_rows * dp_cols, 0);
+    total = (wide) ? run_solve<arr_count>() : run_solve<uint64_t>();
+    if(stop_requested()){
+        // partial results are useless
+        covers.clear();
+        return total = 0;
+    }
+    solved_obs = obs_cells;
+    return total;
+}
+
+
+template<class Count>
+arr_count fleet_counter::run_count(){
+    state_layer<Count> cur, next;
+    cur.clear(1);
+    cur.at(full_fleet << (3*dp_cols + 3)) = 1;
+
+    for(size_t i=0; i<dp_rows*dp_cols; ++i){
+        if(stop_requested()) return 0;
+        next.clear(cur.size());
+        for(size_t j=0; j<cur.size(); ++j){
+            const Count n = cur.vals[j];
+            expand(cur.keys[j], i, [&](uint64_t s, bool){ next.at(s) += n; });
+        }
+        std::swap(cur, next);
+    }
+
+    // every ship placed, nothing crossing the last row
+    return cur.get(0);
+}
+
+
+template<class Count>
+arr_count fleet_counter::run_solve(){
+
+    // forward pass, keeping the layers at row boundaries
+    std::vector<state_layer<Count>> row_layers(dp_rows);
+    state_layer<Count> cur, next;
+    cur.clear(1);
+    cur.at(full_fleet << (3*dp_cols + 3)) = 1;
+
+    for(size_t i=0; i<dp_rows*dp_cols; ++i){
+        if(stop_requested()) return 0;
+        if(i % dp_cols == 0){
+            row_layers[i / dp_cols] = cur;
+            row_layers[i / dp_cols].freeze();
+        }
+        next.clear(cur.size());
+        for(size_t j=0; j<cur.size(); ++j){
+            const Count n = cur.vals[j];
+            expand(cur.keys[j], i, [&](uint64_t s, bool){ next.at(s) += n; });
+        }
+        std::swap(cur, next);
+    }
+
+    const Count res = cur.get(0);
+    if(res == 0) return res;
+
+    // backward pass row by row: recompute the forward layers of the row from its
+    // boundary layer, then walk back through it with the counts of completions
+    std::vector<state_layer<Count>> row_fwd(dp_cols);
+    state_layer<Count> back_next, back_cur;
+    back_next.clear(1);
+    back_next.at(0) = 1;
+
+    for(size_t r=dp_rows; r-- > 0; ){
+        if(stop_requested()) return 0;
+        const size_t first = r*dp_cols;
+
+        std::swap(row_fwd[0], row_layers[r]);
+        for(size_t k=1; k<dp_cols; ++k){
+            const state_layer<Count>& prev = row_fwd[k-1];
+            state_layer<Count>& fwd = row_fwd[k];
+            fwd.clear(prev.size());
+            for(size_t j=0; j<prev.size(); ++j){
+                const Count n = prev.vals[j];
+                expand(prev.keys[j], first + k - 1, [&](uint64_t s, bool){ fwd.at(s) += n; });
+            }
+        }
+
+        for(size_t k=dp_cols; k-- > 0; ){
+            const state_layer<Count>& fwd = row_fwd[k];
+            Count cov_i = 0;
+
+            back_cur.clear(fwd.size());
+            for(size_t j=0; j<fwd.size(); ++j){
+                Count all = 0, cov = 0;
+                expand(fwd.keys[j], first + k, [&](uint64_t s, bool covered){
+                    const Count b = back_next.get(s);
+                    all += b;
+                    if(covered) cov += b;
+                });
+                if(all) back_cur.at(fwd.keys[j]) = all;
+                cov_i += fwd.vals[j] * cov;
+            }
+
+            covers[first + k] = cov_i;
+            std::swap(back_cur, back_next);
+        }
+    }
+
+    return res;
+}
+
+}
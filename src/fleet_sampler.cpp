@@ -0,0 +1,128 @@
+#include <algorithm>
+#include "fleet_sampler.h"
+
+namespace bship{
+
+
+/// consecutive layouts drawn without success before giving up (the fleet does not fit)
+#define SAMPLER_DRAW_LIMIT   (1 << 24)
+
+/// draws of one ship in SM_FAST mode before starting the layout again
+#define SAMPLER_SHIP_TRIES   64
+
+
+
+fleet_sampler::fleet_sampler(size_t width_, size_t height_, const std::map<ship_type, uint8_t>& fleet_,
+                             sampler_mode mode_, uint64_t seed_)
+:   width(width_),
+    height(height_),
+    fleet(fleet_),
+    mode(mode_),
+    state(seed_)
+{
+    if(width == 0 || height == 0 || width * height > bitboard::CAPACITY){
+        throw index_exception(width, height, "Invalid size for fleet_sampler:");
+    }
+
+    // largest ships first, they are the most likely to be rejected
+    for(auto& tp : fleet)
+        for(int i=0; i<tp.second; ++i) ships.push_back(tp.first);
+    std::sort(ships.begin(), ships.end(), [](ship_type a, ship_type b){ return a > b; });
+
+    // every placement of every ship length
+    size_t max_len = (ships.empty()) ? 0 : ships.front();
+    masks.resize(max_len + 1);
+    positions.resize(max_len + 1);
+    for(ship_type type : ships){
+        size_t len = type;
+        if(!masks[len].empty()) continue;
+
+        for(size_t r=0; r<height; ++r){
+            for(size_t c=0; c<width; ++c){
+                if(c + len <= width){
+                    bitboard b;
+                    for(size_t k=0; k<len; ++k) b.set(r*width + c + k);
+                    masks[len].push_back(b);
+                    positions[len].push_back(ship_placement{type, (uint8_t) r, (uint8_t) c, SO_HOR});
+                }
+                if(r + len <= height && len > 1){
+                    bitboard b;
+                    for(size_t k=0; k<len; ++k) b.set((r+k)*width + c);
+                    masks[len].push_back(b);
+                    positions[len].push_back(ship_placement{type, (uint8_t) r, (uint8_t) c, SO_VERT});
+                }
+            }
+        }
+
+        if(masks[len].empty()) throw illegal_move_exception("Ship too long for the grid");
+    }
+
+    layout.resize(ships.size());
+}
+
+
+fleet_sampler::fleet_sampler(const bs_grid& grid, sampler_mode mode_, uint64_t seed_)
+:   fleet_sampler(grid.get_width(), grid.get_height(), grid.get_max_n_ships(), mode_, seed_)
+{}
+
+
+bitboard fleet_sampler::sample(ship_placement *out){
+    for(long draw=0; draw<SAMPLER_DRAW_LIMIT; ++draw){
+        bitboard occ;
+        bool ok = true;
+
+        for(size_t i=0; i<ships.size() && ok; ++i){
+            const std::vector<bitboard>& m = masks[ships[i]];
+            size_t k = below(m.size());
+
+            if(mode == SM_FAST){
+                for(int t=1; t<SAMPLER_SHIP_TRIES && m[k].intersects(occ); ++t) k = below(m.size());
+            }
+
+            if(m[k].intersects(occ)){
+                ok = false;
+            }
+            else{
+                occ |= m[k];
+                out[i] = positions[ships[i]][k];
+            }
+        }
+
+        if(ok) return occ;
+    }
+
+    throw illegal_move_exception("The fleet does not fit on the grid");
+}
+
+
+const std::vector<ship_placement>& fleet_sampler::sample(){
+    sample(layout.data());
+    return layout;
+}
+
+
+void fleet_sampler::place(bs_grid& grid){
+    sample(layout.data());
+    for(const ship_placement& p : layout) grid.place_ship(p.type, p.row, p.col, p.orient);
+}
+
+
+size_t fleet_sampler::get_n_ships() const { return ships.size(); }
+
+
+sampler_mode fleet_sampler::get_mode() const { return mode; }
+
+
+size_t fleet_sampler::get_width() const { return width; }
+
+
+size_t fleet_sampler::get_height() const { return height; }
+
+
+const std::map<ship_type, uint8_t>& fleet_sampler::get_fleet() const { return fleet; }
+
+
+void fleet_sampler::seed(uint64_t s){ state = s; }
+
+
+}
@@ -0,0 +1,134 @@
+#include "game_broadcast.h"
+#include <sstream>
+
+namespace bship{
+
+
+game_broadcast::game_broadcast(battleship *gm, size_t max_queue_)
+:   game(gm),
+    max_queue(std::max(max_queue_, (size_t) 1)),
+    next_id(0),
+    resyncs(0),
+    seq(0),
+    snap_seq(0)
+{
+    game->add_listener(this);
+}
+
+
+game_broadcast::~game_broadcast(){
+    game->remove_listener(this);
+}
+
+
+size_t game_broadcast::subscribe(){
+    event_buffer s = snapshot();
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t id = next_id++;
+    subs[id].push_back(s);
+    return id;
+}
+
+
+void game_broadcast::unsubscribe(size_t id){
+    std::lock_guard<std::mutex> lock(mtx);
+    subs.erase(id);
+}
+
+
+size_t game_broadcast::poll(size_t id, std::vector<event_buffer>& out){
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = subs.find(id);
+    if(it == subs.end()) return 0;
+
+    size_t n = it->second.size();
+    out.insert(out.end(), it->second.begin(), it->second.end());
+    it->second.clear();
+    return n;
+}
+
+
+size_t game_broadcast::num_subscribers(){
+    std::lock_guard<std::mutex> lock(mtx);
+    return subs.size();
+}
+
+
+size_t game_broadcast::num_resyncs(){
+    std::lock_guard<std::mutex> lock(mtx);
+    return resyncs;
+}
+
+
+event_buffer game_broadcast::snapshot(){
+    // nothing happened since the last snapshot
+    if(snap && snap_seq == seq) return snap;
+
+    // by cell_state, the ships not hit yet are only shown once the game is over
+    static const char code[] = {'.', 'S', 'o', 'X'};
+    bool reveal = game->is_finished();
+
+    std::ostringstream os;
+    os << "snapshot " << game->pa_hidden_grid.get_width() << " " << game->pa_hidden_grid.get_height() << " ";
+    os << ((game->pa_turn) ? "A" : "B") << " " << game->get_total_shots() << "\n";
+
+    for(int p=0; p<2; ++p){
+        bs_grid& g = (p == 0) ? game->pa_hidden_grid : game->pb_hidden_grid;
+        os << "grid " << ((p == 0) ? "A" : "B") << " ";
+        for(size_t i=0; i<g.get_height(); ++i)
+            for(size_t j=0; j<g.get_width(); ++j)
+                os << ((g.cell_at(i, j).state == CS_FULL && !reveal) ? '.' : code[g.cell_at(i, j).state]);
+        os << "\n";
+    }
+
+    snap = std::make_shared<const std::string>(os.str());
+    snap_seq = seq;
+    return snap;
+}
+
+
+void game_broadcast::publish(const std::string& msg){
+    publish(std::make_shared<const std::string>(msg));
+}
+
+
+void game_broadcast::publish(const event_buffer& buf){
+    ++seq;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for(auto& sub : subs){
+        if(sub.second.size() < max_queue){
+            sub.second.push_back(buf);
+            continue;
+        }
+
+        // too far behind, the snapshot (taken after this event) replaces the queue
+        sub.second.clear();
+        sub.second.push_back(snapshot());
+        ++resyncs;
+    }
+}
+
+
+void game_broadcast::on_place(battleship&, bool, ship_type, size_t, size_t, ship_orientation){
+    // a placement would give a ship away to a spectator playing the game
+}
+
+
+void game_broadcast::on_shot(battleship&, bool by_pa, size_t row, size_t col, std::pair<shot_result, int> res){
+    std::ostringstream os;
+    os << "shot " << ((by_pa) ? "A " : "B ") << row << " " << col << " ";
+    os << ((res.first == SR_MISS) ? "miss" : (res.first == SR_HIT) ? "hit" : "sink") << "\n";
+    publish(os.str());
+}
+
+
+void game_broadcast::on_game_over(battleship&, bool pa_won){
+    publish((pa_won) ? "gameover A\n" : "gameover B\n");
+
+    // the fleets can be shown now
+    publish(snapshot());
+}
+
+
+}
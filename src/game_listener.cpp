@@ -0,0 +1,18 @@
+#include "game_listener.h"
+
+namespace bship{
+
+
+game_listener::~game_listener(){}
+
+
+void game_listener::on_place(battleship&, bool, ship_type, size_t, size_t, ship_orientation){}
+
+
+void game_listener::on_shot(battleship&, bool, size_t, size_t, std::pair<shot_result, int>){}
+
+
+void game_listener::on_game_over(battleship&, bool){}
+
+
+}
@@ -0,0 +1,630 @@
+#include "game_server.h"
+#include "slick_player.h"
+#include "trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace bship{
+
+
+/// Longest line accepted from a client
+#define SRV_MAX_LINE 4096
+
+/// Most output kept for a client not reading it
+#define SRV_MAX_OUTPUT (1 << 20)
+
+/// Events handled per epoll_wait()
+#define SRV_MAX_EVENTS 256
+
+/// Grid size of the games
+#define SRV_GRID_SIZE 10
+
+/// Events queued per spectator before it is resynced
+#define SRV_MAX_EVENTS_BEHIND 256
+
+/// Buffers written per system call to a spectator
+#define SRV_MAX_IOV 64
+
+/// Longest time a client that quit is kept to write its last output to (ms)
+#define SRV_LINGER_MS 5000
+
+
+game_server::session::session(int f)
+:   fd(f),
+    writing(false),
+    closing(false),
+    game(nullptr),
+    client(nullptr),
+    bot(nullptr),
+    cast(nullptr),
+    watching(-1),
+    sub_id(0),
+    feed_off(0)
+{}
+
+
+game_server::session::~session(){
+    end_game();
+    close(fd);
+}
+
+
+void game_server::session::end_game(){
+    delete cast;
+    delete game;
+    delete client;
+    delete bot;
+    cast   = nullptr;
+    game   = nullptr;
+    client = nullptr;
+    bot    = nullptr;
+}
+
+
+
+game_server::game_server(const std::string& socket_path)
+:   path(socket_path),
+    epfd(-1),
+    wakefd(-1),
+    n_games(0),
+    stopping(false)
+{
+    sockaddr_un addr;
+    if(path.size() >= sizeof(addr.sun_path))
+        throw protocol_exception("Socket path too long: " + path);
+
+    epfd   = epoll_create1(EPOLL_CLOEXEC);
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(epfd < 0 || wakefd < 0){
+        if(epfd >= 0) close(epfd);
+        if(wakefd >= 0) close(wakefd);
+        throw protocol_exception("Can't create event loop");
+    }
+
+    epoll_event ev;
+    ev.events  = EPOLLIN;
+    ev.data.fd = wakefd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+
+    try{
+        add_listener(AF_UNIX, &addr, sizeof(addr));
+    }
+    catch(protocol_exception& e){
+        close(epfd);
+        close(wakefd);
+        throw;
+    }
+}
+
+
+game_server::~game_server(){
+    for(auto& s : sessions) delete s.second;
+    for(int l : listeners) close(l);
+    close(epfd);
+    close(wakefd);
+    unlink(path.c_str());
+}
+
+
+size_t game_server::num_sessions() const { return sessions.size(); }
+
+
+size_t game_server::num_games_played() const { return n_games; }
+
+
+int game_server::add_listener(int domain, const void *addr, size_t addr_len){
+    int fd = socket(domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0) throw protocol_exception("Can't create socket");
+
+    if(domain == AF_INET){
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+
+    if(bind(fd, (const sockaddr*) addr, addr_len) != 0 || listen(fd, SOMAXCONN) != 0){
+        close(fd);
+        throw protocol_exception(std::string("Can't listen: ") + std::strerror(errno));
+    }
+
+    epoll_event ev;
+    ev.events  = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    listeners.push_back(fd);
+
+    return fd;
+}
+
+
+uint16_t game_server::listen_tcp(uint16_t port){
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd = add_listener(AF_INET, &addr, sizeof(addr));
+
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (sockaddr*) &addr, &len);
+    return ntohs(addr.sin_port);
+}
+
+
+void game_server::stop(){
+    stopping = true;
+    uint64_t one = 1;
+    ssize_t n = write(wakefd, &one, sizeof(one));
+    (void) n;
+}
+
+
+void game_server::run(){
+    epoll_event events[SRV_MAX_EVENTS];
+
+    while(!stopping){
+        int n = epoll_wait(epfd, events, SRV_MAX_EVENTS, expire_lingering());
+        if(n < 0){
+            if(errno == EINTR) continue;
+            throw protocol_exception(std::string("epoll_wait failed: ") + std::strerror(errno));
+        }
+
+        for(int i=0; i<n; ++i){
+            int fd = events[i].data.fd;
+
+            if(fd == wakefd){
+                uint64_t v;
+                ssize_t r = read(wakefd, &v, sizeof(v));
+                (void) r;
+                continue;
+            }
+
+            if(std::find(listeners.begin(), listeners.end(), fd) != listeners.end()){
+                accept_all(fd);
+                continue;
+            }
+
+            // closed earlier in this batch
+            auto it = sessions.find(fd);
+            if(it == sessions.end()) continue;
+
+            // a closing client is only written to, until it hangs up
+            bool keep = true;
+            if(it->second->closing) keep = !(events[i].events & (EPOLLHUP | EPOLLERR));
+            else if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) keep = on_readable(*it->second);
+            if(keep && (events[i].events & EPOLLOUT)) keep = on_writable(*it->second);
+            if(!keep) close_session(fd);
+        }
+    }
+
+    stopping = false;
+}
+
+
+void game_server::accept_all(int lfd){
+    while(true){
+        int fd = accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) return;   // EAGAIN (or a connection aborted meanwhile)
+
+        epoll_event ev;
+        ev.events  = EPOLLIN;
+        ev.data.fd = fd;
+        if(epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0){
+            close(fd);
+            continue;
+        }
+        sessions[fd] = new session(fd);
+    }
+}
+
+
+void game_server::close_session(int fd){
+    auto it = sessions.find(fd);
+    if(it == sessions.end()) return;
+
+    session *s = it->second;
+    unwatch(*s);
+    drop_game(*s);
+
+    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+    delete s;
+    sessions.erase(it);
+}
+
+
+bool game_server::on_readable(session& s){
+    BS_TRACE("input", "io");
+    char buf[4096];
+    bool open = true;
+
+    while(true){
+        ssize_t n = recv(s.fd, buf, sizeof(buf), 0);
+        if(n > 0){
+            s.in.append(buf, n);
+            continue;
+        }
+        if(n < 0 && errno == EINTR) continue;
+        if(n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) open = false;
+        break;
+    }
+
+    // handle every complete line, replies are written once at the end
+    size_t start = 0, nl;
+    while((nl = s.in.find('\n', start)) != std::string::npos){
+        std::string line = s.in.substr(start, nl - start);
+        start = nl + 1;
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        if(!handle_line(s, line)){
+            open = false;
+            break;
+        }
+    }
+    s.in.erase(0, start);
+
+    if(s.in.size() > SRV_MAX_LINE) return false;
+
+    // on quit/EOF the output is written before closing
+    if(!open) return start_closing(s);
+    return on_writable(s);
+}
+
+
+bool game_server::on_writable(session& s){
+    int res = flush_session(s);
+    if(res < 0 || s.out.size() > SRV_MAX_OUTPUT) return false;
+    if(s.closing) return res == 0;
+
+    // only ask for EPOLLOUT while the socket is full
+    bool want = (res == 0);
+    if(want != s.writing){
+        epoll_event ev;
+        ev.events  = EPOLLIN | (want ? (uint32_t) EPOLLOUT : 0u);
+        ev.data.fd = s.fd;
+        epoll_ctl(epfd, EPOLL_CTL_MOD, s.fd, &ev);
+        s.writing = want;
+    }
+
+    return true;
+}
+
+
+bool game_server::start_closing(session& s){
+    // the game ends now (its spectators get its last events), the client's
+    // output and watched events already queued are still written
+    unwatch(s);
+    drop_game(s);
+    s.in.clear();
+    s.closing = true;
+    s.linger = std::chrono::steady_clock::now() + std::chrono::milliseconds(SRV_LINGER_MS);
+
+    if(flush_session(s) != 0) return false;
+
+    epoll_event ev;
+    ev.events  = EPOLLOUT;
+    ev.data.fd = s.fd;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, s.fd, &ev);
+    s.writing = true;
+    lingering.emplace_back(s.linger, s.fd);
+    return true;
+}
+
+
+int game_server::expire_lingering(){
+    auto now = std::chrono::steady_clock::now();
+    while(!lingering.empty() && lingering.front().first <= now){
+        // the socket may have been closed already, and reused by a new client
+        auto it = sessions.find(lingering.front().second);
+        if(it != sessions.end() && it->second->closing && it->second->linger == lingering.front().first)
+            close_session(it->first);
+        lingering.pop_front();
+    }
+    if(lingering.empty()) return -1;
+
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(lingering.front().first - now);
+    return (int) left.count() + 1;
+}
+
+
+int game_server::flush_session(session& s){
+    BS_TRACE("write", "io");
+
+    // replies first
+    size_t done = 0;
+    while(done < s.out.size()){
+        ssize_t n = send(s.fd, s.out.data() + done, s.out.size() - done, MSG_NOSIGNAL);
+        if(n > 0){
+            done += n;
+            continue;
+        }
+        if(n < 0 && errno == EINTR) continue;
+        s.out.erase(0, done);
+        return (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) ? 0 : -1;
+    }
+    s.out.clear();
+
+    // then the watched game's events, written from the shared buffers. New
+    // events are only taken from the broadcast once the previous ones are
+    // written, so a spectator that does not keep up is resynced there
+    while(true){
+        if(s.feed.empty()){
+            auto it = (s.watching < 0) ? sessions.end() : sessions.find(s.watching);
+            if(it == sessions.end() || it->second->cast == nullptr) return 1;
+
+            std::vector<event_buffer> evs;
+            if(it->second->cast->poll(s.sub_id, evs) == 0) return 1;
+            s.feed.insert(s.feed.end(), evs.begin(), evs.end());
+            s.feed_off = 0;
+        }
+
+        iovec iov[SRV_MAX_IOV];
+        size_t k = 0;
+        for(auto b = s.feed.begin(); b != s.feed.end() && k < SRV_MAX_IOV; ++b, ++k){
+            size_t off = (k == 0) ? s.feed_off : 0;
+            iov[k].iov_base = const_cast<char*>((*b)->data() + off);
+            iov[k].iov_len  = (*b)->size() - off;
+        }
+
+        msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = k;
+
+        ssize_t n = sendmsg(s.fd, &msg, MSG_NOSIGNAL);
+        if(n < 0){
+            if(errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+
+        size_t left = n;
+        while(left > 0){
+            size_t rem = s.feed.front()->size() - s.feed_off;
+            if(left < rem){
+                s.feed_off += left;
+                break;
+            }
+            left -= rem;
+            s.feed.pop_front();
+            s.feed_off = 0;
+        }
+    }
+}
+
+
+void game_server::pump(session& s){
+    std::vector<int> dead;
+    for(int fd : s.watchers){
+        session *w = sessions[fd];
+        if(!w->writing && !on_writable(*w)) dead.push_back(fd);
+    }
+    for(int fd : dead) close_session(fd);
+}
+
+
+void game_server::unwatch(session& s){
+    if(s.watching < 0) return;
+
+    auto it = sessions.find(s.watching);
+    if(it != sessions.end()){
+        session& g = *it->second;
+        if(g.cast) g.cast->unsubscribe(s.sub_id);
+        g.watchers.erase(std::remove(g.watchers.begin(), g.watchers.end(), s.fd), g.watchers.end());
+    }
+    s.watching = -1;
+}
+
+
+void game_server::drop_game(session& s){
+    // spectators get the last events (written when their sockets allow) and stop watching
+    pump(s);
+    std::vector<int> w;
+    w.swap(s.watchers);
+    for(int fd : w){
+        auto it = sessions.find(fd);
+        if(it == sessions.end()) continue;
+        session& sp = *it->second;
+        std::vector<event_buffer> evs;
+        s.cast->poll(sp.sub_id, evs);
+        sp.feed.insert(sp.feed.end(), evs.begin(), evs.end());
+        sp.watching = -1;
+    }
+    s.end_game();
+}
+
+
+bool game_server::handle_line(session& s, const std::string& line){
+    std::istringstream is(line);
+    std::string cmd;
+    is >> cmd;
+
+    if(cmd.empty()) return true;
+    if(cmd == "quit") return false;
+
+    if(cmd == "new"){
+        std::string bot = "random";
+        float diff = 0.2;
+        is >> bot >> diff;
+        if(bot != "random" && bot != "slick"){
+            s.out += "err unknown bot " + bot + "\n";
+            return true;
+        }
+        new_game(s, bot, diff);
+        return true;
+    }
+
+    if(cmd == "list"){
+        s.out += "games";
+        for(auto& other : sessions)
+            if(other.second->game) s.out += " " + std::to_string(other.first);
+        s.out += "\n";
+        return true;
+    }
+
+    if(cmd == "watch"){
+        int id = -1;
+        is >> id;
+        auto it = sessions.find(id);
+        if(it == sessions.end() || it->second->game == nullptr || it->second == &s){
+            s.out += "err no such game\n";
+            return true;
+        }
+        unwatch(s);
+        s.out += "ok\n";
+        s.feed.clear();
+        s.feed_off = 0;
+        s.watching = id;
+        s.sub_id   = it->second->cast->subscribe();
+        it->second->watchers.push_back(s.fd);
+        return true;
+    }
+
+    if(cmd == "unwatch"){
+        unwatch(s);
+        s.out += "ok\n";
+        return true;
+    }
+
+    if(cmd != "place" && cmd != "shoot"){
+        s.out += "err unknown command " + cmd + "\n";
+        return true;
+    }
+
+    if(s.game == nullptr){
+        s.out += "err no game in progress\n";
+        return true;
+    }
+
+    battleship& g = *s.game;
+
+    try{
+        if(cmd == "place"){
+            int len;
+            size_t r, c;
+            std::string o;
+            if(!(is >> len >> r >> c >> o) || (o != "h" && o != "v")){
+                s.out += "err usage: place <len> <row> <col> <h|v>\n";
+                return true;
+            }
+            if(g.pa_hidden_grid.is_ready()){
+                s.out += "err all ships placed\n";
+                return true;
+            }
+            if(!g.place_ship((ship_type) len, r, c, (o == "h") ? SO_HOR : SO_VERT)){
+                s.out += "err can't place the ship there\n";
+                return true;
+            }
+            s.out += "ok\n";
+        }
+        else{
+            size_t r, c;
+            if(!(is >> r >> c)){
+                s.out += "err usage: shoot <row> <col>\n";
+                return true;
+            }
+            if(!g.pa_hidden_grid.is_ready() || !g.pb_hidden_grid.is_ready()){
+                s.out += "err ships not placed yet\n";
+                return true;
+            }
+            std::pair<shot_result, int> res = g.shoot_at(r, c);
+            std::ostringstream os;
+            os << "result " << r << " " << c << " " << ((res.first == SR_MISS) ? "miss" : (res.first == SR_HIT) ? "hit" : "sink") << "\n";
+            s.out += os.str();
+        }
+    }
+    catch(illegal_move_exception& e){
+        s.out += std::string("err ") + e.what() + "\n";
+        return true;
+    }
+    catch(index_exception& e){
+        s.out += std::string("err ") + e.what() + "\n";
+        return true;
+    }
+
+    check_finished(s);
+    if(s.game) run_bot(s);
+    if(s.game){
+        pump(s);
+        check_finished(s);
+    }
+    return true;
+}
+
+
+void game_server::new_game(session& s, const std::string& bot, float diff){
+    drop_game(s);
+
+    s.game   = new battleship(SRV_GRID_SIZE, SRV_GRID_SIZE, OM_SILENT);
+    s.client = new bs_player("client");
+    s.bot    = (bot == "slick") ? new slick_player("slick", diff) : new bs_player("random");
+    connect(s.game, s.client, s.bot);
+    s.cast   = new game_broadcast(s.game, SRV_MAX_EVENTS_BEHIND);
+
+    std::ostringstream os;
+    os << "newgame " << SRV_GRID_SIZE << " " << SRV_GRID_SIZE;
+    for(auto& tp : s.game->pa_hidden_grid.get_max_n_ships())
+        if(tp.second > 0) os << " " << (int) tp.first << "x" << (int) tp.second;
+    os << "\n";
+    s.out += os.str();
+}
+
+
+void game_server::run_bot(session& s){
+    battleship& g = *s.game;
+    bs_grid& hit = g.pb_hit_grid;
+    std::vector<cell_state> before(hit.get_width() * hit.get_height());
+
+    while(!g.is_finished() && g.get_current_player() == s.bot){
+        bool shooting = g.pb_hidden_grid.is_ready();
+
+        if(!shooting){
+            s.bot->move();
+            continue;
+        }
+
+        // the bot's shot is found by comparing its hit grid before and after
+        for(size_t i=0; i<hit.get_height(); ++i)
+            for(size_t j=0; j<hit.get_width(); ++j)
+                before[i*hit.get_width() + j] = hit.cell_at(i, j).state;
+        int alive = g.pa_hidden_grid.get_num_alive_ships();
+
+        s.bot->move();
+
+        for(size_t i=0; i<hit.get_height(); ++i){
+            for(size_t j=0; j<hit.get_width(); ++j){
+                cell_state st = hit.cell_at(i, j).state;
+                if(st == before[i*hit.get_width() + j]) continue;
+                std::ostringstream os;
+                os << "opp " << i << " " << j << " ";
+                if(st == CS_MISSED) os << "miss";
+                else os << ((g.pa_hidden_grid.get_num_alive_ships() < alive) ? "sink" : "hit");
+                os << "\n";
+                s.out += os.str();
+            }
+        }
+    }
+}
+
+
+void game_server::check_finished(session& s){
+    if(!s.game->is_finished()) return;
+    s.out += (s.game->get_winner() == s.client) ? "gameover win\n" : "gameover loss\n";
+    ++n_games;
+    drop_game(s);
+}
+
+
+}
@@ -0,0 +1,64 @@
+#include <cstdlib>
+#include "hiding_player.h"
+
+
+namespace bship{
+
+hiding_player::hiding_player(std::string nm, density_model model, std::chrono::microseconds budget_,
+                             const std::string& prior_dir)
+:   model_player(nm, prior_dir),
+    dmodel(model),
+    budget(budget_),
+    last_score(0)
+{}
+
+
+void hiding_player::move(){
+    if(game == nullptr || hidden_grid == nullptr || hit_grid == nullptr || hidden_grid->is_ready()){
+        model_player::move();
+        return;
+    }
+
+    // the whole layout is searched at the first placement of a game, on the empty grid
+    const std::map<ship_type, uint8_t>& n = hidden_grid->get_n_ships();
+    size_t on_grid = 0;
+    for(auto& tp : n) on_grid += tp.second;
+    init_optimizer();
+    if(on_grid == 0) last_score = optimizer->optimize(budget, layout.data());
+
+    // the next ship is read from the grid (see next_ship()): the k-th ship of
+    // its type in the layout, k ships of the type being on the grid already
+    ship_type type = next_ship();
+    size_t k = n.at(type);
+    for(const ship_placement& p : layout){
+        if(p.type != type || k-- > 0) continue;
+
+        // a ship the game placed for the player may be in the way
+        if(!hidden_grid->can_place_ship(p.type, p.row, p.col, p.orient)) break;
+        if(!game->place_ship(p.type, p.row, p.col, p.orient))
+            throw illegal_move_exception("Layout does not fit the grid");
+        return;
+    }
+    model_player::move();
+}
+
+
+void hiding_player::set_density(const std::vector<double>& density){
+    learned = density;
+    if(optimizer) optimizer->set_density(learned);
+}
+
+
+double hiding_player::get_last_score() const { return last_score; }
+
+
+void hiding_player::init_optimizer(){
+    if(optimizer) return;
+
+    optimizer.reset(new layout_optimizer(*hidden_grid, dmodel, ((uint64_t) rand() << 32) ^ rand()));
+    if(!learned.empty()) optimizer->set_density(learned);
+    layout.resize(optimizer->get_n_ships());
+}
+
+
+}
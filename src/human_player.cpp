@@ -43,7 +43,7 @@ void human_player::move(){
             std::cout << "ex: 2 5 0 v = 2-cell ship placed vertically at (5, 0)\n";
             std::cout << "ships left to place:\n";
             for(auto& s : hidden_grid->get_n_ships()){
-                std::cout << (int) s.first << "-cell : " << (int) hidden_grid->get_max_n_ships()[s.first] - s.second << std::endl;
+                std::cout << (int) s.first << "-cell : " << (int) hidden_grid->get_max_n_ships().at(s.first) - s.second << std::endl;
             }
 
             std::cout << ">> ";
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "layout_corpus.h"
+
+namespace bship{
+
+
+static_assert(sizeof(corpus_header) == 48, "corpus header layout changed");
+
+
+
+corpus_writer::corpus_writer()
+:   file(nullptr),
+    failed(false)
+{
+    std::memset(&header, 0, sizeof(header));
+}
+
+
+corpus_writer::~corpus_writer(){ close(); }
+
+
+bool corpus_writer::open(const std::string& path, size_t width, size_t height, const std::map<ship_type, uint8_t>& fleet){
+    close();
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "BSLC", 4);
+    header.version = 1;
+    header.width   = width;
+    header.height  = height;
+
+    // types largest first, the order of fleet_sampler
+    for(auto tp = fleet.rbegin(); tp != fleet.rend(); ++tp){
+        for(int i=0; i<tp->second; ++i){
+            if(header.n_ships == sizeof(header.types)) return false;
+            header.types[header.n_ships++] = tp->first;
+        }
+    }
+    if(width == 0 || height == 0 || width * height > 128) return false;
+
+    file = std::fopen(path.c_str(), "wb");
+    if(file == nullptr) return false;
+
+    // the header is written again with the count by close()
+    failed = std::fwrite(&header, sizeof(header), 1, file) != 1;
+    record.resize(header.n_ships);
+    return !failed;
+}
+
+
+void corpus_writer::add(const ship_placement *ships){
+    if(file == nullptr) return;
+    for(size_t i=0; i<header.n_ships; ++i)
+        record[i] = (ships[i].row * header.width + ships[i].col) | ((ships[i].orient == SO_VERT) ? 0x80 : 0);
+    if(std::fwrite(record.data(), 1, record.size(), file) != record.size()) failed = true;
+    ++header.count;
+}
+
+
+bool corpus_writer::close(){
+    if(file == nullptr) return !failed;
+
+    if(std::fseek(file, 0, SEEK_SET) != 0 || std::fwrite(&header, sizeof(header), 1, file) != 1) failed = true;
+    if(std::fclose(file) != 0) failed = true;
+    file = nullptr;
+    return !failed;
+}
+
+
+uint64_t corpus_writer::size() const { return header.count; }
+
+
+bool corpus_writer::generate(const std::string& path, uint64_t count, fleet_sampler& sampler){
+    corpus_writer w;
+    if(!w.open(path, sampler.get_width(), sampler.get_height(), sampler.get_fleet())) return false;
+
+    std::vector<ship_placement> ships(sampler.get_n_ships());
+    for(uint64_t i=0; i<count; ++i){
+        sampler.sample(ships.data());
+        w.add(ships.data());
+    }
+    return w.close();
+}
+
+
+
+layout_corpus::layout_corpus()
+:   data(nullptr),
+    length(0),
+    header(nullptr),
+    records(nullptr)
+{}
+
+
+layout_corpus::~layout_corpus(){ close(); }
+
+
+bool layout_corpus::open(const std::string& path){
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(corpus_header)){
+        ::close(fd);
+        return false;
+    }
+
+    // the mapping keeps the file alive, the descriptor is not needed anymore
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED) return false;
+
+    data    = (const uint8_t*) p;
+    length  = st.st_size;
+    header  = (const corpus_header*) data;
+    records = data + sizeof(corpus_header);
+
+    bool valid = std::memcmp(header->magic, "BSLC", 4) == 0 && header->version == 1
+              && header->width > 0 && header->height > 0
+              && (uint64_t) header->width * header->height <= 128
+              && header->n_ships <= sizeof(header->types)
+              && header->count <= (length - sizeof(corpus_header)) / std::max(header->n_ships, 1u);
+    if(!valid){
+        close();
+        return false;
+    }
+    return true;
+}
+
+
+void layout_corpus::close(){
+    if(data != nullptr) munmap((void*) data, length);
+    data    = nullptr;
+    length  = 0;
+    header  = nullptr;
+    records = nullptr;
+}
+
+
+uint64_t layout_corpus::size() const { return (header) ? header->count : 0; }
+
+
+size_t layout_corpus::get_width() const { return (header) ? header->width : 0; }
+
+
+size_t layout_corpus::get_height() const { return (header) ? header->height : 0; }
+
+
+size_t layout_corpus::get_n_ships() const { return (header) ? header->n_ships : 0; }
+
+
+void layout_corpus::get(uint64_t i, ship_placement *out) const {
+    const uint8_t *rec = records + i * header->n_ships;
+    for(size_t k=0; k<header->n_ships; ++k){
+        uint8_t cell = rec[k] & 0x7F;
+        out[k].type   = (ship_type) header->types[k];
+        out[k].row    = cell / header->width;
+        out[k].col    = cell % header->width;
+        out[k].orient = (rec[k] & 0x80) ? SO_VERT : SO_HOR;
+    }
+}
+
+
+bool layout_corpus::matches(const bs_grid& grid) const {
+    if(header == nullptr || grid.get_width() != header->width || grid.get_height() != header->height) return false;
+
+    // every ship type of the grid, as many times in the corpus' types
+    size_t total = 0;
+    for(auto& tp : grid.get_max_n_ships()){
+        size_t n = std::count(header->types, header->types + header->n_ships, (uint8_t) tp.first);
+        if(n != tp.second) return false;
+        total += n;
+    }
+    return total == header->n_ships;
+}
+
+
+bool layout_corpus::apply(uint64_t i, bs_grid& grid) const {
+    if(i >= size()){
+        throw index_exception(i, size(), "Layout out of the corpus:");
+    }
+
+    ship_placement ships[sizeof(header->types)];
+    get(i, ships);
+    for(size_t k=0; k<header->n_ships; ++k)
+        if(!grid.place_ship(ships[k].type, ships[k].row, ships[k].col, ships[k].orient)) return false;
+    return true;
+}
+
+
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cmath>
+#include "layout_optimizer.h"
+
+namespace bship{
+
+
+/// moves between two looks at the clock
+#define OPTIMIZER_CLOCK_MOVES   64
+
+/// annealing temperature at the start and at the deadline (the density averages 1)
+#define OPTIMIZER_T_START       1.0
+#define OPTIMIZER_T_END         0.01
+
+
+
+layout_optimizer::layout_optimizer(size_t width_, size_t height_, const std::map<ship_type, uint8_t>& fleet,
+                                   density_model model_, uint64_t seed)
+:   width(width_),
+    height(height_),
+    model(model_),
+    touch(0.5),
+    state(seed),
+    moves(0),
+    sampler(width_, height_, fleet, SM_UNIFORM, seed ^ 0x5851F42D4C957F2Dull)
+{
+    // largest ships first, the order of fleet_sampler
+    for(auto& tp : fleet)
+        for(int i=0; i<tp.second; ++i) ships.push_back(tp.first);
+    std::sort(ships.begin(), ships.end(), [](ship_type a, ship_type b){ return a > b; });
+
+    // every placement of every ship length
+    slots.resize(ST_FIVE + 1);
+    for(ship_type type : ships){
+        size_t len = type;
+        if(!slots[len].empty()) continue;
+
+        for(size_t r=0; r<height; ++r){
+            for(size_t c=0; c<width; ++c){
+                for(int o=0; o<2; ++o){
+                    size_t dr = (o) ? 1 : 0, dc = 1 - dr;
+                    if(r + dr*(len-1) >= height || c + dc*(len-1) >= width) continue;
+
+                    slot s;
+                    s.place = ship_placement{type, (uint8_t) r, (uint8_t) c, (o) ? SO_VERT : SO_HOR};
+                    for(size_t k=0; k<len; ++k) s.cells[k] = (r + dr*k) * width + c + dc*k;
+                    s.dens = 0;
+                    slots[len].push_back(s);
+                }
+            }
+        }
+    }
+
+    owner.assign(width * height, -1);
+    current.resize(ships.size());
+    best.resize(ships.size());
+    init_density();
+}
+
+
+layout_optimizer::layout_optimizer(const bs_grid& grid, density_model model_, uint64_t seed)
+:   layout_optimizer(grid.get_width(), grid.get_height(), grid.get_max_n_ships(), model_, seed)
+{}
+
+
+void layout_optimizer::set_density(const std::vector<double>& d){
+    if(d.size() != width * height){
+        throw index_exception(d.size(), width * height, "Density of the wrong size:");
+    }
+
+    model = DM_LEARNED;
+    double sum = 0;
+    for(double x : d) sum += std::max(x, 0.0);
+    for(size_t c=0; c<density.size(); ++c)
+        density[c] = (sum > 0) ? std::max(d[c], 0.0) * density.size() / sum : 1.0;
+    update_slots();
+}
+
+
+void layout_optimizer::set_touch_penalty(double penalty){ touch = penalty; }
+
+
+double layout_optimizer::optimize(std::chrono::microseconds budget, ship_placement *out){
+    typedef std::chrono::steady_clock clock;
+    clock::time_point start = clock::now(), deadline = start + budget;
+    size_t n = ships.size();
+    moves = 0;
+
+    // start from a random layout
+    std::fill(owner.begin(), owner.end(), -1);
+    std::vector<ship_placement>::const_iterator it = sampler.sample().begin();
+    for(size_t k=0; k<n; ++k, ++it){
+        const std::vector<slot>& sl = slots[ships[k]];
+        for(size_t j=0; j<sl.size(); ++j){
+            if(sl[j].place.row == it->row && sl[j].place.col == it->col && sl[j].place.orient == it->orient){
+                current[k] = j;
+                break;
+            }
+        }
+        mark(sl[current[k]], ships[k], k);
+    }
+
+    double cur = 0;
+    for(size_t k=0; k<n; ++k){
+        const slot& s = slots[ships[k]][current[k]];
+        cur += s.dens + touch * contacts(s, ships[k], k);
+    }
+    double best_score = cur;
+    best = current;
+
+    double temp = OPTIMIZER_T_START;
+    for(;;){
+        if(moves % OPTIMIZER_CLOCK_MOVES == 0){
+            clock::time_point now = clock::now();
+            if(now >= deadline) break;
+            double frac = std::chrono::duration<double>(now - start).count()
+                        / std::max(std::chrono::duration<double>(budget).count(), 1e-9);
+            temp = OPTIMIZER_T_START * std::pow(OPTIMIZER_T_END / OPTIMIZER_T_START, frac);
+        }
+        ++moves;
+
+        // a random ship to a random free placement
+        int k = next() % n;
+        size_t len = ships[k];
+        const std::vector<slot>& sl = slots[len];
+        size_t j = next() % sl.size();
+        if(j == current[k] || !free_for(sl[j], len, k)) continue;
+
+        const slot& from = sl[current[k]];
+        const slot& to = sl[j];
+        double delta = to.dens - from.dens + 2 * touch * (contacts(to, len, k) - contacts(from, len, k));
+
+        if(delta <= 0 || uniform() < std::exp(-delta / temp)){
+            mark(from, len, -1);
+            mark(to, len, k);
+            current[k] = j;
+            cur += delta;
+            if(cur < best_score - 1e-9){
+                best_score = cur;
+                best = current;
+            }
+        }
+    }
+
+    for(size_t k=0; k<n; ++k) out[k] = slots[ships[k]][best[k]].place;
+    return best_score;
+}
+
+
+double layout_optimizer::score(const ship_placement *fleet) const {
+    std::vector<int> own(width * height, -1);
+    std::vector<const slot*> placed(ships.size());
+
+    for(size_t k=0; k<ships.size(); ++k){
+        for(const slot& s : slots[fleet[k].type]){
+            if(s.place.row == fleet[k].row && s.place.col == fleet[k].col && s.place.orient == fleet[k].orient){
+                placed[k] = &s;
+                for(size_t i=0; i<fleet[k].type; ++i) own[s.cells[i]] = k;
+            }
+        }
+        if(placed[k] == nullptr) throw illegal_move_exception("Ship out of the grid");
+    }
+
+    double sc = 0;
+    for(size_t k=0; k<ships.size(); ++k){
+        size_t len = fleet[k].type;
+        sc += placed[k]->dens;
+        for(size_t i=0; i<len; ++i){
+            long r = placed[k]->cells[i] / width, c = placed[k]->cells[i] % width;
+            const long nb[4][2] = {{r-1, c}, {r+1, c}, {r, c-1}, {r, c+1}};
+            for(auto& p : nb){
+                if(p[0] < 0 || p[1] < 0 || p[0] >= (long) height || p[1] >= (long) width) continue;
+                int o = own[p[0] * width + p[1]];
+                if(o >= 0 && o != (int) k) sc += touch;
+            }
+        }
+    }
+    return sc;
+}
+
+
+const std::vector<double>& layout_optimizer::get_density() const { return density; }
+
+
+density_model layout_optimizer::get_model() const { return model; }
+
+
+size_t layout_optimizer::get_n_ships() const { return ships.size(); }
+
+
+uint64_t layout_optimizer::get_moves() const { return moves; }
+
+
+void layout_optimizer::init_density(){
+    // ship placements covering every cell, over the whole fleet
+    density.assign(width * height, 0.0);
+    for(ship_type type : ships)
+        for(const slot& s : slots[type])
+            for(size_t i=0; i<type; ++i) density[s.cells[i]] += 1;
+
+    // a parity hunter finds the other colour only when targeting
+    if(model == DM_PARITY){
+        for(size_t c=0; c<density.size(); ++c)
+            if((c / width + c % width) % 2) density[c] *= 0.25;
+    }
+
+    double sum = 0;
+    for(double x : density) sum += x;
+    for(double& x : density) x *= density.size() / sum;
+    update_slots();
+}
+
+
+void layout_optimizer::update_slots(){
+    for(size_t len=0; len<slots.size(); ++len){
+        for(slot& s : slots[len]){
+            s.dens = 0;
+            for(size_t i=0; i<len; ++i) s.dens += density[s.cells[i]];
+        }
+    }
+}
+
+
+int layout_optimizer::contacts(const slot& s, size_t len, int k) const {
+    int n = 0;
+    for(size_t i=0; i<len; ++i){
+        size_t r = s.cells[i] / width, c = s.cells[i] % width, cell = s.cells[i];
+        if(r > 0          && owner[cell - width] >= 0 && owner[cell - width] != k) ++n;
+        if(r + 1 < height && owner[cell + width] >= 0 && owner[cell + width] != k) ++n;
+        if(c > 0          && owner[cell - 1] >= 0     && owner[cell - 1] != k) ++n;
+        if(c + 1 < width  && owner[cell + 1] >= 0     && owner[cell + 1] != k) ++n;
+    }
+    return n;
+}
+
+
+bool layout_optimizer::free_for(const slot& s, size_t len, int k) const {
+    for(size_t i=0; i<len; ++i)
+        if(owner[s.cells[i]] >= 0 && owner[s.cells[i]] != k) return false;
+    return true;
+}
+
+
+void layout_optimizer::mark(const slot& s, size_t len, int k){
+    for(size_t i=0; i<len; ++i) owner[s.cells[i]] = k;
+}
+
+
+}
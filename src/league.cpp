@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include "battleship.h"
+#include "league.h"
+
+namespace bship{
+
+
+/// Glicko scale factor, ln(10) / 400
+static const double GLICKO_Q = std::log(10.0) / 400;
+
+
+/// Weight of a game against an opponent of some deviation
+static double glicko_g(double rd){
+    return 1 / std::sqrt(1 + 3 * GLICKO_Q * GLICKO_Q * rd * rd / (M_PI * M_PI));
+}
+
+
+void glicko_update(glicko_rating& r, const glicko_game *games, size_t n, double min_rd){
+    if(n == 0) return;
+
+    double inv_d2 = 0, delta = 0;
+    for(size_t i=0; i<n; ++i){
+        double g = glicko_g(games[i].opponent.rd);
+        double e = 1 / (1 + std::pow(10.0, -g * (r.rating - games[i].opponent.rating) / 400));
+        inv_d2 += GLICKO_Q * GLICKO_Q * g * g * e * (1 - e);
+        delta  += g * (games[i].score - e);
+    }
+
+    double precision = 1 / (r.rd * r.rd) + inv_d2;
+    r.rating += GLICKO_Q / precision * delta;
+    r.rd = std::max(std::sqrt(1 / precision), min_rd);
+}
+
+
+double glicko_expected(const glicko_rating& r, const glicko_rating& opp){
+    double g = glicko_g(std::sqrt(r.rd * r.rd + opp.rd * opp.rd));
+    return 1 / (1 + std::pow(10.0, -g * (r.rating - opp.rating) / 400));
+}
+
+
+
+league::league(const bot_factory& make_bot, const league_config& config)
+:   make(make_bot),
+    cfg(config),
+    played(0),
+    stopping(false)
+{
+    cfg.threads = std::max(cfg.threads, 1);
+    cfg.batch = std::max<uint64_t>(cfg.batch, 2);
+}
+
+
+size_t league::add(const std::string& spec, const glicko_rating& initial){
+    std::lock_guard<std::mutex> lock(mtx);
+    for(size_t i=0; i<players.size(); ++i)
+        if(players[i].spec == spec) return i;
+
+    players.push_back(league_standing{spec, initial, 0, 0});
+    sched_rd.push_back(initial.rd);
+    in_progress.assign(players.size() * players.size(), 0);
+    return players.size() - 1;
+}
+
+
+uint64_t league::run(uint64_t games){
+    stopping = false;
+    std::atomic<uint64_t> next(0), done(0);
+
+    // every thread claims a batch, plays it without the lock, and reports it
+    auto worker = [&](){
+        while(!stopping && next.fetch_add(cfg.batch) < games){
+            size_t a, b;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if(!choose(a, b)) return;
+                ++in_progress[a * players.size() + b];
+            }
+            uint64_t wins_a = play_batch(a, b);
+            report(a, b, wins_a, cfg.batch);
+            done += cfg.batch;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(int t=0; t<cfg.threads; ++t) threads.emplace_back(worker);
+    for(auto& t : threads) t.join();
+    return done;
+}
+
+
+void league::stop(){ stopping = true; }
+
+
+bool league::next_pairing(size_t& a, size_t& b){
+    std::lock_guard<std::mutex> lock(mtx);
+    return choose(a, b);
+}
+
+
+std::vector<league_standing> league::standings() const {
+    std::vector<league_standing> st;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        st = players;
+    }
+    std::stable_sort(st.begin(), st.end(), [](const league_standing& x, const league_standing& y){
+        return x.rating.rating > y.rating.rating;
+    });
+    return st;
+}
+
+
+uint64_t league::get_games() const { return played; }
+
+
+std::string league::to_text() const {
+    std::ostringstream os;
+    std::vector<league_standing> st = standings();
+    os << get_games() << " games\n";
+    for(size_t i=0; i<st.size(); ++i){
+        const league_standing& p = st[i];
+        os << i + 1 << ". " << p.spec << ": " << (long) std::round(p.rating.rating)
+           << " +- " << (long) std::round(2 * p.rating.rd) << ", " << p.games << " games, won "
+           << 100.0 * p.wins / std::max<uint64_t>(p.games, 1) << "%\n";
+    }
+    return os.str();
+}
+
+
+std::string league::to_json() const {
+    std::ostringstream os;
+    std::vector<league_standing> st = standings();
+    os << "[";
+    for(size_t i=0; i<st.size(); ++i){
+        // specs are ours, only quotes and backslashes are escaped
+        std::string spec;
+        for(char ch : st[i].spec){
+            if(ch == '"' || ch == '\\') spec += '\\';
+            spec += ch;
+        }
+        os << ((i > 0) ? ", " : "") << "{\"spec\": \"" << spec << "\", \"rating\": " << st[i].rating.rating
+           << ", \"rd\": " << st[i].rating.rd << ", \"games\": " << st[i].games << ", \"wins\": " << st[i].wins << "}";
+    }
+    os << "]";
+    return os.str();
+}
+
+
+bool league::choose(size_t& a, size_t& b) const {
+    size_t n = players.size();
+    double best = -1;
+
+    for(size_t i=0; i<n; ++i){
+        for(size_t j=i+1; j<n; ++j){
+            // chance that the order of the two ratings is wrong, times the
+            // deviation of their difference
+            double sd = std::sqrt(sched_rd[i] * sched_rd[i] + sched_rd[j] * sched_rd[j]);
+            double gap = std::fabs(players[i].rating.rating - players[j].rating.rating);
+            double wrong = 0.5 * std::erfc(gap / (sd * M_SQRT2));
+            double score = wrong * sd / (1 + in_progress[i * n + j] + in_progress[j * n + i]);
+            if(score > best){
+                best = score;
+                a = i;
+                b = j;
+            }
+        }
+    }
+    return best >= 0;
+}
+
+
+uint64_t league::play_batch(size_t a, size_t b){
+    // players are not added during a run, the specs stay put
+    const std::string& spec_a = players[a].spec;
+    const std::string& spec_b = players[b].spec;
+
+    // two game slots, each player moving first in one of them; the players
+    // are named after their specs, so that a bot keeping a model of its
+    // opponents (see model_player) finds the right one
+    std::unique_ptr<battleship> game[2];
+    std::unique_ptr<bs_player> pa[2], pb[2];
+    for(int s=0; s<2; ++s){
+        game[s].reset(new battleship(10, 10, OM_SILENT));
+        pa[s].reset(make(spec_a, spec_a));
+        pb[s].reset(make(spec_b, spec_b));
+        if(s == 0) connect(game[s].get(), pa[s].get(), pb[s].get());
+        else connect(game[s].get(), pb[s].get(), pa[s].get());
+    }
+
+    uint64_t wins_a = 0;
+    for(uint64_t i=0; i<cfg.batch; ++i){
+        int s = i % 2;
+        game[s]->reset();
+        game[s]->start();
+        if(game[s]->get_winner() == pa[s].get()) ++wins_a;
+    }
+    return wins_a;
+}
+
+
+void league::decay(glicko_rating& r) const {
+    // the deviation grows by rd_growth (Glicko's c) and the rating moves
+    // back toward the unrated prior by as much, which keeps the prior the
+    // long-run distribution of a rating: a player nobody beats is bounded
+    const glicko_rating prior;
+    double c2 = std::min(cfg.rd_growth * cfg.rd_growth, prior.rd * prior.rd);
+    double phi = std::sqrt(1 - c2 / (prior.rd * prior.rd));
+    r.rating = prior.rating + phi * (r.rating - prior.rating);
+    r.rd = std::sqrt(phi * phi * r.rd * r.rd + c2);
+}
+
+
+void league::report(size_t a, size_t b, uint64_t wins_a, uint64_t games){
+    std::lock_guard<std::mutex> lock(mtx);
+    league_standing& x = players[a];
+    league_standing& y = players[b];
+
+    decay(x.rating);
+    decay(y.rating);
+
+    // the batch is a rating period of both players, scored on the ratings before it
+    std::vector<glicko_game> ga(games), gb(games);
+    for(uint64_t i=0; i<games; ++i){
+        ga[i] = glicko_game{y.rating, (i < wins_a) ? 1.0 : 0.0};
+        gb[i] = glicko_game{x.rating, (i < wins_a) ? 0.0 : 1.0};
+    }
+
+    glicko_rating sx = x.rating, sy = y.rating;
+    sx.rd = sched_rd[a];
+    sy.rd = sched_rd[b];
+    glicko_update(sx, ga.data(), games);
+    glicko_update(sy, gb.data(), games);
+    sched_rd[a] = sx.rd;
+    sched_rd[b] = sy.rd;
+
+    glicko_update(x.rating, ga.data(), games);
+    glicko_update(y.rating, gb.data(), games);
+
+    x.games += games;
+    y.games += games;
+    x.wins += wins_a;
+    y.wins += games - wins_a;
+    --in_progress[a * players.size() + b];
+    played += games;
+}
+
+
+}
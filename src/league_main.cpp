@@ -0,0 +1,81 @@
+/*!
+    Rates bots against each other: plays games between the pairings whose
+    order is the most uncertain on several threads and prints the standings
+    as they change (see league.h)
+
+    usage: bship_league <games> <threads> <text|json> <bots...>
+
+    bots: random, slick[:difficulty], prob, model[:prior dir], hide[:parity|uniform]
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "bot_factory.h"
+#include "league.h"
+
+using namespace bship;
+using namespace std;
+
+
+/// seconds between two reports of the standings during the run
+#define LEAGUE_REPORT_SECS  10
+
+
+int main(int argc, char **argv){
+    if(argc < 6){
+        cerr << "usage: " << argv[0] << " <games> <threads> <text|json> <bots...>" << endl;
+        cerr << "bots: " << BOT_SPECS << endl;
+        return 1;
+    }
+    srand(time(NULL));
+
+    uint64_t games = strtoull(argv[1], nullptr, 10);
+    league_config cfg;
+    cfg.threads = max(1, atoi(argv[2]));
+    bool json = (string(argv[3]) == "json");
+
+    league lg(make_bot, cfg);
+    for(int i=4; i<argc; ++i){
+        unique_ptr<bs_player> check(make_bot(argv[i], "check"));
+        if(!check){
+            cerr << "unknown bot " << argv[i] << endl;
+            return 1;
+        }
+        lg.add(argv[i]);
+    }
+
+    // the games are played in the background, the standings are read in the meantime
+    auto start = chrono::steady_clock::now();
+    uint64_t played = 0;
+    atomic<bool> finished(false);
+    thread runner([&](){
+        played = lg.run(games);
+        finished = true;
+    });
+
+    auto last = start;
+    while(!finished){
+        this_thread::sleep_for(chrono::milliseconds(100));
+        if(json || chrono::steady_clock::now() - last < chrono::seconds(LEAGUE_REPORT_SECS)) continue;
+        last = chrono::steady_clock::now();
+        cout << lg.to_text() << endl;
+    }
+    runner.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if(json){
+        cout << "{\"games\": " << played << ", \"threads\": " << cfg.threads << ", \"seconds\": " << secs
+             << ", \"standings\": " << lg.to_json() << "}" << endl;
+    }
+    else{
+        cout << lg.to_text();
+        cout << "games per second: " << played / max(secs, 1e-9) << " (" << cfg.threads << " threads)" << endl;
+    }
+    return 0;
+}
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
 #include "battleship.h"
+#include "calibration.h"
 #include "console_game.h"
 #include "human_player.h"
 #include "slick_player.h"
@@ -12,12 +14,24 @@ using namespace std;
 #define SLIDER_LEN 20
 
 
-int main(){
+int main(int argc, char **argv){
     srand(time(NULL));
 
     string user_name;
     float diff = 0.2;
     char read = 't';
+
+    // with a difficulty table (see bship_calibrate), the slider goes through its entries
+    string reference;
+    vector<calib_point> table;
+    if(argc > 1){
+        table = load_difficulty_table(argv[1], &reference);
+        if(table.empty()){
+            cerr << "can't read the difficulty table " << argv[1] << endl;
+            return 1;
+        }
+    }
+    size_t level = table.size() / 2;
     
     cout << "Enter your name: ";
     getline(cin, user_name);
@@ -28,7 +42,20 @@ int main(){
     cout << "Choose the difficulty with - and + keys and press SPACE:" << endl;
     cout << "(q to quit)" << endl;
     system("stty raw");
-    while(read != ' ' && read != 'q'){
+    while(!table.empty() && read != ' ' && read != 'q'){
+        const calib_point& pt = table[level];
+        cout << "\r[";
+        for(size_t i=0; i<table.size(); ++i) cout << ((i == level) ? "|" : "=");
+        cout << "] " << fixed << setprecision(2);
+        if(pt.kind == CT_WIN_RATE) cout << "bot wins " << 100 * pt.value << "% against " << reference << "  ";
+        else cout << "bot wins in " << pt.value << " shots against " << reference << "  ";
+        read = getchar();
+        if(read == '-' && level > 0) --level;
+        else if(read == '+' && level + 1 < table.size()) ++level;
+        else if(read == 'q') { system("stty cooked"); cout << endl; return 1; }
+        diff = table[level].peek_prob;
+    }
+    while(table.empty() && read != ' ' && read != 'q'){
         cout << "\r[";
         int before = diff * SLIDER_LEN;
         for(int i=0; i<before; ++i) cout << "=";
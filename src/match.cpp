@@ -0,0 +1,60 @@
+/*!
+    Plays an external bot (see external_player) against slick_player
+
+    usage: bship_match <games> <difficulty> <bot> [bot arguments...]
+*/
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "battleship.h"
+#include "external_player.h"
+#include "slick_player.h"
+
+using namespace bship;
+using namespace std;
+
+
+int main(int argc, char **argv){
+    if(argc < 4){
+        cerr << "usage: " << argv[0] << " <games> <difficulty> <bot> [bot arguments...]" << endl;
+        return 1;
+    }
+    srand(time(NULL));
+
+    int games = atoi(argv[1]);
+    float diff = atof(argv[2]);
+    vector<string> cmd(argv + 3, argv + argc);
+
+    try{
+        external_player ext(cmd);
+        int wins = 0, shots = 0;
+
+        for(int g=0; g<games; ++g){
+            battleship game(10, 10, OM_SILENT);
+            slick_player opp("slick", diff);
+
+            // alternate the first player
+            if(g % 2 == 0) connect(&game, &ext, &opp);
+            else connect(&game, &opp, &ext);
+
+            game.start();
+            if(game.get_winner() == &ext) ++wins;
+            shots += game.get_total_shots();
+        }
+
+        cout << ext.get_name() << " won " << wins << "/" << games << " games against slick_player (" << diff << ")" << endl;
+        cout << "average shots per game: " << (double) shots / max(games, 1) << endl;
+        cout << "requests: " << ext.get_num_requests()
+             << ", mean latency: " << ext.get_mean_latency().count() / 1000.0 << " us"
+             << ", max latency: " << ext.get_max_latency().count() / 1000.0 << " us" << endl;
+    }
+    catch(protocol_exception& e){
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include "metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace bship{
+
+
+latency_histogram::latency_histogram()
+:   count(0),
+    sum_ns(0),
+    max_ns(0)
+{
+    std::fill(buckets, buckets + N_BUCKETS, 0);
+}
+
+
+void latency_histogram::add(std::chrono::nanoseconds d){
+    uint64_t ns = (d.count() > 0) ? d.count() : 0;
+    int b = 0;
+    while(b < N_BUCKETS-1 && (ns >> (b+1)) != 0) ++b;
+
+    ++buckets[b];
+    ++count;
+    sum_ns += ns;
+    max_ns = std::max(max_ns, ns);
+}
+
+
+void latency_histogram::merge(const latency_histogram& other){
+    for(int i=0; i<N_BUCKETS; ++i) buckets[i] += other.buckets[i];
+    count  += other.count;
+    sum_ns += other.sum_ns;
+    max_ns  = std::max(max_ns, other.max_ns);
+}
+
+
+std::chrono::nanoseconds latency_histogram::quantile(double q) const {
+    if(count == 0) return std::chrono::nanoseconds(0);
+
+    uint64_t rank = std::max((uint64_t) 1, (uint64_t) (q * count + 0.5)), seen = 0;
+    for(int i=0; i<N_BUCKETS; ++i){
+        seen += buckets[i];
+        if(seen >= rank) return std::chrono::nanoseconds(std::min(max_ns, ((uint64_t) 2 << i) - 1));
+    }
+    return std::chrono::nanoseconds(max_ns);
+}
+
+
+std::chrono::nanoseconds latency_histogram::mean() const {
+    return std::chrono::nanoseconds((count == 0) ? 0 : sum_ns / count);
+}
+
+
+
+metrics_snapshot::metrics_snapshot(){
+    std::fill(counters, counters + MC_COUNT, 0);
+}
+
+
+uint64_t metrics_snapshot::get(metric_counter c) const { return counters[c]; }
+
+
+const char *metrics_snapshot::counter_name(metric_counter c){
+    static const char *names[] = {
+        "placements",
+        "placements_rejected",
+        "shots",
+        "exceptions",
+        "retries",
+        "peeks"
+    };
+    return (c < MC_COUNT) ? names[c] : "unknown";
+}
+
+
+std::string metrics_snapshot::to_text() const {
+    std::ostringstream os;
+    for(int i=0; i<MC_COUNT; ++i)
+        os << counter_name((metric_counter) i) << ": " << counters[i] << "\n";
+
+    for(auto& m : moves){
+        const latency_histogram& h = m.second;
+        os << "move latency " << m.first << ": n " << h.count
+           << ", mean " << h.mean().count() / 1000.0 << " us"
+           << ", p50 " << h.quantile(0.5).count() / 1000.0 << " us"
+           << ", p99 " << h.quantile(0.99).count() / 1000.0 << " us"
+           << ", max " << h.max_ns / 1000.0 << " us\n";
+    }
+    return os.str();
+}
+
+
+std::string metrics_snapshot::to_json() const {
+    std::ostringstream os;
+    os << "{\"counters\": {";
+    for(int i=0; i<MC_COUNT; ++i)
+        os << ((i > 0) ? ", " : "") << "\"" << counter_name((metric_counter) i) << "\": " << counters[i];
+
+    os << "}, \"move_latency\": {";
+    bool first = true;
+    for(auto& m : moves){
+        const latency_histogram& h = m.second;
+
+        // player names are ours, only quotes and backslashes are escaped
+        std::string name;
+        for(char ch : m.first){
+            if(ch == '"' || ch == '\\') name += '\\';
+            name += ch;
+        }
+
+        os << ((first) ? "" : ", ") << "\"" << name << "\": {\"count\": " << h.count
+           << ", \"mean_ns\": " << h.mean().count()
+           << ", \"p50_ns\": " << h.quantile(0.5).count()
+           << ", \"p99_ns\": " << h.quantile(0.99).count()
+           << ", \"max_ns\": " << h.max_ns
+           << ", \"log2_buckets\": [";
+        int last = latency_histogram::N_BUCKETS - 1;
+        while(last > 0 && h.buckets[last] == 0) --last;
+        for(int i=0; i<=last; ++i) os << ((i > 0) ? ", " : "") << h.buckets[i];
+        os << "]}";
+        first = false;
+    }
+    os << "}}";
+    return os.str();
+}
+
+
+
+namespace{
+
+    /// Metrics of one thread
+    struct thread_metrics{
+        std::atomic<uint64_t>                      counters[MC_COUNT];  ///< written by the owning thread only
+        std::mutex                                 mtx;                 ///< guards moves (only contended on read)
+        std::map<std::string, latency_histogram>   moves;               ///< move latencies by player
+
+        thread_metrics(){
+            for(auto& c : counters) c.store(0, std::memory_order_relaxed);
+        }
+    };
+
+
+    /// Metrics of all threads
+    struct registry{
+        std::mutex                        mtx;      ///< guards live and retired
+        std::vector<thread_metrics*>      live;     ///< running threads
+        metrics_snapshot                  retired;  ///< merged values of finished threads
+    };
+
+
+    // never destroyed, threads may finish during static destruction
+    registry& get_registry(){
+        static registry *reg = new registry();
+        return *reg;
+    }
+
+
+    /// Registers the metrics of a thread, merges them into the retired values on exit
+    struct thread_slot{
+        thread_metrics *tm;
+
+        thread_slot() : tm(new thread_metrics()) {
+            registry& reg = get_registry();
+            std::lock_guard<std::mutex> lock(reg.mtx);
+            reg.live.push_back(tm);
+        }
+
+        ~thread_slot(){
+            registry& reg = get_registry();
+            std::lock_guard<std::mutex> lock(reg.mtx);
+            for(int i=0; i<MC_COUNT; ++i) reg.retired.counters[i] += tm->counters[i].load(std::memory_order_relaxed);
+            for(auto& m : tm->moves) reg.retired.moves[m.first].merge(m.second);
+            reg.live.erase(std::find(reg.live.begin(), reg.live.end(), tm));
+            delete tm;
+        }
+    };
+
+
+    thread_metrics& local(){
+        static thread_local thread_slot slot;
+        return *slot.tm;
+    }
+
+}
+
+
+void metrics::add(metric_counter c, uint64_t n){
+    local().counters[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+
+void metrics::record_move(const std::string& player, std::chrono::nanoseconds d){
+    thread_metrics& tm = local();
+    std::lock_guard<std::mutex> lock(tm.mtx);
+    tm.moves[player].add(d);
+}
+
+
+metrics_snapshot metrics::snapshot(){
+    registry& reg = get_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+
+    metrics_snapshot res = reg.retired;
+    for(thread_metrics *tm : reg.live){
+        for(int i=0; i<MC_COUNT; ++i) res.counters[i] += tm->counters[i].load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> tlock(tm->mtx);
+        for(auto& m : tm->moves) res.moves[m.first].merge(m.second);
+    }
+    return res;
+}
+
+
+void metrics::reset(){
+    registry& reg = get_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+
+    reg.retired = metrics_snapshot();
+    for(thread_metrics *tm : reg.live){
+        for(auto& c : tm->counters) c.store(0, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> tlock(tm->mtx);
+        tm->moves.clear();
+    }
+}
+
+
+}
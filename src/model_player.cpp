@@ -0,0 +1,154 @@
+#include <cstdlib>
+#include "model_player.h"
+
+
+namespace bship{
+
+model_player::model_player(std::string nm, const std::string& prior_dir)
+:   bs_player(nm),
+    dir(prior_dir),
+    recorded(false)
+{}
+
+
+model_player::model_player()
+:   bs_player(),
+    recorded(false)
+{}
+
+
+void model_player::move(){
+
+    if(game == nullptr || hidden_grid == nullptr || hit_grid == nullptr){
+        std::cout << "Can't move on a nullptr {game, hidden_grid, hit_grid}" << std::endl;
+        throw illegal_move_exception("Move on nullptr");
+    }
+
+    // random placement
+    if(!hidden_grid->is_ready()){
+        bs_player::move();
+        return;
+    }
+
+    open_prior();
+    size_t w = hit_grid->get_width();
+    if(sunk.size() != w * hit_grid->get_height()) sunk.assign(w * hit_grid->get_height(), 0);
+
+    size_t c = pick_shot();
+    std::pair<shot_result, int> res = game->shoot_at(c / w, c % w);
+    if(res.first == SR_SINK) mark_sunk(c / w, c % w);
+}
+
+
+void model_player::on_update(){
+    if(game == nullptr || recorded || !game->is_finished()) return;
+
+    // the game is over: the opponent's fleet can be looked at
+    open_prior();
+    prior.record((game->pa == this) ? game->pb_hidden_grid : game->pa_hidden_grid);
+    recorded = true;
+}
+
+
+void model_player::reset(){
+    bs_player::reset();
+    new_game();
+}
+
+
+void model_player::set_hidden_grid(bs_grid *hidden){
+    bs_player::set_hidden_grid(hidden);
+    new_game();
+}
+
+
+const placement_prior& model_player::get_prior() const { return prior; }
+
+
+bool model_player::prior_ok() const { return dir.empty() || opponent.empty() || prior.is_open(); }
+
+
+void model_player::new_game(){
+    recorded = false;
+    std::fill(sunk.begin(), sunk.end(), 0);
+}
+
+
+void model_player::open_prior(){
+    if(dir.empty() || game == nullptr || hit_grid == nullptr) return;
+
+    // the player may be connected to another opponent between two games
+    bs_player *opp = (game->pa == this) ? game->pb : game->pa;
+    if(opp == nullptr || opp->get_name() == opponent) return;
+    opponent = opp->get_name();
+
+    // on failure the player goes on without a prior, see prior_ok()
+    prior.open(placement_prior::path_for(dir, opponent), hit_grid->get_width(), hit_grid->get_height());
+}
+
+
+size_t model_player::pick_shot(){
+    long w = hit_grid->get_width(), h = hit_grid->get_height();
+    double best_target = -1, best_hunt = -1;
+    size_t target = 0, hunt = 0;
+
+    for(long r=0; r<h; ++r){
+        for(long c=0; c<w; ++c){
+            if(!hit_grid->cell_at(r, c).can_shoot()) continue;
+
+            // the prior, with a little noise to break ties at random
+            size_t i = r * w + c;
+            double s = prior.weight(i) * (1.0 + 1e-6 * rand() / RAND_MAX);
+
+            if(open_hit(r-1, c) || open_hit(r+1, c) || open_hit(r, c-1) || open_hit(r, c+1)){
+                bool line = (open_hit(r-1, c) && open_hit(r-2, c)) || (open_hit(r+1, c) && open_hit(r+2, c))
+                         || (open_hit(r, c-1) && open_hit(r, c-2)) || (open_hit(r, c+1) && open_hit(r, c+2));
+                if(line) s *= 4;
+                if(s > best_target){
+                    best_target = s;
+                    target = i;
+                }
+            }
+            else{
+                // every ship covers a cell of each colour
+                if((r + c) % 2) s *= 0.5;
+                if(s > best_hunt){
+                    best_hunt = s;
+                    hunt = i;
+                }
+            }
+        }
+    }
+
+    return (best_target >= 0) ? target : hunt;
+}
+
+
+void model_player::mark_sunk(size_t row, size_t col){
+    long w = hit_grid->get_width();
+    long r = row, c = col;
+
+    // extent of the hits through the cell in both directions
+    long up = r, down = r, left = c, right = c;
+    while(open_hit(up - 1, c)) --up;
+    while(open_hit(down + 1, c)) ++down;
+    while(open_hit(r, left - 1)) --left;
+    while(open_hit(r, right + 1)) ++right;
+
+    if(down - up >= right - left){
+        for(long k=up; k<=down; ++k) sunk[k * w + c] = 1;
+    }
+    else{
+        for(long k=left; k<=right; ++k) sunk[r * w + k] = 1;
+    }
+}
+
+
+bool model_player::open_hit(long row, long col){
+    long w = hit_grid->get_width(), h = hit_grid->get_height();
+    if(row < 0 || col < 0 || row >= h || col >= w) return false;
+    return hit_grid->cell_at(row, col).state == CS_DESTROYED && !sunk[row * w + col];
+}
+
+
+}
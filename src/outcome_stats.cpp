@@ -0,0 +1,217 @@
+#include "outcome_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace bship{
+
+
+running_stats::running_stats()
+:   n(0),
+    mu(0),
+    m2(0),
+    lo(std::numeric_limits<double>::infinity()),
+    hi(-std::numeric_limits<double>::infinity())
+{}
+
+
+void running_stats::add(double x){
+    ++n;
+    double d = x - mu;
+    mu += d / n;
+    m2 += d * (x - mu);
+    lo = std::min(lo, x);
+    hi = std::max(hi, x);
+}
+
+
+void running_stats::merge(const running_stats& other){
+    if(other.n == 0) return;
+    if(n == 0){
+        *this = other;
+        return;
+    }
+
+    uint64_t total = n + other.n;
+    double d = other.mu - mu;
+    mu += d * other.n / total;
+    m2 += other.m2 + d * d * ((double) n * other.n / total);
+    n   = total;
+    lo  = std::min(lo, other.lo);
+    hi  = std::max(hi, other.hi);
+}
+
+
+uint64_t running_stats::count() const { return n; }
+
+
+double running_stats::mean() const { return mu; }
+
+
+double running_stats::variance() const { return (n > 1) ? m2 / (n - 1) : 0; }
+
+
+double running_stats::stddev() const { return std::sqrt(variance()); }
+
+
+double running_stats::min() const { return (n > 0) ? lo : 0; }
+
+
+double running_stats::max() const { return (n > 0) ? hi : 0; }
+
+
+
+outcome_stats::pairing::pairing()
+:   games(0),
+    wins_a(0)
+{}
+
+
+double outcome_stats::pairing::win_rate_a() const { return (games > 0) ? (double) wins_a / games : 0; }
+
+
+void outcome_stats::record(const std::string& name, const game_outcome& o){
+    auto it = pairings.find(name);
+    if(it == pairings.end()) it = pairings.insert(std::make_pair(name, pairing())).first;
+    pairing& p = it->second;
+
+    ++p.games;
+    if(o.pa_won) ++p.wins_a;
+
+    int total = o.shots[0] + o.shots[1];
+    p.total_shots.add(total);
+    if((size_t) total >= p.shots_hist.size()) p.shots_hist.resize(total + 1, 0);
+    ++p.shots_hist[total];
+
+    for(int s=0; s<2; ++s){
+        p.shots[s].add(o.shots[s]);
+        if(o.first_hit[s] > 0) p.first_hit[s].add(o.first_hit[s]);
+        if(o.first_sink[s] > 0) p.first_sink[s].add(o.first_sink[s]);
+    }
+}
+
+
+void outcome_stats::merge(const outcome_stats& other){
+    for(auto& op : other.pairings){
+        pairing& p = pairings[op.first];
+        const pairing& q = op.second;
+
+        p.games  += q.games;
+        p.wins_a += q.wins_a;
+        p.total_shots.merge(q.total_shots);
+        if(q.shots_hist.size() > p.shots_hist.size()) p.shots_hist.resize(q.shots_hist.size(), 0);
+        for(size_t i=0; i<q.shots_hist.size(); ++i) p.shots_hist[i] += q.shots_hist[i];
+
+        for(int s=0; s<2; ++s){
+            p.shots[s].merge(q.shots[s]);
+            p.first_hit[s].merge(q.first_hit[s]);
+            p.first_sink[s].merge(q.first_sink[s]);
+        }
+    }
+}
+
+
+outcome_stats::pairing outcome_stats::get(const std::string& name) const {
+    auto it = pairings.find(name);
+    return (it == pairings.end()) ? pairing() : it->second;
+}
+
+
+const std::map<std::string, outcome_stats::pairing>& outcome_stats::get_pairings() const { return pairings; }
+
+
+std::string outcome_stats::to_text() const {
+    std::ostringstream os;
+    for(auto& pp : pairings){
+        const pairing& p = pp.second;
+        os << pp.first << ": " << p.games << " games, A won " << 100 * p.win_rate_a() << "%\n";
+        os << "  total shots: mean " << p.total_shots.mean() << ", stddev " << p.total_shots.stddev()
+           << ", min " << p.total_shots.min() << ", max " << p.total_shots.max() << "\n";
+        for(int s=0; s<2; ++s){
+            os << "  " << ((s == 0) ? "A" : "B") << ": shots " << p.shots[s].mean()
+               << " (stddev " << p.shots[s].stddev() << ")"
+               << ", first hit " << p.first_hit[s].mean()
+               << ", first sink " << p.first_sink[s].mean() << "\n";
+        }
+    }
+    return os.str();
+}
+
+
+// JSON of running statistics
+static void stats_json(std::ostream& os, const running_stats& r){
+    os << "{\"count\": " << r.count() << ", \"mean\": " << r.mean() << ", \"stddev\": " << r.stddev()
+       << ", \"min\": " << r.min() << ", \"max\": " << r.max() << "}";
+}
+
+
+std::string outcome_stats::to_json() const {
+    std::ostringstream os;
+    os << "{";
+    bool first = true;
+    for(auto& pp : pairings){
+        const pairing& p = pp.second;
+
+        // pairing names are ours, only quotes and backslashes are escaped
+        std::string name;
+        for(char ch : pp.first){
+            if(ch == '"' || ch == '\\') name += '\\';
+            name += ch;
+        }
+
+        os << ((first) ? "" : ", ") << "\"" << name << "\": {\"games\": " << p.games << ", \"wins_a\": " << p.wins_a;
+        os << ", \"total_shots\": ";
+        stats_json(os, p.total_shots);
+        os << ", \"shots_hist\": [";
+        for(size_t i=0; i<p.shots_hist.size(); ++i) os << ((i > 0) ? ", " : "") << p.shots_hist[i];
+        os << "]";
+        for(int s=0; s<2; ++s){
+            const char *side = (s == 0) ? "a" : "b";
+            os << ", \"shots_" << side << "\": ";
+            stats_json(os, p.shots[s]);
+            os << ", \"first_hit_" << side << "\": ";
+            stats_json(os, p.first_hit[s]);
+            os << ", \"first_sink_" << side << "\": ";
+            stats_json(os, p.first_sink[s]);
+        }
+        os << "}";
+        first = false;
+    }
+    os << "}";
+    return os.str();
+}
+
+
+
+outcome_recorder::outcome_recorder(outcome_stats& st, const std::string& nm)
+:   stats(st),
+    name(nm)
+{
+    std::memset(&current, 0, sizeof(current));
+}
+
+
+void outcome_recorder::on_place(battleship&, bool, ship_type, size_t, size_t, ship_orientation){
+    // placements come before any shot: the last game was abandoned (reset)
+    if(current.shots[0] + current.shots[1] > 0) std::memset(&current, 0, sizeof(current));
+}
+
+
+void outcome_recorder::on_shot(battleship&, bool by_pa, size_t, size_t, std::pair<shot_result, int> res){
+    int s = (by_pa) ? 0 : 1;
+    int n = ++current.shots[s];
+    if(res.first != SR_MISS && current.first_hit[s] == 0) current.first_hit[s] = n;
+    if(res.first == SR_SINK && current.first_sink[s] == 0) current.first_sink[s] = n;
+}
+
+
+void outcome_recorder::on_game_over(battleship&, bool pa_won){
+    current.pa_won = pa_won;
+    stats.record(name, current);
+    std::memset(&current, 0, sizeof(current));
+}
+
+
+}
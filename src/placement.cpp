@@ -0,0 +1,70 @@
+/*!
+    Records the fleet placements of a bot many times and reports their
+    heat map and their distance from uniformly random legal fleets
+    (see placement_stats.h)
+
+    usage: bship_placement <fleets> <threads> <bot> [text|json]
+
+    bots: random, slick[:difficulty], prob, model[:prior dir], hide[:parity|uniform]
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "bot_factory.h"
+#include "bs_player.h"
+#include "placement_stats.h"
+
+using namespace bship;
+using namespace std;
+
+
+int main(int argc, char **argv){
+    if(argc < 4){
+        cerr << "usage: " << argv[0] << " <fleets> <threads> <bot> [text|json]" << endl;
+        cerr << "bots: " << BOT_SPECS << endl;
+        return 1;
+    }
+    srand(time(NULL));
+
+    long fleets = atol(argv[1]);
+    int n_threads = max(1, atoi(argv[2]));
+    string spec = argv[3];
+    bool json = (argc > 4 && string(argv[4]) == "json");
+
+    unique_ptr<bs_player> check(make_bot(spec, "A"));
+    if(!check){
+        cerr << "unknown bot" << endl;
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    placement_stats st = placement_stats::sample([&spec](const string& name){ return make_bot(spec, name); },
+                                                 10, 10, max(fleets, 1L), n_threads);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> uniform = st.uniform();
+    double chi2 = st.chi_squared(uniform);
+
+    if(json){
+        cout << "{\"bot\": \"" << spec << "\", \"threads\": " << n_threads << ", \"seconds\": " << secs
+             << ", \"placements\": " << st.to_json(uniform) << "}" << endl;
+    }
+    else{
+        cout << st.heat_map();
+        cout << "uniform legal fleets:" << endl;
+        for(size_t r=0; r<10; ++r){
+            for(size_t c=0; c<10; ++c) cout << fixed << setprecision(1) << setw(6) << 100 * uniform[r * 10 + c];
+            cout << endl;
+        }
+        cout << defaultfloat << setprecision(6);
+        cout << "chi-squared: " << chi2 << " (" << chi2 / st.get_fleets() << " per fleet)" << endl;
+        cout << "fleets per second: " << st.get_fleets() / max(secs, 1e-9) << " (" << n_threads << " threads)" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include "placement_masks.h"
+
+namespace bship{
+
+
+// the tables are built by the compiler
+static_assert(placement_masks<10, 10>::mask(5, 9, 5, false).w[1] == (0x1Full << 31), "bad 10x10 mask");
+static_assert(placement_masks<10, 10>::mask(2, 6, 3, true).w[0] == ((1ull << 63)) && placement_masks<10, 10>::mask(2, 6, 3, true).w[1] == (1ull << 9), "bad 10x10 mask");
+static_assert(placement_masks<10, 10>::mask(3, 8, 0, true).w[0] == 0 && placement_masks<10, 10>::mask(3, 8, 0, true).w[1] == 0, "placement out of the grid");
+
+
+const bitboard *placement_table(size_t width, size_t height){
+    if(width == 10 && height == 10) return placement_masks<10, 10>::table();
+    if(width == 8 && height == 8) return placement_masks<8, 8>::table();
+    return nullptr;
+}
+
+
+}
@@ -0,0 +1,132 @@
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "placement_prior.h"
+
+namespace bship{
+
+
+static_assert(sizeof(prior_header) == 24, "prior header layout changed");
+
+
+
+placement_prior::placement_prior()
+:   header(nullptr),
+    counts(nullptr),
+    length(0),
+    cells(0)
+{}
+
+
+placement_prior::~placement_prior(){ close(); }
+
+
+bool placement_prior::open(const std::string& path, size_t width, size_t height){
+    close();
+    if(width == 0 || height == 0 || width * height > bitboard::CAPACITY) return false;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(fd < 0) return false;
+
+    // a new file is sized and stamped under a lock, in case another process creates it too
+    size_t len = sizeof(prior_header) + width * height * sizeof(uint64_t);
+    struct stat st;
+    bool ok = flock(fd, LOCK_EX) == 0 && fstat(fd, &st) == 0;
+    if(ok && st.st_size == 0){
+        prior_header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, "BSPP", 4);
+        h.version = 1;
+        h.width   = width;
+        h.height  = height;
+        ok = ftruncate(fd, len) == 0 && pwrite(fd, &h, sizeof(h), 0) == (ssize_t) sizeof(h);
+        st.st_size = len;
+    }
+    ok = ok && (size_t) st.st_size == len;
+    flock(fd, LOCK_UN);
+
+    void *p = (ok) ? mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if(p == MAP_FAILED) return false;
+
+    header = (prior_header*) p;
+    counts = (uint64_t*) ((char*) p + sizeof(prior_header));
+    length = len;
+    cells  = width * height;
+
+    if(std::memcmp(header->magic, "BSPP", 4) != 0 || header->version != 1
+       || header->width != width || header->height != height){
+        close();
+        return false;
+    }
+    return true;
+}
+
+
+void placement_prior::close(){
+    if(header != nullptr) munmap((void*) header, length);
+    header = nullptr;
+    counts = nullptr;
+    length = 0;
+    cells  = 0;
+}
+
+
+bool placement_prior::is_open() const { return header != nullptr; }
+
+
+void placement_prior::record(const bitboard& fleet){
+    if(header == nullptr) return;
+
+    for(int k=0; k<2; ++k){
+        for(uint64_t w = fleet.w[k]; w; w &= w - 1){
+            size_t c = 64 * k + __builtin_ctzll(w);
+            if(c < cells) __atomic_fetch_add(&counts[c], 1, __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_fetch_add(&header->fleets, 1, __ATOMIC_RELAXED);
+}
+
+
+void placement_prior::record(bs_grid& grid){
+    bitboard fleet;
+    for(size_t r=0; r<grid.get_height(); ++r){
+        for(size_t c=0; c<grid.get_width(); ++c){
+            cell_state s = grid.cell_at(r, c).state;
+            if(s == CS_FULL || s == CS_DESTROYED) fleet.set(r * grid.get_width() + c);
+        }
+    }
+    record(fleet);
+}
+
+
+uint64_t placement_prior::fleets() const {
+    return (header) ? __atomic_load_n(&header->fleets, __ATOMIC_RELAXED) : 0;
+}
+
+
+uint64_t placement_prior::count(size_t cell) const {
+    return (header && cell < cells) ? __atomic_load_n(&counts[cell], __ATOMIC_RELAXED) : 0;
+}
+
+
+double placement_prior::weight(size_t cell) const {
+    return (count(cell) + 1.0) / (fleets() + 2.0);
+}
+
+
+std::string placement_prior::path_for(const std::string& dir, const std::string& opponent){
+    std::string name;
+    for(char ch : opponent){
+        bool keep = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_' || ch == '-';
+        name += (keep) ? ch : '_';
+    }
+    if(name.empty()) name = "_";
+    return dir + "/" + name + ".prior";
+}
+
+
+}
@@ -0,0 +1,210 @@
+#include "placement_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include "battleship.h"
+#include "fleet_counter.h"
+#include "game_listener.h"
+
+namespace bship{
+
+
+namespace{
+
+    /// Number of ship types (ST_TWO to ST_FIVE)
+    const size_t N_TYPES = ST_FIVE - ST_TWO + 1;
+
+
+    /// Records the placements of both players of a game
+    class placement_recorder : public game_listener {
+    public:
+
+        placement_recorder(placement_stats& st) : stats(st), placed(0) {}
+
+        void on_place(battleship&, bool, ship_type type, size_t row, size_t col, ship_orientation orient){
+            stats.add_ship(type, row, col, orient);
+            ++placed;
+        }
+
+        placement_stats  &stats;   ///< counts recorded into
+        size_t            placed;  ///< ships placed in the current game
+    };
+
+}
+
+
+placement_stats::placement_stats(size_t w, size_t h, const std::map<ship_type, uint8_t>& fl)
+:   width(w),
+    height(h),
+    fleet(fl),
+    fleets(0),
+    counts(N_TYPES * w * h, 0)
+{}
+
+
+size_t placement_stats::type_index(ship_type type){ return type - ST_TWO; }
+
+
+void placement_stats::add_ship(ship_type type, size_t row, size_t col, ship_orientation orient){
+    size_t step = (orient == SO_HOR) ? 1 : width;
+    uint64_t *c = counts.data() + type_index(type) * width * height + row * width + col;
+    for(int i=0; i<type; ++i, c += step) ++*c;
+}
+
+
+void placement_stats::add_fleets(uint64_t n){ fleets += n; }
+
+
+void placement_stats::merge(const placement_stats& other){
+    fleets += other.fleets;
+    uint64_t *dst = counts.data();
+    const uint64_t *src = other.counts.data();
+    for(size_t i=0, n=counts.size(); i<n; ++i) dst[i] += src[i];
+}
+
+
+uint64_t placement_stats::get_fleets() const { return fleets; }
+
+
+uint64_t placement_stats::occupancy(ship_type type, size_t row, size_t col) const {
+    return counts[type_index(type) * width * height + row * width + col];
+}
+
+
+uint64_t placement_stats::occupancy(size_t row, size_t col) const {
+    // ships never overlap, the types add up
+    uint64_t n = 0;
+    for(size_t t=0; t<N_TYPES; ++t) n += counts[t * width * height + row * width + col];
+    return n;
+}
+
+
+double placement_stats::frequency(size_t row, size_t col) const {
+    return (fleets > 0) ? (double) occupancy(row, col) / fleets : 0;
+}
+
+
+std::vector<double> placement_stats::uniform() const {
+    bs_grid empty(width, height);
+    fleet_counter fc(width, height, fleet);
+    fc.solve(empty);
+
+    std::vector<double> p(width * height);
+    for(size_t r=0; r<height; ++r)
+        for(size_t c=0; c<width; ++c)
+            p[r * width + c] = fc.hit_prob(r, c);
+    return p;
+}
+
+
+double placement_stats::chi_squared(const std::vector<double>& expected) const {
+    double chi2 = 0;
+    for(size_t r=0; r<height; ++r){
+        for(size_t c=0; c<width; ++c){
+            double e = fleets * expected[r * width + c];
+            if(e <= 0) continue;
+            double d = occupancy(r, c) - e;
+            chi2 += d * d / e;
+        }
+    }
+    return chi2;
+}
+
+
+// one heat map, percent of the fleets
+static void write_map(std::ostream& os, size_t width, size_t height, const std::function<double(size_t, size_t)>& f){
+    for(size_t r=0; r<height; ++r){
+        for(size_t c=0; c<width; ++c) os << std::setw(6) << std::fixed << std::setprecision(1) << 100 * f(r, c);
+        os << "\n";
+    }
+}
+
+
+std::string placement_stats::heat_map() const {
+    std::ostringstream os;
+    double n = std::max(fleets, (uint64_t) 1);
+
+    os << "all ships (" << fleets << " fleets, % of the fleets covering each cell):\n";
+    write_map(os, width, height, [&](size_t r, size_t c){ return frequency(r, c); });
+    for(auto& tp : fleet){
+        os << (int) tp.first << "-cell ships:\n";
+        write_map(os, width, height, [&](size_t r, size_t c){ return occupancy(tp.first, r, c) / n; });
+    }
+    return os.str();
+}
+
+
+std::string placement_stats::to_json(const std::vector<double>& expected) const {
+    std::ostringstream os;
+    os << "{\"width\": " << width << ", \"height\": " << height << ", \"fleets\": " << fleets;
+
+    auto cells = [&](const std::function<uint64_t(size_t, size_t)>& f){
+        os << "[";
+        for(size_t i=0; i<width * height; ++i) os << ((i > 0) ? ", " : "") << f(i / width, i % width);
+        os << "]";
+    };
+
+    os << ", \"occupancy\": ";
+    cells([&](size_t r, size_t c){ return occupancy(r, c); });
+    os << ", \"by_type\": {";
+    bool first = true;
+    for(auto& tp : fleet){
+        os << ((first) ? "" : ", ") << "\"" << (int) tp.first << "\": ";
+        cells([&](size_t r, size_t c){ return occupancy(tp.first, r, c); });
+        first = false;
+    }
+    os << "}";
+
+    if(!expected.empty()){
+        double chi2 = chi_squared(expected);
+        os << ", \"uniform\": [";
+        for(size_t i=0; i<expected.size(); ++i) os << ((i > 0) ? ", " : "") << expected[i];
+        os << "], \"chi_squared\": " << chi2
+           << ", \"chi_squared_per_fleet\": " << ((fleets > 0) ? chi2 / fleets : 0);
+    }
+    os << "}";
+    return os.str();
+}
+
+
+placement_stats placement_stats::sample(const std::function<bs_player*(const std::string&)>& make,
+                                        size_t width, size_t height, uint64_t fleets, int threads){
+    bs_grid proto(width, height);
+    size_t ships = 0;
+    for(auto& tp : proto.get_max_n_ships()) ships += tp.second;
+
+    threads = std::max(threads, 1);
+    std::vector<placement_stats> stats(threads, placement_stats(width, height, proto.get_max_n_ships()));
+    std::atomic<uint64_t> next(0);
+    uint64_t games = (fleets + 1) / 2;
+
+    // one game slot per thread, only the placement phase is played
+    auto worker = [&](int t){
+        battleship game(width, height, OM_SILENT);
+        std::unique_ptr<bs_player> pa(make("A")), pb(make("B"));
+        connect(&game, pa.get(), pb.get());
+        placement_recorder rec(stats[t]);
+        game.add_listener(&rec);
+
+        while(next++ < games){
+            game.reset();
+            rec.placed = 0;
+            while(rec.placed < 2 * ships) game.get_current_player()->move();
+            stats[t].add_fleets(2);
+        }
+        game.remove_listener(&rec);
+    };
+
+    std::vector<std::thread> pool;
+    for(int t=0; t<threads; ++t) pool.emplace_back(worker, t);
+    for(auto& th : pool) th.join();
+
+    for(int t=1; t<threads; ++t) stats[0].merge(stats[t]);
+    return stats[0];
+}
+
+
+}
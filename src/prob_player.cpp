@@ -0,0 +1,63 @@
+#include "prob_player.h"
+
+namespace bship{
+
+
+prob_player::prob_player(std::string& n, bs_grid* hdg, bs_grid* htg, battleship *gm)
+:   async_player(n, hdg, htg, gm)
+{}
+
+
+prob_player::prob_player(std::string nm)
+:   async_player(nm)
+{}
+
+
+prob_player::prob_player()
+:   async_player()
+{}
+
+
+prob_player::~prob_player(){
+    stop_pondering();
+    delete counter;
+    delete endgame;
+}
+
+
+bool prob_player::think(bs_grid& obs, const std::atomic<bool>& stop, size_t& row, size_t& col){
+    if(counter == nullptr) counter = new fleet_counter(obs);
+    if(endgame == nullptr) endgame = new endgame_solver(obs);
+
+    counter->set_stop_flag(&stop);
+    arr_count total = counter->solve(obs);
+    counter->set_stop_flag(nullptr);
+
+    // stopped, or nothing is consistent (can not happen in a regular game)
+    if(total == 0) return false;
+
+    // few layouts left, search for the optimal shot
+    if(total <= endgame->get_max_layouts() && endgame->best_shot(obs, row, col))
+        return true;
+
+    arr_count best = 0;
+    bool found = false;
+
+    for(size_t i=0; i<obs.get_height(); ++i){
+        for(size_t j=0; j<obs.get_width(); ++j){
+            if(!obs.cell_at(i, j).can_shoot()) continue;
+            arr_count n = counter->cover_count(i, j);
+            if(!found || n > best){
+                best = n;
+                row = i;
+                col = j;
+                found = true;
+            }
+        }
+    }
+
+    return found;
+}
+
+
+}
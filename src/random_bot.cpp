@@ -0,0 +1,108 @@
+/*!
+    Example bot for external_player: random placement, random shots
+    (hunting around hits). Standalone, it only speaks the protocol
+    documented in external_player.h
+*/
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+int main(){
+    srand(time(NULL));
+
+    // stdout is only flushed when a reply is due
+    ios::sync_with_stdio(false);
+
+    size_t width = 0, height = 0;
+    vector<int> lens;
+    vector<char> shot, hit;    // per cell: shot before, was a hit
+    string line;
+
+    while(getline(cin, line)){
+        istringstream is(line);
+        string cmd;
+        is >> cmd;
+
+        if(cmd == "bship"){
+            cout << "bshipok random_bot" << endl;
+        }
+        else if(cmd == "newgame"){
+            is >> width >> height;
+            lens.clear();
+            string tp;
+            while(is >> tp){
+                int len = atoi(tp.c_str());
+                int n = atoi(tp.substr(tp.find('x') + 1).c_str());
+                for(int k=0; k<n; ++k) lens.push_back(len);
+            }
+            shot.assign(width * height, 0);
+            hit.assign(width * height, 0);
+        }
+        else if(cmd == "place"){
+            string id;
+            is >> id;
+
+            // retry until the ships fit without overlapping
+            vector<char> occ;
+            ostringstream os;
+            bool ok = false;
+            while(!ok){
+                occ.assign(width * height, 0);
+                os.str("");
+                ok = true;
+                for(size_t s=0; s<lens.size() && ok; ++s){
+                    size_t len = lens[s];
+                    bool hor = rand() % 2;
+                    if((hor && len > width) || (!hor && len > height)){ ok = false; break; }
+                    size_t r = rand() % (hor ? height : height - len + 1);
+                    size_t c = rand() % (hor ? width - len + 1 : width);
+                    for(size_t k=0; k<len && ok; ++k) ok = !occ[(r + (hor ? 0 : k))*width + c + (hor ? k : 0)];
+                    if(!ok) break;
+                    for(size_t k=0; k<len; ++k) occ[(r + (hor ? 0 : k))*width + c + (hor ? k : 0)] = 1;
+                    os << " " << len << " " << r << " " << c << " " << (hor ? "h" : "v");
+                }
+            }
+            cout << "placement " << id << os.str() << endl;
+        }
+        else if(cmd == "shoot"){
+            string id;
+            is >> id;
+
+            // neighbours of hits first, then any cell
+            vector<size_t> cand;
+            for(size_t i=0; i<width*height; ++i){
+                if(!hit[i]) continue;
+                size_t r = i / width, c = i % width;
+                if(r > 0 && !shot[i - width]) cand.push_back(i - width);
+                if(r+1 < height && !shot[i + width]) cand.push_back(i + width);
+                if(c > 0 && !shot[i - 1]) cand.push_back(i - 1);
+                if(c+1 < width && !shot[i + 1]) cand.push_back(i + 1);
+            }
+            if(cand.empty())
+                for(size_t i=0; i<width*height; ++i)
+                    if(!shot[i]) cand.push_back(i);
+
+            size_t i = cand[rand() % cand.size()];
+            cout << "shot " << id << " " << i / width << " " << i % width << endl;
+        }
+        else if(cmd == "result"){
+            size_t r, c;
+            string res;
+            is >> r >> c >> res;
+            shot[r*width + c] = 1;
+            hit[r*width + c] = (res != "miss");
+        }
+        else if(cmd == "quit"){
+            break;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,395 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#ifdef BSHIP_ZLIB
+#include <zlib.h>
+#endif
+#include "battleship.h"
+#include "selfplay.h"
+
+namespace bship{
+
+
+static_assert(sizeof(shard_header) == 16, "shard header layout changed");
+static_assert(sizeof(shard_chunk) == 12, "chunk header layout changed");
+
+
+/// bytes of an encoded sample
+#define SAMPLE_BYTES   (6 * 8 + 4 + 2 + 1 + 1)
+
+
+/// Appends a field of every sample to an encoded chunk
+template<class F, class G>
+static uint8_t *put_field(uint8_t *p, const std::vector<train_sample>& v, G get){
+    for(const train_sample& s : v){
+        F x = get(s);
+        std::memcpy(p, &x, sizeof(F));
+        p += sizeof(F);
+    }
+    return p;
+}
+
+
+/// Reads a field of every sample of an encoded chunk
+template<class F, class S>
+static const uint8_t *get_field(const uint8_t *p, std::vector<train_sample>& v, S set){
+    for(train_sample& s : v){
+        F x;
+        std::memcpy(&x, p, sizeof(F));
+        set(s, x);
+        p += sizeof(F);
+    }
+    return p;
+}
+
+
+
+sample_recorder::sample_recorder(bounded_queue<train_sample>& q, size_t width_)
+:   queue(&q),
+    game_id(0),
+    width(width_)
+{
+    samples.reserve(256);
+    clear();
+}
+
+
+void sample_recorder::set_game(uint32_t game){ game_id = game; }
+
+
+void sample_recorder::clear(){
+    samples.clear();
+    side[0] = side[1] = planes();
+}
+
+
+void sample_recorder::on_place(battleship&, bool, ship_type, size_t, size_t, ship_orientation){
+    // a placement after shots is a new game whose end was not seen
+    if(!samples.empty()) clear();
+}
+
+
+void sample_recorder::on_shot(battleship&, bool by_pa, size_t row, size_t col, std::pair<shot_result, int> res){
+    planes& p = side[by_pa];
+    size_t c = row * width + col;
+
+    train_sample s;
+    s.hits   = p.hits;
+    s.misses = p.misses;
+    s.sunk   = p.sunk;
+    s.game   = game_id;
+    s.move   = p.shots++;
+    s.cell   = c;
+    s.flags  = ((by_pa) ? SF_BY_PA : 0) | ((res.first != SR_MISS) ? SF_HIT : 0) | ((res.first == SR_SINK) ? SF_SINK : 0);
+    samples.push_back(s);
+
+    if(res.first == SR_MISS){
+        p.misses.set(c);
+    }
+    else{
+        p.hits.set(c);
+        if(res.second >= 0 && res.second < 16){
+            p.ships[res.second].set(c);
+            if(res.first == SR_SINK) p.sunk |= p.ships[res.second];
+        }
+    }
+}
+
+
+void sample_recorder::on_game_over(battleship&, bool pa_won){
+    for(train_sample& s : samples){
+        if(((s.flags & SF_BY_PA) != 0) == pa_won) s.flags |= SF_WON;
+        queue->push(s);
+    }
+    clear();
+}
+
+
+
+shard_writer::shard_writer(const selfplay_config& config, size_t width, size_t height)
+:   cfg(config),
+    file(nullptr),
+    in_shard(0),
+    samples(0),
+    chunks(0),
+    shards(0),
+    raw_bytes(0),
+    stored(0),
+    failed(false)
+{
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "BSSP", 4);
+    header.version = 1;
+    header.width   = width;
+    header.height  = height;
+#ifdef BSHIP_ZLIB
+    header.codec   = (cfg.level > 0) ? 1 : 0;
+#endif
+
+    cfg.chunk_samples = std::max(cfg.chunk_samples, (size_t) 1);
+    cfg.shard_chunks  = std::max(cfg.shard_chunks, (size_t) 1);
+    pending.reserve(cfg.chunk_samples);
+    raw.resize(cfg.chunk_samples * SAMPLE_BYTES);
+#ifdef BSHIP_ZLIB
+    packed.resize(compressBound(raw.size()));
+#endif
+}
+
+
+shard_writer::~shard_writer(){ close(); }
+
+
+void shard_writer::add(const train_sample& s){
+    pending.push_back(s);
+    if(pending.size() == cfg.chunk_samples) flush();
+}
+
+
+bool shard_writer::close(){
+    if(!pending.empty()) flush();
+    if(file != nullptr){
+        if(std::fclose(file) != 0) failed = true;
+        file = nullptr;
+    }
+    return !failed;
+}
+
+
+void shard_writer::report(selfplay_report& r) const {
+    r.samples      = samples;
+    r.chunks       = chunks;
+    r.shards       = shards;
+    r.raw_bytes    = raw_bytes;
+    r.stored_bytes = stored;
+    r.ok           = !failed;
+}
+
+
+std::string shard_writer::shard_name(const std::string& prefix, uint64_t i){
+    char num[24];
+    std::snprintf(num, sizeof(num), "-%05llu.bss", (unsigned long long) i);
+    return prefix + num;
+}
+
+
+void shard_writer::flush(){
+    // field by field
+    uint8_t *p = raw.data();
+    p = put_field<uint64_t>(p, pending, [](const train_sample& s){ return s.hits.w[0]; });
+    p = put_field<uint64_t>(p, pending, [](const train_sample& s){ return s.hits.w[1]; });
+    p = put_field<uint64_t>(p, pending, [](const train_sample& s){ return s.misses.w[0]; });
+    p = put_field<uint64_t>(p, pending, [](const train_sample& s){ return s.misses.w[1]; });
+    p = put_field<uint64_t>(p, pending, [](const train_sample& s){ return s.sunk.w[0]; });
+    p = put_field<uint64_t>(p, pending, [](const train_sample& s){ return s.sunk.w[1]; });
+    p = put_field<uint32_t>(p, pending, [](const train_sample& s){ return s.game; });
+    p = put_field<uint16_t>(p, pending, [](const train_sample& s){ return s.move; });
+    p = put_field<uint8_t>(p, pending, [](const train_sample& s){ return s.cell; });
+    p = put_field<uint8_t>(p, pending, [](const train_sample& s){ return s.flags; });
+
+    shard_chunk ch;
+    ch.n_samples   = pending.size();
+    ch.raw_size    = p - raw.data();
+    ch.stored_size = ch.raw_size;
+    const uint8_t *data = raw.data();
+
+#ifdef BSHIP_ZLIB
+    if(header.codec == 1){
+        uLongf len = packed.size();
+        if(compress2(packed.data(), &len, raw.data(), ch.raw_size, cfg.level) == Z_OK){
+            ch.stored_size = len;
+            data = packed.data();
+        }
+        else{
+            failed = true;
+        }
+    }
+#endif
+
+    if(file == nullptr){
+        file = std::fopen(shard_name(cfg.prefix, shards).c_str(), "wb");
+        if(file == nullptr){
+            failed = true;
+            pending.clear();
+            return;
+        }
+        ++shards;
+        if(std::fwrite(&header, sizeof(header), 1, file) != 1) failed = true;
+        stored += sizeof(header);
+    }
+
+    if(std::fwrite(&ch, sizeof(ch), 1, file) != 1 || std::fwrite(data, 1, ch.stored_size, file) != ch.stored_size)
+        failed = true;
+    stored    += sizeof(ch) + ch.stored_size;
+    raw_bytes += ch.raw_size;
+    samples   += ch.n_samples;
+    ++chunks;
+    pending.clear();
+
+    if(++in_shard == cfg.shard_chunks){
+        if(std::fclose(file) != 0) failed = true;
+        file = nullptr;
+        in_shard = 0;
+    }
+}
+
+
+
+shard_reader::shard_reader()
+:   file(nullptr),
+    error(false)
+{
+    std::memset(&header, 0, sizeof(header));
+}
+
+
+shard_reader::~shard_reader(){ close(); }
+
+
+bool shard_reader::open(const std::string& path){
+    close();
+    error = false;
+
+    file = std::fopen(path.c_str(), "rb");
+    if(file == nullptr) return false;
+
+    if(std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, "BSSP", 4) != 0
+       || header.version != 1){
+        close();
+        return false;
+    }
+    return true;
+}
+
+
+bool shard_reader::next(std::vector<train_sample>& out){
+    out.clear();
+    if(file == nullptr) return false;
+
+    shard_chunk ch;
+    if(std::fread(&ch, sizeof(ch), 1, file) != 1) return false;
+
+    if(ch.raw_size != (uint64_t) ch.n_samples * SAMPLE_BYTES){
+        error = true;
+        return false;
+    }
+    packed.resize(ch.stored_size);
+    raw.resize(ch.raw_size);
+    if(std::fread(packed.data(), 1, ch.stored_size, file) != ch.stored_size){
+        error = true;
+        return false;
+    }
+
+    if(header.codec == 0 && ch.stored_size == ch.raw_size){
+        raw.swap(packed);
+    }
+#ifdef BSHIP_ZLIB
+    else if(header.codec == 1){
+        uLongf len = raw.size();
+        if(uncompress(raw.data(), &len, packed.data(), ch.stored_size) != Z_OK || len != ch.raw_size){
+            error = true;
+            return false;
+        }
+    }
+#endif
+    else{
+        error = true;
+        return false;
+    }
+
+    out.resize(ch.n_samples);
+    const uint8_t *p = raw.data();
+    p = get_field<uint64_t>(p, out, [](train_sample& s, uint64_t x){ s.hits.w[0] = x; });
+    p = get_field<uint64_t>(p, out, [](train_sample& s, uint64_t x){ s.hits.w[1] = x; });
+    p = get_field<uint64_t>(p, out, [](train_sample& s, uint64_t x){ s.misses.w[0] = x; });
+    p = get_field<uint64_t>(p, out, [](train_sample& s, uint64_t x){ s.misses.w[1] = x; });
+    p = get_field<uint64_t>(p, out, [](train_sample& s, uint64_t x){ s.sunk.w[0] = x; });
+    p = get_field<uint64_t>(p, out, [](train_sample& s, uint64_t x){ s.sunk.w[1] = x; });
+    p = get_field<uint32_t>(p, out, [](train_sample& s, uint32_t x){ s.game = x; });
+    p = get_field<uint16_t>(p, out, [](train_sample& s, uint16_t x){ s.move = x; });
+    p = get_field<uint8_t>(p, out, [](train_sample& s, uint8_t x){ s.cell = x; });
+    p = get_field<uint8_t>(p, out, [](train_sample& s, uint8_t x){ s.flags = x; });
+    return true;
+}
+
+
+bool shard_reader::failed() const { return error; }
+
+
+size_t shard_reader::get_width() const { return header.width; }
+
+
+size_t shard_reader::get_height() const { return header.height; }
+
+
+void shard_reader::close(){
+    if(file != nullptr) std::fclose(file);
+    file = nullptr;
+}
+
+
+
+selfplay_report selfplay_pipeline::run(const bot_factory& make_a, const bot_factory& make_b, const selfplay_config& config){
+    selfplay_report rep;
+    auto start = std::chrono::steady_clock::now();
+
+    bounded_queue<train_sample> queue(config.queue_capacity);
+    std::atomic<uint64_t> next(0);
+    std::atomic<int> running(std::max(config.threads, 1));
+
+    // every worker plays all its games in one game slot, reset between the games
+    auto worker = [&](){
+        battleship game(10, 10, OM_SILENT);
+        std::unique_ptr<bs_player> pa(make_a("A")), pb(make_b("B"));
+        connect(&game, pa.get(), pb.get());
+        sample_recorder rec(queue);
+        game.add_listener(&rec);
+
+        for(uint64_t g; (g = next++) < config.games; ){
+            rec.set_game(g);
+            game.reset();
+            game.start();
+        }
+        game.remove_listener(&rec);
+        running.fetch_sub(1, std::memory_order_release);
+    };
+
+    // the writer drains the queue until the workers are done and it is empty
+    auto writer = [&](){
+        shard_writer w(config, 10, 10);
+        train_sample s;
+        for(int idle=0; ; ){
+            if(queue.try_pop(s)){
+                w.add(s);
+                idle = 0;
+            }
+            else if(running.load(std::memory_order_acquire) == 0){
+                if(!queue.try_pop(s)) break;
+                w.add(s);
+            }
+            else if(++idle < 64){
+                std::this_thread::yield();
+            }
+            else{
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+        w.close();
+        w.report(rep);
+    };
+
+    std::thread wt(writer);
+    std::vector<std::thread> workers;
+    for(int t=0; t<std::max(config.threads, 1); ++t) workers.emplace_back(worker);
+    for(auto& t : workers) t.join();
+    wt.join();
+
+    rep.games   = std::min(next.load(), config.games);
+    rep.stalls  = queue.get_stalls();
+    rep.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return rep;
+}
+
+
+}
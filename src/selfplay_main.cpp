@@ -0,0 +1,60 @@
+/*!
+    Plays games between two bots on several threads and writes every move
+    as a training sample into compressed shards (see selfplay.h)
+
+    usage: bship_selfplay <games> <threads> <bot A> <bot B> <shard prefix> [level]
+
+    bots: random, slick[:difficulty], prob, model[:prior dir], hide[:parity|uniform]
+*/
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "bot_factory.h"
+#include "bs_player.h"
+#include "selfplay.h"
+
+using namespace bship;
+using namespace std;
+
+
+int main(int argc, char **argv){
+    if(argc < 6){
+        cerr << "usage: " << argv[0] << " <games> <threads> <bot A> <bot B> <shard prefix> [level]" << endl;
+        cerr << "bots: " << BOT_SPECS << endl;
+        return 1;
+    }
+    srand(time(NULL));
+
+    selfplay_config cfg;
+    cfg.games   = strtoull(argv[1], nullptr, 10);
+    cfg.threads = max(1, atoi(argv[2]));
+    cfg.prefix  = argv[5];
+    if(argc > 6) cfg.level = atoi(argv[6]);
+    string spec_a = argv[3], spec_b = argv[4];
+
+    unique_ptr<bs_player> check_a(make_bot(spec_a, "A")), check_b(make_bot(spec_b, "B"));
+    if(!check_a || !check_b){
+        cerr << "unknown bot" << endl;
+        return 1;
+    }
+
+    selfplay_report rep = selfplay_pipeline::run([&spec_a](const string& name){ return make_bot(spec_a, name); },
+                                                 [&spec_b](const string& name){ return make_bot(spec_b, name); },
+                                                 cfg);
+
+    cout << rep.games << " games, " << rep.samples << " samples in " << rep.shards << " shards ("
+         << rep.chunks << " chunks)" << endl;
+    cout << "bytes: " << rep.raw_bytes << " raw, " << rep.stored_bytes << " written ("
+         << rep.stored_bytes * 100.0 / max(rep.raw_bytes, (uint64_t) 1) << "%)" << endl;
+    cout << "samples per second: " << rep.samples / max(rep.seconds, 1e-9)
+         << ", producer stalls: " << rep.stalls << endl;
+
+    if(!rep.ok){
+        cerr << "can't write the shards to " << cfg.prefix << "-*" << endl;
+        return 1;
+    }
+    return 0;
+}
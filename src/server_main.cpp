@@ -0,0 +1,52 @@
+/*!
+    Battleship game server (see game_server)
+
+    usage: bship_server <socket path> [tcp port]
+*/
+
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include "game_server.h"
+
+using namespace bship;
+using namespace std;
+
+
+static game_server *server = nullptr;
+
+
+static void on_signal(int){
+    if(server) server->stop();
+}
+
+
+int main(int argc, char **argv){
+    if(argc < 2){
+        cerr << "usage: " << argv[0] << " <socket path> [tcp port]" << endl;
+        return 1;
+    }
+    srand(time(NULL));
+
+    try{
+        game_server srv(argv[1]);
+        if(argc > 2) cout << "listening on 127.0.0.1:" << srv.listen_tcp(atoi(argv[2])) << endl;
+        cout << "listening on " << argv[1] << endl;
+
+        server = &srv;
+        signal(SIGINT, on_signal);
+        signal(SIGTERM, on_signal);
+
+        srv.run();
+
+        server = nullptr;
+        cout << srv.num_games_played() << " games played" << endl;
+    }
+    catch(protocol_exception& e){
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*!
+    Plays many games between two bots on several threads and reports
+    the results, the outcome statistics (see outcome_stats.h) and the engine
+    metrics (see metrics.h)
+
+    usage: bship_sim <games> <threads> <bot A> <bot B> [text|json] [trace file]
+
+    bots: random, slick[:difficulty], prob, model[:prior dir], hide[:parity|uniform]
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "battleship.h"
+#include "bot_factory.h"
+#include "metrics.h"
+#include "model_player.h"
+#include "outcome_stats.h"
+#include "trace.h"
+
+using namespace bship;
+using namespace std;
+
+
+int main(int argc, char **argv){
+    if(argc < 5){
+        cerr << "usage: " << argv[0] << " <games> <threads> <bot A> <bot B> [text|json] [trace file]" << endl;
+        cerr << "bots: " << BOT_SPECS << endl;
+        return 1;
+    }
+    srand(time(NULL));
+
+    int games = atoi(argv[1]);
+    int n_threads = max(1, atoi(argv[2]));
+    string spec_a = argv[3], spec_b = argv[4];
+    bool json = (argc > 5 && string(argv[5]) == "json");
+
+    // the bots are named after their specs, which is what model finds its opponent's prior by
+    string name_a = spec_a, name_b = (spec_b == spec_a) ? spec_b + "'" : spec_b;
+    unique_ptr<bs_player> check_a(make_bot(spec_a, name_a)), check_b(make_bot(spec_b, name_b));
+    if(!check_a || !check_b){
+        cerr << "unknown bot" << endl;
+        return 1;
+    }
+
+    if(argc > 6 && !tracer::start(argv[6])){
+        cerr << "can't write the trace to " << argv[6] << endl;
+        return 1;
+    }
+
+    atomic<int> next(0), wins_a(0);
+    atomic<bool> no_prior_a(false), no_prior_b(false);
+    atomic<long> shots(0);
+    string pairing = spec_a + " vs " + spec_b;
+
+    // every thread records the outcomes on its own, merged after the join
+    vector<outcome_stats> thread_stats(n_threads);
+
+    // every thread plays all its games in one game slot, reset between the
+    // games, so that the allocator is out of the loop
+    auto worker = [&](int t){
+        battleship game(10, 10, OM_SILENT);
+        unique_ptr<bs_player> pa(make_bot(spec_a, name_a)), pb(make_bot(spec_b, name_b));
+        connect(&game, pa.get(), pb.get());
+        outcome_recorder rec(thread_stats[t], pairing);
+        game.add_listener(&rec);
+
+        while(next++ < games){
+            game.reset();
+            game.start();
+            if(game.get_winner() == pa.get()) ++wins_a;
+            shots += game.get_total_shots();
+        }
+        game.remove_listener(&rec);
+
+        // a bot keeping opponent priors plays on without one it can not open
+        model_player *ma = dynamic_cast<model_player*>(pa.get()), *mb = dynamic_cast<model_player*>(pb.get());
+        if(ma && !ma->prior_ok()) no_prior_a = true;
+        if(mb && !mb->prior_ok()) no_prior_b = true;
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for(int t=0; t<n_threads; ++t) threads.emplace_back(worker, t);
+    for(auto& t : threads) t.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    tracer::stop();
+    if(no_prior_a) cerr << "can't open the placement prior of " << spec_a << ", played without it" << endl;
+    if(no_prior_b) cerr << "can't open the placement prior of " << spec_b << ", played without it" << endl;
+
+    outcome_stats outcomes;
+    for(auto& st : thread_stats) outcomes.merge(st);
+    metrics_snapshot m = metrics::snapshot();
+
+    if(json){
+        cout << "{\"games\": " << games << ", \"threads\": " << n_threads
+             << ", \"wins_a\": " << wins_a << ", \"wins_b\": " << games - wins_a
+             << ", \"shots\": " << shots << ", \"seconds\": " << secs
+             << ", \"outcomes\": " << outcomes.to_json()
+             << ", \"metrics\": " << m.to_json() << "}" << endl;
+    }
+    else{
+        cout << spec_a << " (A) won " << wins_a << "/" << games << " games against " << spec_b << " (B)" << endl;
+        cout << "average shots per game: " << (double) shots / max(games, 1) << endl;
+        cout << "games per second: " << games / max(secs, 1e-9) << " (" << n_threads << " threads)" << endl;
+        cout << outcomes.to_text();
+        cout << m.to_text();
+    }
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <numeric>
+#include "sliced_engine.h"
+
+namespace bship{
+
+
+sliced_engine::sliced_engine(size_t width_, size_t height_, const std::map<ship_type, uint8_t>& fleet,
+                             sampler_mode mode, uint64_t seed)
+:   width(width_),
+    height(height_),
+    cells(width_ * height_),
+    n_cells(0),
+    sampler(width_, height_, fleet, mode, seed),
+    rng(seed),
+    state(seed ^ 0x5DEECE66Dull)
+{
+    // same order as the layouts of the sampler
+    for(auto& tp : fleet)
+        for(int i=0; i<tp.second; ++i) ships.push_back(tp.first);
+    std::sort(ships.begin(), ships.end(), [](ship_type a, ship_type b){ return a > b; });
+    for(ship_type t : ships){
+        if(t > 7) throw illegal_move_exception("Ship too long for sliced_engine");
+        n_cells += t;
+    }
+
+    for(side& s : sides){
+        s.ship.resize(ships.size() * cells);
+        s.hits.resize(cells);
+    }
+    counter.resize(3 * ships.size());
+    for(int k=0; k<2; ++k){
+        fleets[k].resize(LANES * ships.size());
+        orders[k].resize(cells);
+    }
+
+    by_colour.resize(cells);
+    std::iota(by_colour.begin(), by_colour.end(), 0);
+    n_even = std::stable_partition(by_colour.begin(), by_colour.end(), [this](uint8_t i){ return (i / width + i % width) % 2 == 0; })
+           - by_colour.begin();
+}
+
+
+sliced_engine::sliced_engine(const bs_grid& grid, sampler_mode mode, uint64_t seed)
+:   sliced_engine(grid.get_width(), grid.get_height(), grid.get_max_n_ships(), mode, seed)
+{}
+
+
+size_t sliced_engine::get_n_ships() const { return ships.size(); }
+
+
+size_t sliced_engine::get_width() const { return width; }
+
+
+size_t sliced_engine::get_height() const { return height; }
+
+
+void sliced_engine::draw_order(sliced_policy pol, uint8_t *order){
+    if(pol == SP_HUNT_TARGET) throw illegal_move_exception("Hunt/target reacts to hits, sliced_engine can not play it");
+
+    std::iota(order, order + cells, 0);
+    if(pol == SP_RANDOM){
+        std::shuffle(order, order + cells, rng);
+        return;
+    }
+
+    // one colour of the checkerboard first: every ship of 2 cells or more covers one of them
+    uint8_t *mid = std::stable_partition(order, order + cells, [this](uint8_t i){ return (i / width + i % width) % 2 == 0; });
+    std::shuffle(order, mid, rng);
+    std::shuffle(mid, order + cells, rng);
+}
+
+
+void sliced_engine::load(side& s, const ship_placement *fleet){
+    std::fill(s.ship.begin(), s.ship.end(), 0);
+    size_t n = ships.size();
+
+    for(int g=0; g<LANES; ++g){
+        for(size_t k=0; k<n; ++k){
+            const ship_placement& p = fleet[g * n + k];
+            size_t step = (p.orient == SO_HOR) ? 1 : width;
+            uint64_t *w = s.ship.data() + k * cells + p.row * width + p.col;
+            for(int i=0; i<p.type; ++i, w += step) *w |= 1ull << g;
+        }
+    }
+}
+
+
+void sliced_engine::load_permuted(side& s, const ship_placement *fleet, sliced_policy pol){
+    std::fill(s.ship.begin(), s.ship.end(), 0);
+    size_t n = ships.size();
+
+    for(int g=0; g<LANES; ++g){
+        uint64_t used[2] = {0, 0};
+        for(size_t k=0; k<n; ++k){
+            const ship_placement& p = fleet[g * n + k];
+            size_t step = (p.orient == SO_HOR) ? 1 : width;
+            size_t c = p.row * width + p.col;
+            for(int i=0; i<p.type; ++i, c += step){
+                // a cell not taken yet, among all the cells or those of the colour of c
+                size_t from = 0, count = cells;
+                if(pol == SP_PARITY){
+                    bool even = (c / width + c % width) % 2 == 0;
+                    from  = (even) ? 0 : n_even;
+                    count = (even) ? n_even : cells - n_even;
+                }
+                size_t to;
+                do to = by_colour[from + (((next() >> 32) * count) >> 32)];
+                while((used[to >> 6] >> (to & 63)) & 1);
+                used[to >> 6] |= 1ull << (to & 63);
+                s.ship[k * cells + to] |= 1ull << g;
+            }
+        }
+    }
+}
+
+
+void sliced_engine::shoot(side& s, const uint8_t *order){
+    size_t n = ships.size();
+
+    // every game starts with the full length of every ship
+    for(size_t k=0; k<n; ++k)
+        for(int i=0; i<3; ++i) counter[3*k + i] = ((ships[k] >> i) & 1) ? ~0ull : 0;
+
+    std::fill(s.finish, s.finish + LANES, 0);
+    std::fill(s.first_hit, s.first_hit + LANES, 0);
+    std::fill(s.first_sink, s.first_sink + LANES, 0);
+    std::fill(s.hits.begin(), s.hits.end(), 0);
+
+    uint64_t done = 0, had_hit = 0, had_sink = 0;
+    for(size_t t=0; t<cells && done != ~0ull; ++t){
+        const uint64_t *ship = s.ship.data() + order[t];
+        uint64_t hit = 0, sunk = 0, all_sunk = ~0ull;
+
+        for(size_t k=0; k<n; ++k, ship += cells){
+            uint64_t *c = counter.data() + 3*k;
+
+            // decrements the counter of the games hitting ship k (sliced subtraction of 1)
+            uint64_t borrow = *ship;
+            for(int i=0; i<3; ++i){
+                uint64_t ci = c[i];
+                c[i] = ci ^ borrow;
+                borrow &= ~ci;
+            }
+
+            uint64_t zero = ~(c[0] | c[1] | c[2]);
+            hit      |= *ship;
+            sunk     |= *ship & zero;
+            all_sunk &= zero;
+        }
+        s.hits[t] = hit;
+
+        // the step of the first event of every game
+        int step = t + 1;
+        for(uint64_t m = hit & ~had_hit; m; m &= m - 1) s.first_hit[__builtin_ctzll(m)] = step;
+        for(uint64_t m = sunk & ~had_sink; m; m &= m - 1) s.first_sink[__builtin_ctzll(m)] = step;
+        for(uint64_t m = all_sunk & ~done; m; m &= m - 1) s.finish[__builtin_ctzll(m)] = step;
+        had_hit  |= hit;
+        had_sink |= sunk;
+        done     |= all_sunk;
+    }
+}
+
+
+int sliced_engine::shots_to_miss(const side& s, int g, int n) const {
+    if(n <= 0) return 0;
+    for(size_t t=0; t<cells; ++t)
+        if(!((s.hits[t] >> g) & 1) && --n == 0) return t + 1;
+    return cells;
+}
+
+
+void sliced_engine::play(const ship_placement *fleet_a, const ship_placement *fleet_b,
+                         const uint8_t *order_a, const uint8_t *order_b, game_outcome *out){
+    load(sides[0], fleet_b);
+    load(sides[1], fleet_a);
+    finish(order_a, order_b, out);
+}
+
+
+void sliced_engine::finish(const uint8_t *order_a, const uint8_t *order_b, game_outcome *out){
+    shoot(sides[0], order_a);
+    shoot(sides[1], order_b);
+
+    for(int g=0; g<LANES; ++g){
+        // a side finishing after m misses does it in its turn m + 1, A's turns come first
+        int miss_a = sides[0].finish[g] - n_cells;
+        int miss_b = sides[1].finish[g] - n_cells;
+
+        game_outcome& o = out[g];
+        o.pa_won = miss_a <= miss_b;
+        if(o.pa_won){
+            o.shots[0] = sides[0].finish[g];
+            o.shots[1] = shots_to_miss(sides[1], g, miss_a);
+        }
+        else{
+            o.shots[0] = shots_to_miss(sides[0], g, miss_b + 1);
+            o.shots[1] = sides[1].finish[g];
+        }
+
+        // events after the end of the game did not happen
+        for(int k=0; k<2; ++k){
+            o.first_hit[k]  = (sides[k].first_hit[g] <= o.shots[k]) ? sides[k].first_hit[g] : 0;
+            o.first_sink[k] = (sides[k].first_sink[g] <= o.shots[k]) ? sides[k].first_sink[g] : 0;
+        }
+    }
+}
+
+
+void sliced_engine::play(sliced_policy pol_a, sliced_policy pol_b, game_outcome *out){
+    size_t n = ships.size();
+    for(int k=0; k<2; ++k)
+        for(int g=0; g<LANES; ++g) sampler.sample(fleets[k].data() + g * n);
+    draw_order(pol_a, orders[0].data());
+    draw_order(pol_b, orders[1].data());
+
+    // every game gets an order of its own, through its own permutation of the cells
+    load_permuted(sides[0], fleets[1].data(), pol_a);
+    load_permuted(sides[1], fleets[0].data(), pol_b);
+    finish(orders[0].data(), orders[1].data(), out);
+}
+
+
+}
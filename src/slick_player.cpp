@@ -32,18 +32,11 @@ void slick_player::move(){
     bool valid_move = false;
     unsigned long tries = 0;
     float prob;
-    
-    if(stype.size() == 0){
-        // add possible ship types to array
-        for(auto& p : hidden_grid->get_max_n_ships()){
-            for(int i=0; i<p.second; ++i)
-                stype.push_back(p.first);
-        }
-    }
     ship_orientation ori;
 
     if(!hidden_grid->is_ready()){
         // placement
+        ship_type type = next_ship();
 
         while(!valid_move){
             ++tries;            
@@ -51,12 +44,15 @@ void slick_player::move(){
             c = rand() % hit_grid->get_width();
             ori = (rand() % 2) ? SO_HOR : SO_VERT;
 
+            // placements that do not fit are skipped without going through the game
+            if(!hidden_grid->can_place_ship(type, r, c, ori)) continue;
+
             try{
-                valid_move = game->place_ship(stype[sindex], r, c, ori);
-                if(valid_move) ++sindex;
+                valid_move = game->place_ship(type, r, c, ori);
             }
             catch(illegal_move_exception& e){}
         }
+        BS_COUNT_N(MC_RETRIES, tries - 1);
     }
     else{
         // shooting
@@ -64,6 +60,7 @@ void slick_player::move(){
         prob = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
         if(prob < peek_prob){
             // guaranteed hit
+            BS_COUNT(MC_PEEKS);
             bs_grid *opponent_grid = (game->pa_turn) ? &(game->pb_hidden_grid) : &(game->pa_hidden_grid);
             size_t i=0, j=0;
 
@@ -82,12 +79,16 @@ void slick_player::move(){
             r = rand() % hit_grid->get_height();
             c = rand() % hit_grid->get_width();
 
+            // cells shot before are skipped without throwing
+            if(!hit_grid->cell_at(r, c).can_shoot()) continue;
+
             try{
                 sr = game->shoot_at(r, c);
                 valid_move = true;
             }
             catch(illegal_move_exception& e){}
         }
+        BS_COUNT_N(MC_RETRIES, tries - 1);
     }
 
 }
@@ -0,0 +1,176 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace bship{
+
+
+std::atomic<bool> tracer::on(false);
+
+
+namespace{
+
+    /// Recorded span
+    struct trace_event{
+        const char                              *name;   ///< span name
+        const char                              *cat;    ///< span category
+        std::chrono::steady_clock::time_point    begin;  ///< start time
+        std::chrono::steady_clock::duration      dur;    ///< duration
+    };
+
+
+    /// Spans of one thread
+    struct thread_trace{
+        std::mutex                  mtx;     ///< guards events (only contended on stop())
+        std::vector<trace_event>    events;  ///< spans not written yet
+        unsigned                    tid;     ///< thread id in the trace
+    };
+
+
+    /// Trace file and the buffers of all threads
+    struct trace_registry{
+        std::mutex                               mtx;       ///< guards everything below
+        std::FILE                               *file;      ///< trace file (nullptr when off)
+        bool                                     first;     ///< no event written yet
+        size_t                                   written;   ///< events written
+        size_t                                   flush_at;  ///< flush threshold
+        std::chrono::steady_clock::time_point    origin;    ///< time 0 of the trace
+        std::vector<thread_trace*>               live;      ///< running threads
+        unsigned                                 next_tid;  ///< id of the next thread
+
+        trace_registry() : file(nullptr), first(true), written(0), flush_at(8192), next_tid(1) {}
+    };
+
+
+    // never destroyed, threads may finish during static destruction
+    trace_registry& get_registry(){
+        static trace_registry *reg = new trace_registry();
+        return *reg;
+    }
+
+
+    /// Writes spans to the trace file, with the registry locked
+    void write_events(trace_registry& reg, unsigned tid, const std::vector<trace_event>& events){
+        if(reg.file == nullptr) return;
+
+        std::string out;
+        out.reserve(events.size() * 96);
+        char buf[256];
+        for(const trace_event& e : events){
+            double ts  = std::chrono::duration<double, std::micro>(e.begin - reg.origin).count();
+            double dur = std::chrono::duration<double, std::micro>(e.dur).count();
+            int n = std::snprintf(buf, sizeof(buf),
+                "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                (reg.first) ? "\n" : ",\n", e.name, e.cat, ts, dur, tid);
+            out.append(buf, std::min(n, (int) sizeof(buf) - 1));
+            reg.first = false;
+        }
+        std::fwrite(out.data(), 1, out.size(), reg.file);
+        reg.written += events.size();
+    }
+
+
+    /// Registers the buffer of a thread, writes what is left on exit
+    struct trace_slot{
+        thread_trace *tt;
+
+        trace_slot() : tt(new thread_trace()) {
+            trace_registry& reg = get_registry();
+            std::lock_guard<std::mutex> lock(reg.mtx);
+            tt->tid = reg.next_tid++;
+            reg.live.push_back(tt);
+        }
+
+        ~trace_slot(){
+            trace_registry& reg = get_registry();
+            std::lock_guard<std::mutex> lock(reg.mtx);
+            write_events(reg, tt->tid, tt->events);
+            reg.live.erase(std::find(reg.live.begin(), reg.live.end(), tt));
+            delete tt;
+        }
+    };
+
+
+    thread_trace& local(){
+        static thread_local trace_slot slot;
+        return *slot.tt;
+    }
+
+}
+
+
+bool tracer::start(const std::string& path, size_t flush_events){
+    trace_registry& reg = get_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    if(reg.file != nullptr) return false;
+
+    reg.file = std::fopen(path.c_str(), "w");
+    if(reg.file == nullptr) return false;
+
+    // spans recorded after the previous stop() are dropped
+    for(thread_trace *tt : reg.live){
+        std::lock_guard<std::mutex> tlock(tt->mtx);
+        tt->events.clear();
+    }
+
+    std::fputs("[", reg.file);
+    reg.first    = true;
+    reg.written  = 0;
+    reg.flush_at = std::max(flush_events, (size_t) 1);
+    reg.origin   = std::chrono::steady_clock::now();
+    on.store(true);
+    return true;
+}
+
+
+void tracer::stop(){
+    trace_registry& reg = get_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    if(reg.file == nullptr) return;
+    on.store(false);
+
+    for(thread_trace *tt : reg.live){
+        std::lock_guard<std::mutex> tlock(tt->mtx);
+        write_events(reg, tt->tid, tt->events);
+        tt->events.clear();
+    }
+
+    std::fputs("\n]\n", reg.file);
+    std::fclose(reg.file);
+    reg.file = nullptr;
+}
+
+
+void tracer::complete(const char *name, const char *cat,
+                      std::chrono::steady_clock::time_point begin,
+                      std::chrono::steady_clock::time_point end){
+    if(!enabled()) return;
+
+    thread_trace& tt = local();
+    std::unique_lock<std::mutex> tlock(tt.mtx);
+    tt.events.push_back(trace_event{name, cat, begin, end - begin});
+
+    trace_registry& reg = get_registry();
+    if(tt.events.size() < reg.flush_at) return;
+
+    // written without holding the thread's lock (stop() takes the locks in the other order)
+    std::vector<trace_event> full;
+    full.swap(tt.events);
+    tt.events.reserve(full.size());
+    tlock.unlock();
+
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    write_events(reg, tt.tid, full);
+}
+
+
+size_t tracer::num_events(){
+    trace_registry& reg = get_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    return reg.written;
+}
+
+
+}
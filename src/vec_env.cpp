@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cstring>
+#include "vec_env.h"
+
+namespace bship{
+
+
+/// splitmix64 finalizer, turns consecutive numbers into unrelated seeds
+static inline uint64_t mix_seed(uint64_t z){
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+
+
+vec_env::vec_env(size_t n_envs, size_t width_, size_t height_, int n_threads, uint64_t seed, const env_rewards& rewards)
+:   width(width_),
+    height(height_),
+    cells(width_ * height_),
+    obs_size(PL_COUNT * width_ * height_),
+    rew(rewards),
+    max_steps((rewards.max_steps > 0) ? rewards.max_steps : 2 * width_ * height_),
+    planes(n_envs * PL_COUNT * width_ * height_, 0.0f),
+    in_actions(nullptr),
+    out_obs(nullptr),
+    out_rewards(nullptr),
+    out_dones(nullptr),
+    generation(0),
+    pending(0),
+    stopping(false)
+{
+    if(n_envs == 0){
+        throw index_exception(n_envs, 1, "Invalid number of environments:");
+    }
+
+    envs.reserve(n_envs);
+    for(size_t i=0; i<n_envs; ++i){
+        envs.emplace_back(width, height);
+        envs.back().seed = mix_seed(seed + 0x9E3779B97F4A7C15ull * (i + 1));
+    }
+
+    // contiguous slices of (almost) the same size
+    size_t n_slices = std::min(n_envs, (size_t) std::max(n_threads, 1));
+    slices.reserve(n_slices);
+    for(size_t t=0; t<n_slices; ++t)
+        slices.emplace_back(n_envs * t / n_slices, n_envs * (t + 1) / n_slices, envs[0].grid);
+
+    reset(nullptr);
+
+    for(size_t t=1; t<n_slices; ++t) workers.emplace_back(&vec_env::worker, this, t - 1);
+}
+
+
+vec_env::~vec_env(){
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    go.notify_all();
+    for(auto& t : workers) t.join();
+}
+
+
+void vec_env::reset(float *obs){
+    for(auto& s : slices)
+        for(size_t i=s.begin; i<s.end; ++i) reset_env(i, s.sampler);
+
+    if(obs) std::memcpy(obs, planes.data(), planes.size() * sizeof(float));
+}
+
+
+void vec_env::step(const int32_t *actions, float *obs, float *rewards, uint8_t *dones){
+    in_actions  = actions;
+    out_obs     = obs;
+    out_rewards = rewards;
+    out_dones   = dones;
+
+    if(workers.empty()){
+        step_slice(slices[0]);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++generation;
+        pending = workers.size();
+    }
+    go.notify_all();
+
+    // the caller steps the first slice meanwhile
+    step_slice(slices[0]);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    done.wait(lock, [this]{ return pending == 0; });
+}
+
+
+size_t vec_env::get_n_envs() const { return envs.size(); }
+
+
+size_t vec_env::get_obs_size() const { return obs_size; }
+
+
+size_t vec_env::get_width() const { return width; }
+
+
+size_t vec_env::get_height() const { return height; }
+
+
+int vec_env::get_last_length(size_t i) const { return envs.at(i).last; }
+
+
+void vec_env::reset_env(size_t i, fleet_sampler& sampler){
+    env& e = envs[i];
+
+    e.grid.reset();
+    sampler.seed(mix_seed(e.seed + e.episode++));
+    sampler.place(e.grid);
+    e.steps = 0;
+
+    std::fill(planes.begin() + i * obs_size, planes.begin() + (i + 1) * obs_size, 0.0f);
+}
+
+
+void vec_env::step_slice(slice& s){
+    for(size_t i=s.begin; i<s.end; ++i){
+        env& e = envs[i];
+        float *obs = planes.data() + i * obs_size;
+        int32_t a = in_actions[i];
+        float r;
+        bool over = false;
+
+        ++e.steps;
+        if(a < 0 || (size_t) a >= cells || !e.grid.cell_at(a / width, a % width).can_shoot()){
+            r = rew.illegal;
+        }
+        else{
+            std::pair<shot_result, int> res = e.grid.shoot_at(a / width, a % width);
+
+            if(res.first == SR_MISS){
+                obs[PL_MISS * cells + a] = 1.0f;
+                r = rew.miss;
+            }
+            else{
+                obs[PL_HIT * cells + a] = 1.0f;
+                r = rew.hit;
+
+                if(res.first == SR_SINK){
+                    // a sink is rare enough to look for the cells of the ship
+                    for(size_t c=0; c<cells; ++c)
+                        if(e.grid.cell_at(c / width, c % width).ship_id == res.second) obs[PL_SUNK * cells + c] = 1.0f;
+
+                    over = e.grid.get_num_alive_ships() == 0;
+                    r = (over) ? rew.win : rew.sink;
+                }
+            }
+        }
+
+        if(!over && e.steps >= max_steps) over = true;
+        if(over){
+            e.last = e.steps;
+            reset_env(i, s.sampler);
+        }
+
+        if(out_rewards) out_rewards[i] = r;
+        if(out_dones) out_dones[i] = over;
+    }
+
+    if(out_obs){
+        std::memcpy(out_obs + s.begin * obs_size, planes.data() + s.begin * obs_size,
+                    (s.end - s.begin) * obs_size * sizeof(float));
+    }
+}
+
+
+void vec_env::worker(size_t t){
+    uint64_t seen = 0;
+
+    for(;;){
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            go.wait(lock, [&]{ return stopping || generation != seen; });
+            if(stopping) return;
+            seen = generation;
+        }
+
+        step_slice(slices[t + 1]);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            last = --pending == 0;
+        }
+        if(last) done.notify_one();
+    }
+}
+
+
+}
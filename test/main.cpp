@@ -2,9 +2,47 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/ui/text/TextTestRunner.h>
 #include "test_bs_grid.hpp"
+#include "test_fleet_counter.hpp"
+#include "test_endgame.hpp"
+#include "test_time_control.hpp"
+#include "test_external_player.hpp"
+#include "test_game_server.hpp"
+#include "test_metrics.hpp"
+#include "test_trace.hpp"
+#include "test_allocations.hpp"
+#include "test_outcome_stats.hpp"
+#include "test_placement_stats.hpp"
+#include "test_fleet_sampler.hpp"
+#include "test_layout_corpus.hpp"
+#include "test_sliced_engine.hpp"
+#include "test_vec_env.hpp"
+#include "test_selfplay.hpp"
+#include "test_model_player.hpp"
+#include "test_layout_optimizer.hpp"
+#include "test_calibration.hpp"
+#include "test_league.hpp"
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION(test_bs_grid);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_fleet_counter);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_endgame);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_time_control);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_external_player);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_game_server);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_metrics);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_trace);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_allocations);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_outcome_stats);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_placement_stats);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_fleet_sampler);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_layout_corpus);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_sliced_engine);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_vec_env);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_selfplay);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_model_player);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_layout_optimizer);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_calibration);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_league);
 
 
 int main(){
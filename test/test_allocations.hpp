@@ -0,0 +1,160 @@
+#ifndef TEST_ALLOCATIONS_HPP
+#define TEST_ALLOCATIONS_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "slick_player.h"
+#include "game_listener.h"
+#include "exceptions.hpp"
+
+
+// heap allocations of the test program (global operator new is replaced below,
+// this header is included once, by main.cpp)
+static std::atomic<long> test_allocs(0);
+
+
+void *operator new(std::size_t sz){
+    test_allocs.fetch_add(1, std::memory_order_relaxed);
+    if(void *p = std::malloc((sz > 0) ? sz : 1)) return p;
+    throw std::bad_alloc();
+}
+
+
+void *operator new[](std::size_t sz){ return operator new(sz); }
+
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+
+
+// counts the allocations of each game phase
+class phase_counter : public bship::game_listener{
+public:
+    long start, placed, over;   // allocation counts at the first move, after the placements, at the end
+    int  n_placed;
+
+    phase_counter() : start(test_allocs), placed(-1), over(-1), n_placed(0) {}
+
+    void on_place(bship::battleship&, bool, bship::ship_type, size_t, size_t, bship::ship_orientation){
+        if(++n_placed == 10) placed = test_allocs;
+    }
+
+    void on_game_over(bship::battleship&, bool){ over = test_allocs; }
+};
+
+
+// counts the ships sunk by each player
+class sink_counter : public bship::game_listener{
+public:
+    int by_a = 0, by_b = 0;
+
+    void on_shot(bship::battleship&, bool by_pa, size_t, size_t, std::pair<bship::shot_result, int> res){
+        if(res.first == bship::SR_SINK) ++((by_pa) ? by_a : by_b);
+    }
+};
+
+
+class test_allocations : public CppUnit::TestCase{
+
+    // plays a game, returns the allocations of the placement and shooting phases
+    template<class PA, class PB>
+    static void play(PA& pa, PB& pb, long& placing, long& shooting){
+        bship::battleship game(10, 10, bship::OM_SILENT);
+        bship::connect(&game, &pa, &pb);
+        phase_counter cnt;
+        game.add_listener(&cnt);
+
+        cnt.start = test_allocs;
+        game.start();
+
+        placing  = cnt.placed - cnt.start;
+        shooting = cnt.over - cnt.placed;
+    }
+
+public:
+
+    test_allocations(){}
+
+
+    // test that no allocation is made after setup
+    void test_game_loop(){
+
+        bship::bs_player a("random a"), b("random b");
+        bship::slick_player s("slick", 0.5);
+        long placing, shooting;
+
+        // the first games set up the (per-thread) metrics
+        play(a, b, placing, shooting);
+        play(s, b, placing, shooting);
+
+        for(int g=0; g<5; ++g){
+            play(a, b, placing, shooting);
+            CPPUNIT_ASSERT_EQUAL(0L, placing);
+            CPPUNIT_ASSERT_EQUAL(0L, shooting);
+
+            play(s, b, placing, shooting);
+            CPPUNIT_ASSERT_EQUAL(0L, placing);
+            CPPUNIT_ASSERT_EQUAL(0L, shooting);
+        }
+
+        // the hook works
+        long before = test_allocs;
+        int *volatile p = new int(0);
+        delete p;
+        CPPUNIT_ASSERT_EQUAL(before + 1, (long) test_allocs);
+
+    }
+
+
+    // test replaying games in the same game without allocating
+    void test_reset(){
+
+        bship::battleship game(10, 10, bship::OM_SILENT);
+        bship::slick_player a("slick", 0.5);
+        bship::bs_player b("random b");
+        bship::connect(&game, &a, &b);
+        sink_counter sinks;
+        game.add_listener(&sinks);
+        game.start();
+
+        for(int g=0; g<10; ++g){
+            sinks.by_a = sinks.by_b = 0;
+            long before = test_allocs;
+            game.reset();
+            CPPUNIT_ASSERT(!game.is_finished());
+            CPPUNIT_ASSERT_EQUAL(0, game.get_total_shots());
+            CPPUNIT_ASSERT(game.get_winner() == nullptr);
+            CPPUNIT_ASSERT(game.get_current_player() == &a);
+
+            game.start();
+            CPPUNIT_ASSERT_EQUAL(before, (long) test_allocs);
+
+            // a whole new game was played
+            CPPUNIT_ASSERT(game.is_finished());
+            CPPUNIT_ASSERT(game.get_total_shots() >= 17);
+            CPPUNIT_ASSERT_EQUAL(5, (game.get_winner() == &a) ? sinks.by_a : sinks.by_b);
+        }
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_allocations);
+    CPPUNIT_TEST(test_game_loop);
+    CPPUNIT_TEST(test_reset);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -8,6 +8,7 @@
 #include <cppunit/TestRunner.h>
 #include <cppunit/extensions/HelperMacros.h>
 #include "bs_grid.h"
+#include "fleet_sampler.h"
 #include "exceptions.hpp"
 
 
@@ -126,7 +127,7 @@ public:
         CPPUNIT_ASSERT_EQUAL(bship::SR_SINK, sr.first);
         CPPUNIT_ASSERT_EQUAL(1, sr.second);
         CPPUNIT_ASSERT_EQUAL(0, grid.get_num_alive_ships());
-        CPPUNIT_ASSERT_EQUAL(1, (int) grid.get_n_ships()[bship::ST_TWO]);
+        CPPUNIT_ASSERT_EQUAL(1, (int) grid.get_n_ships().at(bship::ST_TWO));
 
         // shooting a previously shot cell
         CPPUNIT_ASSERT_THROW(grid.shoot_at(1, 1), bship::illegal_move_exception);
@@ -141,11 +142,86 @@ public:
     }
 
 
+    // test the placement checks of the mask (10x10) and cell (10x9) paths against the cells,
+    // also cells written through cell_at()
+    void test_can_place_ship(){
+
+        static_assert(bship::placement_masks<10, 10>::mask(4, 2, 8, true).w[0] == (1ull << 28 | 1ull << 38 | 1ull << 48 | 1ull << 58), "mask");
+        CPPUNIT_ASSERT(bship::placement_table(10, 10) != nullptr);
+        CPPUNIT_ASSERT(bship::placement_table(10, 9) == nullptr);
+
+        for(size_t h : {10, 9}){
+            bship::bs_grid g(10, h);
+            bship::fleet_sampler fs(g, bship::SM_FAST, 5);
+
+            for(int it=0; it<10; ++it){
+                g.reset();
+                const std::vector<bship::ship_placement>& l = fs.sample();
+                for(size_t k=0; k+1<l.size(); ++k) g.place_ship(l[k].type, l[k].row, l[k].col, l[k].orient);
+                g.shoot_at(it % h, (3 * it) % 10);
+
+                // written around place_ship() and shoot_at(), seen by both paths
+                if(g.cell_at(h - 1, it).can_place()) g.cell_at(h - 1, it).state = bship::CS_MISSED;
+
+                for(size_t r=0; r<h; ++r){
+                    for(size_t c=0; c<10; ++c){
+                        for(int t=bship::ST_TWO; t<=bship::ST_FIVE; ++t){
+                            for(bship::ship_orientation o : {bship::SO_HOR, bship::SO_VERT}){
+                                bool fits = true;
+                                for(int k=0; k<t && fits; ++k){
+                                    size_t rr = r + ((o == bship::SO_VERT) ? k : 0), cc = c + ((o == bship::SO_HOR) ? k : 0);
+                                    fits = rr < h && cc < 10 && g.cell_at(rr, cc).can_place();
+                                }
+                                CPPUNIT_ASSERT_EQUAL(fits, g.can_place_ship((bship::ship_type) t, r, c, o));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+    }
+
+
+    // test clearing a grid for a new game
+    void test_reset(){
+
+        bship::bs_grid grid(10, 10);
+        grid.place_ship(bship::ST_FIVE,  0, 0, bship::SO_HOR);
+        grid.place_ship(bship::ST_FOUR,  2, 0, bship::SO_HOR);
+        grid.place_ship(bship::ST_THREE, 4, 0, bship::SO_HOR);
+        grid.place_ship(bship::ST_THREE, 6, 0, bship::SO_HOR);
+        grid.place_ship(bship::ST_TWO,   8, 0, bship::SO_HOR);
+        grid.shoot_at(0, 0);
+        grid.shoot_at(9, 9);
+        CPPUNIT_ASSERT(grid.is_ready());
+
+        grid.reset();
+        CPPUNIT_ASSERT(!grid.is_ready());
+        CPPUNIT_ASSERT_EQUAL(0, grid.get_num_alive_ships());
+        CPPUNIT_ASSERT_EQUAL(0, (int) grid.get_n_ships().at(bship::ST_THREE));
+        for(size_t i=0; i<10; ++i){
+            for(size_t j=0; j<10; ++j){
+                CPPUNIT_ASSERT_EQUAL(bship::CS_EMPTY, grid.cell_at(i, j).state);
+                CPPUNIT_ASSERT_EQUAL(-1, grid.cell_at(i, j).ship_id);
+            }
+        }
+
+        // ship ids start over
+        CPPUNIT_ASSERT(grid.place_ship(bship::ST_TWO, 0, 0, bship::SO_VERT));
+        CPPUNIT_ASSERT_EQUAL(0, grid.cell_at(1, 0).ship_id);
+        CPPUNIT_ASSERT_EQUAL(1, grid.get_num_alive_ships());
+
+    }
+
+
     CPPUNIT_TEST_SUITE(test_bs_grid);
     CPPUNIT_TEST(test_constructor);
     CPPUNIT_TEST(test_cell_at);
     CPPUNIT_TEST(test_place_ship);
     CPPUNIT_TEST(test_shoot_at);
+    CPPUNIT_TEST(test_reset);
+    CPPUNIT_TEST(test_can_place_ship);
     CPPUNIT_TEST_SUITE_END();
 
 };
@@ -0,0 +1,122 @@
+#ifndef TEST_CALIBRATION_HPP
+#define TEST_CALIBRATION_HPP
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bs_player.h"
+#include "calibration.h"
+
+
+class test_calibration : public CppUnit::TestCase{
+
+public:
+
+    test_calibration(){}
+
+
+    /// Small batches and a loose tolerance, so that a search takes a fraction of a second
+    static bship::calib_config quick(){
+        bship::calib_config cfg;
+        cfg.threads    = 2;
+        cfg.batch      = 64;
+        cfg.max_games  = 4096;
+        cfg.tolerance  = 0.04;
+        cfg.resolution = 1.0f / 32;
+        return cfg;
+    }
+
+
+    static bship::bs_player *make_random(const std::string& name){ return new bship::bs_player(name); }
+
+
+    // test the sequential test: far from the target one batch is enough, close to it the interval tightens
+    void test_measure(){
+
+        bship::difficulty_calibrator calib(make_random, quick());
+
+        // peeking at every shot against a random bot always wins
+        bship::calib_point pt = calib.measure(bship::CT_WIN_RATE, 1.0f, 0.5);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 128, pt.games);
+        CPPUNIT_ASSERT(pt.value > 0.95);
+        CPPUNIT_ASSERT(pt.value - pt.half_width > 0.5);
+
+        // without peeking it is a random bot too: the interval covers one
+        // half at whichever batch it stops (a fixed sample interval tested
+        // after every batch is clear of it in 4% of the measures)
+        pt = calib.measure(bship::CT_WIN_RATE, 0.0f, 0.5);
+        CPPUNIT_ASSERT(pt.games > 128);
+        CPPUNIT_ASSERT(std::fabs(pt.value - 0.5) <= pt.half_width);
+        CPPUNIT_ASSERT(pt.half_width <= 0.04 || pt.games >= 4096);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, pt.value, 0.1);
+
+        // fewer shots with more peeks
+        bship::calib_point lo = calib.measure(bship::CT_SHOTS, 0.1f, 0);
+        bship::calib_point hi = calib.measure(bship::CT_SHOTS, 0.9f, 0);
+        CPPUNIT_ASSERT(hi.value < lo.value);
+        CPPUNIT_ASSERT(hi.value >= 17);
+        CPPUNIT_ASSERT(calib.get_games() >= 4 * 128);
+
+    }
+
+
+    // test the search: the difficulties found are ordered like their targets
+    void test_calibrate(){
+
+        bship::difficulty_calibrator calib(make_random, quick());
+        std::vector<bship::calib_point> t = calib.table(bship::CT_WIN_RATE, {0.6, 0.9});
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, t.size());
+        for(const bship::calib_point& pt : t){
+            CPPUNIT_ASSERT(pt.peek_prob > 0 && pt.peek_prob < 1);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(pt.target, pt.value, pt.half_width + 0.05);
+        }
+        CPPUNIT_ASSERT(t[0].peek_prob < t[1].peek_prob);
+
+    }
+
+
+    // test that a table reads back as written
+    void test_table(){
+
+        std::string path = "test_calibration.table";
+        std::vector<bship::calib_point> t = {
+            {bship::CT_WIN_RATE, 0.5, 0.125f, 0.49, 0.01, 20000},
+            {bship::CT_SHOTS, 60, 0.5f, 60.5, 0.3, 4096}
+        };
+        CPPUNIT_ASSERT(bship::save_difficulty_table(path, "random", t));
+
+        std::string ref;
+        std::vector<bship::calib_point> back = bship::load_difficulty_table(path, &ref);
+        CPPUNIT_ASSERT_EQUAL(std::string("random"), ref);
+        CPPUNIT_ASSERT_EQUAL(t.size(), back.size());
+        for(size_t i=0; i<t.size(); ++i){
+            CPPUNIT_ASSERT_EQUAL(t[i].kind, back[i].kind);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(t[i].target, back[i].target, 1e-9);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(t[i].peek_prob, back[i].peek_prob, 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(t[i].value, back[i].value, 1e-9);
+            CPPUNIT_ASSERT_EQUAL(t[i].games, back[i].games);
+        }
+        std::remove(path.c_str());
+
+        CPPUNIT_ASSERT(bship::load_difficulty_table("no_such.table").empty());
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_calibration);
+    CPPUNIT_TEST(test_measure);
+    CPPUNIT_TEST(test_calibrate);
+    CPPUNIT_TEST(test_table);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef TEST_ENDGAME_HPP
+#define TEST_ENDGAME_HPP
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bs_grid.h"
+#include "endgame.h"
+#include "exceptions.hpp"
+
+
+class test_endgame : public CppUnit::TestCase{
+
+public:
+
+    test_endgame(){}
+
+
+    // test a position small enough to solve by hand
+    void test_strip(){
+
+        // 2-cell ship on a 1x3 strip: the middle is a certain hit, then one of
+        // the ends finishes the game with probability 1/2
+        bship::bs_grid strip(3, 1);
+        bship::endgame_solver eg(3, 1, {{bship::ST_TWO, 1}});
+        size_t r = 9, c = 9;
+
+        CPPUNIT_ASSERT_EQUAL(true, eg.best_shot(strip, r, c));
+        CPPUNIT_ASSERT_EQUAL(0ul, r);
+        CPPUNIT_ASSERT_EQUAL(1ul, c);
+        CPPUNIT_ASSERT_EQUAL(2ul, eg.num_layouts());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, eg.expected_shots(), 1e-12);
+
+        // the answer is cached for the same observation
+        size_t entries = eg.table_size();
+        CPPUNIT_ASSERT_EQUAL(true, eg.best_shot(strip, r, c));
+        CPPUNIT_ASSERT_EQUAL(entries, eg.table_size());
+
+        // after the hit, either end is as good
+        strip.cell_at(0, 1).state = bship::CS_DESTROYED;
+        CPPUNIT_ASSERT_EQUAL(true, eg.best_shot(strip, r, c));
+        CPPUNIT_ASSERT(c != 1);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, eg.expected_shots(), 1e-12);
+
+    }
+
+
+    // test the fallback on large positions
+    void test_too_large(){
+
+        bship::bs_grid grid(10, 10);
+        bship::endgame_solver eg(grid);
+        size_t r, c;
+
+        CPPUNIT_ASSERT_EQUAL(false, eg.best_shot(grid, r, c));
+
+        // too large grids are rejected
+        CPPUNIT_ASSERT_THROW(bship::endgame_solver(12, 12, grid.get_max_n_ships()), bship::index_exception);
+
+    }
+
+
+    // test playing out the end of a standard game
+    void test_play_out(){
+
+        bship::bs_grid hidden(10, 10), obs(10, 10);
+        hidden.place_ship(bship::ST_FIVE,  0, 0, bship::SO_HOR);
+        hidden.place_ship(bship::ST_FOUR,  2, 3, bship::SO_VERT);
+        hidden.place_ship(bship::ST_THREE, 7, 7, bship::SO_HOR);
+        hidden.place_ship(bship::ST_THREE, 4, 9, bship::SO_VERT);
+        hidden.place_ship(bship::ST_TWO,   9, 0, bship::SO_HOR);
+
+        // everything is known except the lower right corner
+        for(size_t i=0; i<10; ++i){
+            for(size_t j=0; j<10; ++j){
+                if(i >= 6 && j >= 6) continue;
+                obs.cell_at(i, j).state = (hidden.shoot_at(i, j).first == bship::SR_MISS) ? bship::CS_MISSED : bship::CS_DESTROYED;
+            }
+        }
+
+        bship::endgame_solver eg(hidden);
+        size_t r, c;
+        int shots = 0;
+        while(hidden.get_num_alive_ships() > 0){
+            CPPUNIT_ASSERT_EQUAL(true, eg.best_shot(obs, r, c));
+            CPPUNIT_ASSERT(obs.cell_at(r, c).can_shoot());
+            obs.cell_at(r, c).state = (hidden.shoot_at(r, c).first == bship::SR_MISS) ? bship::CS_MISSED : bship::CS_DESTROYED;
+            ++shots;
+        }
+
+        // the 3 cells of the horizontal 3-cell ship are needed at least
+        CPPUNIT_ASSERT(shots >= 3);
+        CPPUNIT_ASSERT(shots <= 16);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_endgame);
+    CPPUNIT_TEST(test_strip);
+    CPPUNIT_TEST(test_too_large);
+    CPPUNIT_TEST(test_play_out);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
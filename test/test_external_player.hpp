@@ -0,0 +1,81 @@
+#ifndef TEST_EXTERNAL_PLAYER_HPP
+#define TEST_EXTERNAL_PLAYER_HPP
+
+#include <cerrno>
+#include <csignal>
+#include <string>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "exceptions.hpp"
+#include "external_player.h"
+
+
+class test_external_player : public CppUnit::TestCase{
+
+public:
+
+    test_external_player(){}
+
+
+    // test that a bot failing the handshake is stopped and reaped
+    void test_handshake(){
+
+        // the bot answers with its pid and waits for the end of its input
+        std::vector<std::string> cmd = {"/bin/sh", "-c", "echo $$; read x"};
+        std::string msg;
+        try{
+            bship::external_player ext(cmd);
+        }
+        catch(bship::protocol_exception& e){
+            msg = e.what();
+        }
+        CPPUNIT_ASSERT(msg.find("Unexpected handshake: ") != std::string::npos);
+
+        // reaped: not even a zombie is left
+        pid_t pid = std::stol(msg.substr(msg.rfind(": ") + 2));
+        CPPUNIT_ASSERT(kill(pid, 0) != 0 && errno == ESRCH);
+
+        // a bot that does not start
+        cmd = {"/nonexistent/bot"};
+        CPPUNIT_ASSERT_THROW(bship::external_player ext(cmd), bship::protocol_exception);
+
+    }
+
+
+    // test that a bot which closed its input fails the game without a SIGPIPE
+    void test_closed_input(){
+
+        // the bot closes its input once the handshake is read
+        std::vector<std::string> cmd = {"/bin/sh", "-c", "read x; exec 0<&-; echo bshipok closed; exec sleep 1"};
+        bship::external_player ext(cmd);
+        bship::battleship game(10, 10, bship::OM_SILENT);
+        bship::bs_player opp("random");
+        bship::connect(&game, &ext, &opp);
+        CPPUNIT_ASSERT_THROW(game.start(), bship::protocol_exception);
+
+        // the signal disposition is untouched, and no SIGPIPE is left pending
+        struct sigaction sa;
+        sigaction(SIGPIPE, nullptr, &sa);
+        CPPUNIT_ASSERT(sa.sa_handler == SIG_DFL);
+        sigset_t pending;
+        sigpending(&pending);
+        CPPUNIT_ASSERT(!sigismember(&pending, SIGPIPE));
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_external_player);
+    CPPUNIT_TEST(test_handshake);
+    CPPUNIT_TEST(test_closed_input);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef TEST_FLEET_COUNTER_HPP
+#define TEST_FLEET_COUNTER_HPP
+
+#include <map>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bs_grid.h"
+#include "fleet_counter.h"
+#include "exceptions.hpp"
+
+
+class test_fleet_counter : public CppUnit::TestCase{
+
+public:
+
+    test_fleet_counter(){}
+
+
+    // brute force: count arrangements of ships[k..] on occ consistent with obs, adding covers
+    static unsigned long brute(bship::bs_grid& obs, std::vector<int>& ships, size_t k, int min_idx,
+                               std::vector<int>& occ, std::vector<unsigned long>& cov){
+        size_t w = obs.get_width(), h = obs.get_height();
+
+        if(k == ships.size()){
+            // every hit cell has to be covered
+            for(size_t i=0; i<w*h; ++i)
+                if(obs.cell_at(i / w, i % w).state == bship::CS_DESTROYED && !occ[i]) return 0;
+            for(size_t i=0; i<w*h; ++i) cov[i] += occ[i];
+            return 1;
+        }
+
+        unsigned long res = 0;
+        int len = ships[k];
+        for(int p=0; p<(int) (w*h*2); ++p){
+            // same-type ships are placed in increasing order to count sets once
+            if(k > 0 && ships[k-1] == len && p <= min_idx) continue;
+
+            size_t r = (p/2) / w, c = (p/2) % w;
+            bool hor = (p % 2 == 0);
+            if((hor && c + len > w) || (!hor && r + len > h)) continue;
+
+            bool ok = true;
+            for(int s=0; s<len && ok; ++s){
+                size_t i = (hor) ? r*w + c + s : (r+s)*w + c;
+                ok = !occ[i] && obs.cell_at(i / w, i % w).state != bship::CS_MISSED;
+            }
+            if(!ok) continue;
+
+            for(int s=0; s<len; ++s) occ[(hor) ? r*w + c + s : (r+s)*w + c] = 1;
+            res += brute(obs, ships, k+1, p, occ, cov);
+            for(int s=0; s<len; ++s) occ[(hor) ? r*w + c + s : (r+s)*w + c] = 0;
+        }
+        return res;
+    }
+
+
+    // compares counter results with brute force on the given observation
+    static void check(bship::bs_grid& obs, std::map<bship::ship_type, uint8_t> fleet){
+        std::vector<int> ships;
+        for(auto& tp : fleet)
+            for(int i=0; i<tp.second; ++i) ships.push_back(tp.first);
+
+        size_t w = obs.get_width(), h = obs.get_height();
+        std::vector<int> occ(w*h, 0);
+        std::vector<unsigned long> cov(w*h, 0);
+        unsigned long n = brute(obs, ships, 0, -1, occ, cov);
+
+        bship::fleet_counter fc(w, h, fleet);
+        CPPUNIT_ASSERT_EQUAL(n, (unsigned long) fc.count(obs));
+        CPPUNIT_ASSERT_EQUAL(n, (unsigned long) fc.solve(obs));
+        for(size_t i=0; i<w*h; ++i)
+            CPPUNIT_ASSERT_EQUAL(cov[i], (unsigned long) fc.cover_count(i / w, i % w));
+    }
+
+
+    // test small grids by hand
+    void test_small(){
+
+        // single 2-cell ship on a 1x3 strip
+        bship::bs_grid strip(3, 1);
+        bship::fleet_counter fc(3, 1, {{bship::ST_TWO, 1}});
+        CPPUNIT_ASSERT_EQUAL(std::string("2"), bship::to_string(fc.solve(strip)));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, fc.hit_prob(0, 0), 1e-12);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, fc.hit_prob(0, 1), 1e-12);
+
+        // a miss in the middle leaves no room
+        strip.cell_at(0, 1).state = bship::CS_MISSED;
+        CPPUNIT_ASSERT_EQUAL(std::string("0"), bship::to_string(fc.solve(strip)));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, fc.hit_prob(0, 0), 1e-12);
+
+        // 6 horizontal and 6 vertical placements on 3x3, 4 of them cover the center
+        bship::bs_grid sq(3, 3);
+        bship::fleet_counter fs(3, 3, {{bship::ST_TWO, 1}});
+        fs.solve(sq);
+        CPPUNIT_ASSERT_EQUAL(std::string("12"), bship::to_string(fs.get_count()));
+        CPPUNIT_ASSERT_EQUAL(std::string("4"), bship::to_string(fs.cover_count(1, 1)));
+
+        // out-of-bounds
+        CPPUNIT_ASSERT_THROW(fs.cover_count(3, 0), bship::index_exception);
+
+    }
+
+
+    // test against brute force with misses and hits
+    void test_brute_force(){
+
+        std::map<bship::ship_type, uint8_t> fleet = {
+            {bship::ST_TWO,   1},
+            {bship::ST_THREE, 2}
+        };
+
+        bship::bs_grid g(5, 5);
+        check(g, fleet);
+
+        g.cell_at(2, 2).state = bship::CS_MISSED;
+        g.cell_at(0, 3).state = bship::CS_MISSED;
+        check(g, fleet);
+
+        g.cell_at(1, 1).state = bship::CS_DESTROYED;
+        g.cell_at(4, 0).state = bship::CS_DESTROYED;
+        check(g, fleet);
+
+        // wide grids are transposed internally
+        bship::bs_grid wg(7, 4);
+        wg.cell_at(1, 5).state = bship::CS_DESTROYED;
+        wg.cell_at(3, 2).state = bship::CS_MISSED;
+        check(wg, fleet);
+
+    }
+
+
+    // test the standard game
+    void test_standard(){
+
+        // 30093975536 arrangements of distinguishable ships, the 3-cell ships are swappable
+        bship::bs_grid g(10, 10);
+        bship::fleet_counter fc(g);
+        CPPUNIT_ASSERT_EQUAL(std::string("15046987768"), bship::to_string(fc.count(g)));
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_fleet_counter);
+    CPPUNIT_TEST(test_small);
+    CPPUNIT_TEST(test_brute_force);
+    CPPUNIT_TEST(test_standard);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef TEST_FLEET_SAMPLER_HPP
+#define TEST_FLEET_SAMPLER_HPP
+
+#include <cmath>
+#include <map>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bs_grid.h"
+#include "fleet_counter.h"
+#include "fleet_sampler.h"
+
+
+class test_fleet_sampler : public CppUnit::TestCase{
+
+public:
+
+    test_fleet_sampler(){}
+
+
+    // test that the layouts of both modes are legal and complete
+    void test_legal(){
+
+        bship::bs_grid g(10, 10);
+        for(bship::sampler_mode mode : {bship::SM_UNIFORM, bship::SM_FAST}){
+            bship::fleet_sampler fs(g, mode, 42);
+            CPPUNIT_ASSERT_EQUAL((size_t) 5, fs.get_n_ships());
+
+            for(int i=0; i<100; ++i){
+                bship::ship_placement out[5];
+                bship::bitboard occ = fs.sample(out);
+                CPPUNIT_ASSERT_EQUAL(17, occ.count());
+                CPPUNIT_ASSERT_EQUAL(bship::ST_FIVE, out[0].type);
+
+                g.reset();
+                fs.place(g);
+                CPPUNIT_ASSERT(g.is_ready());
+            }
+        }
+
+        CPPUNIT_ASSERT_THROW(bship::fleet_sampler(3, 3, g.get_max_n_ships()), bship::illegal_move_exception);
+        CPPUNIT_ASSERT_THROW(bship::fleet_sampler(4, 4, g.get_max_n_ships()).sample(), bship::illegal_move_exception);
+
+    }
+
+
+    // test that every layout is equally likely on a grid small enough to list them
+    void test_uniform_layouts(){
+
+        std::map<bship::ship_type, uint8_t> fleet = {{bship::ST_TWO, 1}, {bship::ST_THREE, 1}};
+        bship::bs_grid obs(3, 3);
+        bship::fleet_counter fc(3, 3, fleet);
+        double n_layouts = (double) fc.count(obs);
+
+        bship::fleet_sampler fs(3, 3, fleet, bship::SM_UNIFORM, 7);
+        std::map<int, int> seen;
+        const int draws = 40000;
+        for(int i=0; i<draws; ++i){
+            const std::vector<bship::ship_placement>& l = fs.sample();
+            int key = 0;
+            for(const bship::ship_placement& p : l) key = key * 100 + p.row * 20 + p.col * 2 + p.orient;
+            ++seen[key];
+        }
+
+        CPPUNIT_ASSERT_EQUAL(n_layouts, (double) seen.size());
+        for(auto& s : seen) CPPUNIT_ASSERT_DOUBLES_EQUAL(draws / n_layouts, s.second, 0.15 * draws / n_layouts);
+
+    }
+
+
+    // test the per-cell frequencies against the exact probabilities
+    void test_uniform_cells(){
+
+        bship::bs_grid g(6, 6);
+        bship::fleet_counter fc(g);
+        fc.solve(g);
+
+        bship::fleet_sampler fs(g, bship::SM_UNIFORM, 11);
+        double freq[36] = {0};
+        const int draws = 20000;
+        for(int i=0; i<draws; ++i){
+            bship::ship_placement out[5];
+            bship::bitboard occ = fs.sample(out);
+            for(size_t c=0; c<36; ++c) freq[c] += occ.test(c);
+        }
+
+        for(size_t c=0; c<36; ++c)
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(fc.hit_prob(c / 6, c % 6), freq[c] / draws, 0.02);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_fleet_sampler);
+    CPPUNIT_TEST(test_legal);
+    CPPUNIT_TEST(test_uniform_layouts);
+    CPPUNIT_TEST(test_uniform_cells);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,348 @@
+#ifndef TEST_GAME_SERVER_HPP
+#define TEST_GAME_SERVER_HPP
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "game_server.h"
+#include "game_broadcast.h"
+#include "exceptions.hpp"
+
+
+class test_game_server : public CppUnit::TestCase{
+
+    // blocking client connection
+    int fd;
+    std::string in;
+
+    // another connection (see switch_client())
+    int other_fd;
+    std::string other_in;
+
+
+    void switch_client(){
+        std::swap(fd, other_fd);
+        std::swap(in, other_in);
+    }
+
+
+    void connect_to(const std::string& path){
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, path.c_str());
+        CPPUNIT_ASSERT_EQUAL(0, connect(fd, (sockaddr*) &addr, sizeof(addr)));
+    }
+
+
+    void send_line(const std::string& line){
+        std::string l = line + "\n";
+        CPPUNIT_ASSERT_EQUAL((ssize_t) l.size(), write(fd, l.data(), l.size()));
+    }
+
+
+    std::string read_line(){
+        size_t nl;
+        while((nl = in.find('\n')) == std::string::npos){
+            char buf[1024];
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if(n <= 0) return "";
+            in.append(buf, n);
+        }
+        std::string line = in.substr(0, nl);
+        in.erase(0, nl + 1);
+        return line;
+    }
+
+
+public:
+
+    test_game_server(){}
+
+
+    // test a whole game against the random bot
+    void test_game(){
+
+        std::string path = "/tmp/bship_test_" + std::to_string(getpid()) + ".sock";
+        bship::game_server srv(path);
+        std::thread loop([&srv](){ srv.run(); });
+
+        connect_to(path);
+        send_line("new random");
+        CPPUNIT_ASSERT_EQUAL(std::string("newgame 10 10 2x1 3x2 4x1 5x1"), read_line());
+
+        // shooting before placing, illegal placement
+        send_line("shoot 0 0");
+        CPPUNIT_ASSERT_EQUAL(std::string("err ships not placed yet"), read_line());
+        send_line("place 5 0 7 h");
+        CPPUNIT_ASSERT_EQUAL(std::string("err can't place the ship there"), read_line());
+
+        // several requests at once
+        send_line("place 5 0 0 h\nplace 4 2 0 h\nplace 3 4 0 h\nplace 3 6 0 h\nplace 2 8 0 h");
+        for(int i=0; i<5; ++i) CPPUNIT_ASSERT_EQUAL(std::string("ok"), read_line());
+
+        // shoot every cell until the game is over
+        std::string line;
+        int shots = 0, opp = 0, sunk = 0, lost = 0;
+        for(size_t k=0; k<100 && sunk < 5 && lost < 5; ++k){
+            send_line("shoot " + std::to_string(k / 10) + " " + std::to_string(k % 10));
+            line = read_line();
+            CPPUNIT_ASSERT(line.compare(0, 7, "result ") == 0);
+            ++shots;
+            if(line.find("sink") != std::string::npos) ++sunk;
+
+            // after a miss, the bot shoots until it misses
+            bool bot_turn = line.find("miss") != std::string::npos;
+            while(bot_turn && lost < 5){
+                line = read_line();
+                CPPUNIT_ASSERT(line.compare(0, 4, "opp ") == 0);
+                ++opp;
+                if(line.find("sink") != std::string::npos) ++lost;
+                bot_turn = line.find("miss") == std::string::npos;
+            }
+        }
+        line = read_line();
+
+        CPPUNIT_ASSERT_EQUAL(std::string((sunk == 5) ? "gameover win" : "gameover loss"), line);
+        CPPUNIT_ASSERT(shots >= 17);
+        CPPUNIT_ASSERT(opp > 0);
+
+        send_line("shoot 0 0");
+        CPPUNIT_ASSERT_EQUAL(std::string("err no game in progress"), read_line());
+        send_line("quit");
+        CPPUNIT_ASSERT_EQUAL(std::string(""), read_line());
+        close(fd);
+
+        srv.stop();
+        loop.join();
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, srv.num_games_played());
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, srv.num_sessions());
+
+    }
+
+
+    // test the event broadcast of a game played by two random bots
+    void test_broadcast(){
+
+        bship::battleship gm(10, 10, bship::OM_SILENT);
+        bship::bs_player pa("a"), pb("b");
+        bship::connect(&gm, &pa, &pb);
+
+        bship::game_broadcast cast(&gm, 1000);
+        bship::game_broadcast slow(&gm, 8);
+        size_t s1 = cast.subscribe(), s2 = cast.subscribe();
+        size_t s3 = slow.subscribe();
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, cast.num_subscribers());
+
+        // new subscribers start with the same snapshot
+        std::vector<bship::event_buffer> ev1, ev2, ev3;
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, cast.poll(s1, ev1));
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, cast.poll(s2, ev2));
+        CPPUNIT_ASSERT(ev1[0].get() == ev2[0].get());
+        CPPUNIT_ASSERT_EQUAL(0, ev1[0]->compare(0, 19, "snapshot 10 10 A 0\n"));
+        CPPUNIT_ASSERT_EQUAL(std::string::npos, ev1[0]->find('S'));
+
+        gm.start();
+
+        // every event is encoded once and shared
+        ev1.clear();
+        ev2.clear();
+        cast.poll(s1, ev1);
+        cast.poll(s2, ev2);
+        CPPUNIT_ASSERT_EQUAL(ev1.size(), ev2.size());
+        for(size_t i=0; i<ev1.size(); ++i) CPPUNIT_ASSERT(ev1[i].get() == ev2[i].get());
+
+        // no placement, and the fleets only in the snapshot after the game over
+        size_t places = 0, shots = 0;
+        for(auto& e : ev1){
+            if(e->compare(0, 6, "place ") == 0) ++places;
+            if(e->compare(0, 5, "shot ") == 0) ++shots;
+        }
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, places);
+        CPPUNIT_ASSERT_EQUAL((size_t) gm.get_total_shots(), shots);
+        CPPUNIT_ASSERT(ev1.size() >= 2);
+        CPPUNIT_ASSERT_EQUAL(std::string((gm.get_winner() == &pa) ? "gameover A\n" : "gameover B\n"), *ev1[ev1.size() - 2]);
+        CPPUNIT_ASSERT_EQUAL(0, ev1.back()->compare(0, 9, "snapshot "));
+        CPPUNIT_ASSERT(ev1.back()->find('S') != std::string::npos);
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, cast.num_resyncs());
+
+        // the subscriber not polling was resynced and stayed bounded
+        slow.poll(s3, ev3);
+        CPPUNIT_ASSERT(slow.num_resyncs() > 0);
+        CPPUNIT_ASSERT(ev3.size() <= 8);
+        CPPUNIT_ASSERT_EQUAL(0, ev3[0]->compare(0, 9, "snapshot "));
+        CPPUNIT_ASSERT(ev3[0]->find('X') != std::string::npos);
+        CPPUNIT_ASSERT(*ev3.back() == *ev1.back());
+
+        cast.unsubscribe(s1);
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, cast.poll(s1, ev1));
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, cast.num_subscribers());
+
+    }
+
+
+    // test watching the game of another client
+    void test_watch(){
+
+        std::string path = "/tmp/bship_test_" + std::to_string(getpid()) + ".sock";
+        bship::game_server srv(path);
+        std::thread loop([&srv](){ srv.run(); });
+
+        connect_to(path);
+        send_line("new random");
+        read_line();
+        send_line("place 5 0 0 h\nplace 4 2 0 h\nplace 3 4 0 h\nplace 3 6 0 h\nplace 2 8 0 h");
+        for(int i=0; i<5; ++i) CPPUNIT_ASSERT_EQUAL(std::string("ok"), read_line());
+
+        switch_client();
+        connect_to(path);
+        send_line("list");
+        std::string games = read_line();
+        CPPUNIT_ASSERT_EQUAL(0, games.compare(0, 6, "games "));
+        send_line("watch 12345");
+        CPPUNIT_ASSERT_EQUAL(std::string("err no such game"), read_line());
+        send_line("watch " + games.substr(6));
+        CPPUNIT_ASSERT_EQUAL(std::string("ok"), read_line());
+        CPPUNIT_ASSERT_EQUAL(std::string("snapshot 10 10 A 0"), read_line());
+        std::string grid_a = read_line(), grid_b = read_line();
+        CPPUNIT_ASSERT_EQUAL(0, grid_a.compare(0, 7, "grid A "));
+        CPPUNIT_ASSERT_EQUAL(0, grid_b.compare(0, 7, "grid B "));
+
+        // both fleets are placed, neither shows
+        CPPUNIT_ASSERT_EQUAL(std::string::npos, grid_a.find('S', 7));
+        CPPUNIT_ASSERT_EQUAL(std::string::npos, grid_b.find('S', 7));
+
+        // the player's shot reaches the spectator
+        switch_client();
+        send_line("shoot 0 0");
+        CPPUNIT_ASSERT_EQUAL(0, read_line().compare(0, 11, "result 0 0 "));
+        switch_client();
+        CPPUNIT_ASSERT_EQUAL(0, read_line().compare(0, 11, "shot A 0 0 "));
+
+        // then the bot's shots, if any
+        send_line("unwatch");
+        std::string line;
+        while((line = read_line()).compare(0, 7, "shot B ") == 0);
+        CPPUNIT_ASSERT_EQUAL(std::string("ok"), line);
+        send_line("quit");
+        close(fd);
+        switch_client();
+        send_line("quit");
+        close(fd);
+
+        srv.stop();
+        loop.join();
+
+    }
+
+
+    // test that a player watching its own game from a second connection sees no ship
+    void test_watch_hidden(){
+
+        std::string path = "/tmp/bship_test_" + std::to_string(getpid()) + ".sock";
+        bship::game_server srv(path);
+        std::thread loop([&srv](){ srv.run(); });
+
+        connect_to(path);
+        send_line("new random");
+        read_line();
+
+        // the spectator is there before the placements
+        switch_client();
+        connect_to(path);
+        send_line("list");
+        std::string games = read_line();
+        send_line("watch " + games.substr(6));
+        CPPUNIT_ASSERT_EQUAL(std::string("ok"), read_line());
+        CPPUNIT_ASSERT_EQUAL(0, read_line().compare(0, 9, "snapshot "));
+        for(int p=0; p<2; ++p) CPPUNIT_ASSERT_EQUAL(std::string::npos, read_line().find('S', 7));
+
+        switch_client();
+        send_line("place 5 0 0 h\nplace 4 2 0 h\nplace 3 4 0 h\nplace 3 6 0 h\nplace 2 8 0 h");
+        for(int i=0; i<5; ++i) CPPUNIT_ASSERT_EQUAL(std::string("ok"), read_line());
+        send_line("shoot 9 9");
+        read_line();
+
+        // the next event is the shot, nothing about the placements
+        switch_client();
+        CPPUNIT_ASSERT_EQUAL(0, read_line().compare(0, 11, "shot A 9 9 "));
+
+        // a resync in the middle of the game hides the fleets too
+        send_line("watch " + games.substr(6));
+        std::string line;
+        while((line = read_line()) != "ok");
+        CPPUNIT_ASSERT_EQUAL(0, read_line().compare(0, 9, "snapshot "));
+        for(int p=0; p<2; ++p) CPPUNIT_ASSERT_EQUAL(std::string::npos, read_line().find('S', 7));
+
+        send_line("quit");
+        close(fd);
+        switch_client();
+        send_line("quit");
+        close(fd);
+
+        srv.stop();
+        loop.join();
+
+    }
+
+
+    // test that the replies still in the server when a client quits reach it
+    void test_quit_pending(){
+
+        std::string path = "/tmp/bship_test_" + std::to_string(getpid()) + ".sock";
+        bship::game_server srv(path);
+        std::thread loop([&srv](){ srv.run(); });
+
+        // far more replies than the socket holds, not read before quitting
+        const int n = 100000;
+        std::string req;
+        for(int i=0; i<n; ++i) req += "list\n";
+        req += "quit\nlist\n";
+        connect_to(path);
+        size_t done = 0;
+        while(done < req.size()){
+            ssize_t w = write(fd, req.data() + done, req.size() - done);
+            CPPUNIT_ASSERT(w > 0);
+            done += w;
+        }
+
+        // every reply, nothing after the quit, then the end of the connection,
+        // even when the server handles the quit before anything is read
+        usleep(200000);
+        int lines = 0;
+        std::string line;
+        while((line = read_line()) == "games") ++lines;
+        CPPUNIT_ASSERT_EQUAL(std::string(""), line);
+        CPPUNIT_ASSERT_EQUAL(n, lines);
+        close(fd);
+
+        srv.stop();
+        loop.join();
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, srv.num_sessions());
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_game_server);
+    CPPUNIT_TEST(test_game);
+    CPPUNIT_TEST(test_broadcast);
+    CPPUNIT_TEST(test_watch);
+    CPPUNIT_TEST(test_watch_hidden);
+    CPPUNIT_TEST(test_quit_pending);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef TEST_LAYOUT_CORPUS_HPP
+#define TEST_LAYOUT_CORPUS_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bs_grid.h"
+#include "fleet_sampler.h"
+#include "layout_corpus.h"
+
+
+class test_layout_corpus : public CppUnit::TestCase{
+
+public:
+
+    test_layout_corpus(){}
+
+
+    // test that the layouts read back are the ones written
+    void test_round_trip(){
+
+        std::string path = "/tmp/bship_corpus_" + std::to_string(getpid()) + ".bin";
+        bship::bs_grid g(10, 10);
+        bship::fleet_sampler fs(g, bship::SM_UNIFORM, 3), check(g, bship::SM_UNIFORM, 3);
+        CPPUNIT_ASSERT(bship::corpus_writer::generate(path, 1000, fs));
+
+        bship::layout_corpus corpus;
+        CPPUNIT_ASSERT(corpus.open(path));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1000, corpus.size());
+        CPPUNIT_ASSERT_EQUAL((size_t) 10, corpus.get_width());
+        CPPUNIT_ASSERT_EQUAL((size_t) 5, corpus.get_n_ships());
+
+        for(uint64_t i=0; i<corpus.size(); ++i){
+            bship::ship_placement a[5], b[5];
+            check.sample(a);
+            corpus.get(i, b);
+            for(int k=0; k<5; ++k){
+                CPPUNIT_ASSERT_EQUAL(a[k].type, b[k].type);
+                CPPUNIT_ASSERT_EQUAL(a[k].row, b[k].row);
+                CPPUNIT_ASSERT_EQUAL(a[k].col, b[k].col);
+                CPPUNIT_ASSERT_EQUAL(a[k].orient, b[k].orient);
+            }
+        }
+
+        CPPUNIT_ASSERT(corpus.matches(g));
+        g.reset();
+        CPPUNIT_ASSERT(corpus.apply(999, g));
+        CPPUNIT_ASSERT(g.is_ready());
+
+        // a ship of the layout lands on a shot cell
+        bship::ship_placement first[5];
+        corpus.get(998, first);
+        g.reset();
+        g.shoot_at(first[0].row, first[0].col);
+        CPPUNIT_ASSERT(!corpus.apply(998, g));
+        CPPUNIT_ASSERT_THROW(corpus.apply(1000, g), bship::index_exception);
+
+        // a second reader maps the same file
+        bship::layout_corpus other;
+        CPPUNIT_ASSERT(other.open(path));
+        CPPUNIT_ASSERT_EQUAL(corpus.size(), other.size());
+
+        // another size or fleet
+        bship::bs_grid small(8, 8);
+        CPPUNIT_ASSERT(!corpus.matches(small));
+        CPPUNIT_ASSERT(!bship::layout_corpus().matches(g));
+        std::string fleet_path = path + ".fleet";
+        bship::ship_placement five[5] = {};
+        for(auto fleet : {std::map<bship::ship_type, uint8_t>{{bship::ST_FIVE, 1}},
+                          std::map<bship::ship_type, uint8_t>{{bship::ST_TWO, 1}, {bship::ST_THREE, 1}, {bship::ST_FOUR, 2}, {bship::ST_FIVE, 1}}}){
+            bship::corpus_writer w;
+            CPPUNIT_ASSERT(w.open(fleet_path, 10, 10, fleet));
+            w.add(five);
+            CPPUNIT_ASSERT(w.close());
+            CPPUNIT_ASSERT(other.open(fleet_path));
+            CPPUNIT_ASSERT(!other.matches(g));
+        }
+        std::remove(fleet_path.c_str());
+
+
+        std::remove(path.c_str());
+
+    }
+
+
+    // test that files which are not a corpus are refused
+    void test_invalid(){
+
+        std::string path = "/tmp/bship_corpus_" + std::to_string(getpid()) + ".txt";
+        bship::layout_corpus corpus;
+        CPPUNIT_ASSERT(!corpus.open(path));
+
+        std::FILE *f = std::fopen(path.c_str(), "w");
+        std::fputs("not a corpus, but long enough to hold a header ...", f);
+        std::fclose(f);
+        CPPUNIT_ASSERT(!corpus.open(path));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 0, corpus.size());
+
+        // truncated: the header promises more records than the file holds
+        bship::corpus_writer w;
+        bship::bs_grid g(10, 10);
+        CPPUNIT_ASSERT(w.open(path, 10, 10, g.get_max_n_ships()));
+        bship::ship_placement ships[5] = {};
+        w.add(ships);
+        CPPUNIT_ASSERT(w.close());
+        CPPUNIT_ASSERT(truncate(path.c_str(), 50) == 0);
+        CPPUNIT_ASSERT(!corpus.open(path));
+
+        // a grid size whose cell count wraps around in 32 bits
+        CPPUNIT_ASSERT(w.open(path, 10, 10, g.get_max_n_ships()));
+        w.add(ships);
+        CPPUNIT_ASSERT(w.close());
+        uint32_t side = 65536;
+        f = std::fopen(path.c_str(), "r+b");
+        std::fseek(f, offsetof(bship::corpus_header, width), SEEK_SET);
+        std::fwrite(&side, sizeof(side), 1, f);
+        std::fwrite(&side, sizeof(side), 1, f);
+        std::fclose(f);
+        CPPUNIT_ASSERT(!corpus.open(path));
+
+        std::remove(path.c_str());
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_layout_corpus);
+    CPPUNIT_TEST(test_round_trip);
+    CPPUNIT_TEST(test_invalid);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
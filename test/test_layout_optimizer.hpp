@@ -0,0 +1,119 @@
+#ifndef TEST_LAYOUT_OPTIMIZER_HPP
+#define TEST_LAYOUT_OPTIMIZER_HPP
+
+#include <chrono>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_grid.h"
+#include "bs_player.h"
+#include "fleet_sampler.h"
+#include "hiding_player.h"
+#include "layout_optimizer.h"
+
+
+class test_layout_optimizer : public CppUnit::TestCase{
+
+public:
+
+    test_layout_optimizer(){}
+
+
+    // test that the search beats random layouts, within its budget
+    void test_optimize(){
+
+        bship::bs_grid g(10, 10);
+        for(bship::density_model m : {bship::DM_UNIFORM, bship::DM_PARITY}){
+            bship::layout_optimizer opt(g, m, 5);
+            double mean = 0;
+            for(double d : opt.get_density()) mean += d / 100;
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, mean, 1e-9);
+
+            // average score of random layouts
+            bship::fleet_sampler fs(g, bship::SM_UNIFORM, 9);
+            double random = 0;
+            for(int i=0; i<200; ++i) random += opt.score(fs.sample().data()) / 200;
+
+            bship::ship_placement out[5];
+            auto start = std::chrono::steady_clock::now();
+            double sc = opt.optimize(std::chrono::microseconds(20000), out);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            CPPUNIT_ASSERT(ms >= 20 && ms < 200);
+            CPPUNIT_ASSERT(opt.get_moves() > 1000);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(opt.score(out), sc, 1e-6);
+            CPPUNIT_ASSERT(sc < 0.8 * random);
+
+            // the layout is legal
+            bship::bs_grid check(10, 10);
+            for(auto& p : out) CPPUNIT_ASSERT(check.place_ship(p.type, p.row, p.col, p.orient));
+            CPPUNIT_ASSERT(check.is_ready());
+        }
+
+    }
+
+
+    // test a learned density: the ships stay off the hot cells
+    void test_learned(){
+
+        bship::bs_grid g(10, 10);
+        bship::layout_optimizer opt(g, bship::DM_UNIFORM, 2);
+
+        // everything but the first two rows is shot early
+        std::vector<double> d(100, 1.0);
+        for(int c=0; c<20; ++c) d[c] = 0.0;
+        opt.set_density(d);
+        CPPUNIT_ASSERT_EQUAL(bship::DM_LEARNED, opt.get_model());
+        opt.set_touch_penalty(0);
+
+        bship::ship_placement out[5];
+        double sc = opt.optimize(std::chrono::microseconds(20000), out);
+
+        // 17 cells fit in the 20 cold ones
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, sc, 1e-9);
+        for(auto& p : out) CPPUNIT_ASSERT(p.row + ((p.orient == bship::SO_VERT) ? p.type - 1 : 0) < 2);
+
+    }
+
+
+    // test that the player places its layouts game after game, in the same game or fresh ones
+    void test_player(){
+
+        bship::battleship game(10, 10, bship::OM_SILENT);
+        bship::hiding_player pa("hide", bship::DM_PARITY, std::chrono::microseconds(500));
+        bship::bs_player pb("random");
+        bship::connect(&game, &pa, &pb);
+
+        for(int g=0; g<5; ++g){
+            game.reset();
+            game.start();
+            CPPUNIT_ASSERT(game.is_finished());
+            CPPUNIT_ASSERT(pa.get_last_score() > 0);
+        }
+
+        // connected to fresh games without reset(), as bship_match does
+        for(int g=0; g<3; ++g){
+            bship::battleship fresh(10, 10, bship::OM_SILENT);
+            bship::bs_player opp("random");
+            bship::connect(&fresh, &pa, &opp);
+            fresh.start();
+            CPPUNIT_ASSERT(fresh.is_finished());
+        }
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_layout_optimizer);
+    CPPUNIT_TEST(test_optimize);
+    CPPUNIT_TEST(test_learned);
+    CPPUNIT_TEST(test_player);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
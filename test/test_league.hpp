@@ -0,0 +1,241 @@
+#ifndef TEST_LEAGUE_HPP
+#define TEST_LEAGUE_HPP
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bs_player.h"
+#include "league.h"
+#include "slick_player.h"
+
+
+/*!
+    Player with a fixed layout (ship k on row k, from column 0) that knows
+    where the other one put its ships: "ace" shoots them first, except in
+    every 8th game where it shoots every empty cell first, and "weak" shoots
+    82 empty cells first. The ace wins 7 games out of 8, whoever starts
+*/
+class rigged_player : public bship::bs_player{
+public:
+
+    rigged_player(const std::string& nm) : bship::bs_player(nm), ace(nm == "ace"), games(0) {}
+
+
+    void reset(){ ++games; }
+
+
+    void move(){
+        if(!hidden_grid->is_ready()){
+            size_t k = 0;
+            for(auto& tp : hidden_grid->get_n_ships()) k += tp.second;
+            game->place_ship(next_ship(), k, 0, bship::SO_HOR);
+            return;
+        }
+
+        // smallest ships first: rows of 2, 3, 3, 4 and 5 cells
+        static const size_t len[5] = {2, 3, 3, 4, 5};
+        size_t missed = 0;
+        for(size_t r=0; r<10; ++r)
+            for(size_t c=0; c<10; ++c) missed += (hit_grid->cell_at(r, c).state == bship::CS_MISSED);
+        bool ships_first = ace && games % 8 != 0;
+        bool empties = !ships_first && missed < ((ace) ? 83u : 82u);
+
+        for(size_t r=0; r<10; ++r){
+            for(size_t c=0; c<10; ++c){
+                bool ship = r < 5 && c < len[r];
+                if(hit_grid->cell_at(r, c).can_shoot() && ship != empties){
+                    game->shoot_at(r, c);
+                    return;
+                }
+            }
+        }
+    }
+
+
+private:
+
+    bool  ace;     ///< the stronger player
+    int   games;   ///< games started
+
+};
+
+
+
+class test_league : public CppUnit::TestCase{
+
+public:
+
+    test_league(){}
+
+
+    static bship::bs_player *make_bot(const std::string& spec, const std::string& name){
+        if(spec == "random") return new bship::bs_player(name);
+        if(spec == "ace" || spec == "weak") return new rigged_player(spec);
+        return new bship::slick_player(name, std::stof(spec.substr(6)));
+    }
+
+
+    static bship::glicko_rating rating(double r, double rd){
+        bship::glicko_rating g;
+        g.rating = r;
+        g.rd = rd;
+        return g;
+    }
+
+
+    // test the update against the example of Glickman's paper
+    void test_glicko(){
+
+        bship::glicko_rating r = rating(1500, 200);
+        bship::glicko_game games[3] = {
+            {rating(1400, 30), 1},
+            {rating(1550, 100), 0},
+            {rating(1700, 300), 0}
+        };
+        bship::glicko_update(r, games, 3);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1464, r.rating, 1);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(151.4, r.rd, 0.5);
+
+        // the floor
+        bship::glicko_rating f = rating(1500, 30);
+        bship::glicko_update(f, games, 3, 30);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(30, f.rd, 1e-9);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, bship::glicko_expected(rating(1500, 100), rating(1500, 300)), 1e-9);
+        CPPUNIT_ASSERT(bship::glicko_expected(rating(1700, 50), rating(1500, 50)) > 0.7);
+
+    }
+
+
+    // test that the schedule goes to the uncertain pairings
+    void test_schedule(){
+
+        bship::league lg(make_bot);
+        size_t a, b;
+        lg.add("slick:0.1", rating(1500, 50));
+        CPPUNIT_ASSERT(!lg.next_pairing(a, b));
+
+        lg.add("slick:0.2", rating(1510, 50));
+        lg.add("slick:0.9", rating(2000, 50));
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, lg.add("slick:0.2"));
+        CPPUNIT_ASSERT(lg.next_pairing(a, b));
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, a);
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, b);
+
+        // a newcomer plays first
+        lg.add("random");
+        CPPUNIT_ASSERT(lg.next_pairing(a, b));
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, b);
+
+    }
+
+
+    // test a run: the ratings sort the bots by strength, and are readable during the run
+    void test_run(){
+
+        // one thread and a fixed seed, the games are the same every run
+        srand(7);
+        bship::league_config cfg;
+        cfg.threads = 1;
+        bship::league lg(make_bot, cfg);
+        lg.add("random");
+        lg.add("slick:0.3");
+        lg.add("slick:0.9");
+
+        uint64_t played = 0;
+        std::thread runner([&](){ played = lg.run(3000); });
+        std::vector<bship::league_standing> during = lg.standings();
+        runner.join();
+
+        CPPUNIT_ASSERT_EQUAL((size_t) 3, during.size());
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 3008, played);
+        CPPUNIT_ASSERT_EQUAL(played, lg.get_games());
+
+        std::vector<bship::league_standing> st = lg.standings();
+        CPPUNIT_ASSERT_EQUAL(std::string("slick:0.9"), st[0].spec);
+        CPPUNIT_ASSERT_EQUAL(std::string("slick:0.3"), st[1].spec);
+        CPPUNIT_ASSERT_EQUAL(std::string("random"), st[2].spec);
+
+        uint64_t games = 0, wins = 0;
+        for(auto& p : st){
+            games += p.games;
+            wins += p.wins;
+            CPPUNIT_ASSERT(p.rating.rd < 350);
+        }
+        CPPUNIT_ASSERT_EQUAL(2 * played, games);
+        CPPUNIT_ASSERT_EQUAL(played, wins);
+
+        // stopped in the middle, and continued
+        std::thread again([&](){ played = lg.run(1000000000); });
+        while(lg.get_games() < 4000) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        lg.stop();
+        again.join();
+        CPPUNIT_ASSERT(played < 1000000);
+        CPPUNIT_ASSERT_EQUAL(3008 + played, lg.get_games());
+        CPPUNIT_ASSERT(lg.to_json().find("\"spec\": \"slick:0.9\"") != std::string::npos);
+
+    }
+
+
+    // test that the ratings follow the results: 7 wins out of 8 are a gap of 400 * log10(7)
+    void test_results(){
+
+        bship::league lg(make_bot);
+        lg.add("weak");
+        lg.add("ace");
+        lg.run(4096);
+
+        std::vector<bship::league_standing> st = lg.standings();
+        CPPUNIT_ASSERT_EQUAL(std::string("ace"), st[0].spec);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 3584, st[0].wins);
+        double gap = st[0].rating.rating - st[1].rating.rating;
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(400 * std::log10(7.0), gap, 10);
+
+    }
+
+
+    // test that a pairing one side always wins stays bounded
+    void test_unbeaten(){
+
+        srand(7);
+        bship::league lg(make_bot);
+        lg.add("random");
+        lg.add("slick:1.0");
+        lg.run(2048);
+
+        std::vector<bship::league_standing> st = lg.standings();
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 2048, st[0].wins);
+        double gap = st[0].rating.rating - st[1].rating.rating;
+        CPPUNIT_ASSERT(gap > 1000);
+
+        // four times the games, the gap hardly moves
+        lg.run(8192);
+        st = lg.standings();
+        double later = st[0].rating.rating - st[1].rating.rating;
+        CPPUNIT_ASSERT(later > gap && later < gap + 300);
+        CPPUNIT_ASSERT(st[0].rating.rd < 250);
+        CPPUNIT_ASSERT(st[1].rating.rd < 250);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_league);
+    CPPUNIT_TEST(test_glicko);
+    CPPUNIT_TEST(test_schedule);
+    CPPUNIT_TEST(test_run);
+    CPPUNIT_TEST(test_results);
+    CPPUNIT_TEST(test_unbeaten);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef TEST_METRICS_HPP
+#define TEST_METRICS_HPP
+
+#include <chrono>
+#include <thread>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "slick_player.h"
+#include "metrics.h"
+#include "exceptions.hpp"
+
+
+class test_metrics : public CppUnit::TestCase{
+
+public:
+
+    test_metrics(){}
+
+
+    // test the histogram buckets and quantiles
+    void test_histogram(){
+
+        bship::latency_histogram h;
+        CPPUNIT_ASSERT(h.quantile(0.5) == std::chrono::nanoseconds(0));
+
+        for(int i=0; i<99; ++i) h.add(std::chrono::nanoseconds(100));
+        h.add(std::chrono::nanoseconds(5000));
+
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 100, h.count);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 99, h.buckets[6]);   // [64, 128)
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1, h.buckets[12]);   // [4096, 8192)
+        CPPUNIT_ASSERT(h.quantile(0.5) == std::chrono::nanoseconds(127));
+        CPPUNIT_ASSERT(h.quantile(1.0) == std::chrono::nanoseconds(5000));
+        CPPUNIT_ASSERT(h.mean() == std::chrono::nanoseconds(149));
+
+    }
+
+
+    // test the counters of games played on two threads
+    void test_counters(){
+
+#ifdef BSHIP_METRICS
+        bship::metrics::reset();
+
+        int shots[2];
+        auto play = [&shots](int t){
+            bship::battleship game(10, 10, bship::OM_SILENT);
+            bship::bs_player pa("random");
+            bship::slick_player pb("slick", 1.0);
+            bship::connect(&game, &pa, &pb);
+            game.start();
+            shots[t] = game.get_total_shots();
+        };
+        std::thread t0(play, 0), t1(play, 1);
+        t0.join();
+        t1.join();
+
+        // merged from both (finished) threads
+        bship::metrics_snapshot m = bship::metrics::snapshot();
+        CPPUNIT_ASSERT_EQUAL((uint64_t) (shots[0] + shots[1]), m.get(bship::MC_SHOTS));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 20, m.get(bship::MC_PLACEMENTS) - m.get(bship::MC_PLACEMENTS_REJECTED));
+        CPPUNIT_ASSERT(m.get(bship::MC_PEEKS) > 0);
+        CPPUNIT_ASSERT(m.get(bship::MC_RETRIES) > 0);
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, m.moves.size());
+        CPPUNIT_ASSERT(m.moves["random"].count >= 10);
+        CPPUNIT_ASSERT(m.to_json().find("\"shots\": " + std::to_string(shots[0] + shots[1])) != std::string::npos);
+
+        // counted in this thread
+        try{ throw bship::illegal_move_exception(); }
+        catch(bship::illegal_move_exception& e){}
+        CPPUNIT_ASSERT_EQUAL(m.get(bship::MC_EXCEPTIONS) + 1, bship::metrics::snapshot().get(bship::MC_EXCEPTIONS));
+
+        bship::metrics::reset();
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 0, bship::metrics::snapshot().get(bship::MC_SHOTS));
+        CPPUNIT_ASSERT(bship::metrics::snapshot().moves.empty());
+#endif
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_metrics);
+    CPPUNIT_TEST(test_histogram);
+    CPPUNIT_TEST(test_counters);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef TEST_MODEL_PLAYER_HPP
+#define TEST_MODEL_PLAYER_HPP
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "game_listener.h"
+#include "model_player.h"
+#include "placement_prior.h"
+
+
+// places its fleet the same way every game, shoots at random
+class habit_player : public bship::bs_player{
+public:
+    habit_player(std::string nm) : bship::bs_player(nm) {}
+
+    void move(){
+        if(hidden_grid->is_ready()) bship::bs_player::move();
+        else{
+            size_t k = 0;
+            for(auto& tp : hidden_grid->get_n_ships()) k += tp.second;
+            game->place_ship(next_ship(), 2 * k, 1 + k, bship::SO_HOR);
+        }
+    }
+};
+
+
+// counts the shots of player A
+class shot_counter : public bship::game_listener{
+public:
+    int by_a = 0;
+
+    void on_shot(bship::battleship&, bool by_pa, size_t, size_t, std::pair<bship::shot_result, int>){
+        if(by_pa) ++by_a;
+    }
+};
+
+
+class test_model_player : public CppUnit::TestCase{
+
+public:
+
+    test_model_player(){}
+
+
+    // test the counts of a prior file and that they persist
+    void test_prior(){
+
+        std::string path = "/tmp/bship_prior_" + std::to_string(getpid()) + ".prior";
+        std::remove(path.c_str());
+        {
+            bship::placement_prior p;
+            CPPUNIT_ASSERT(p.open(path, 10, 10));
+            CPPUNIT_ASSERT_EQUAL(0.5, p.weight(3));
+
+            bship::bitboard a, b;
+            a.set(3); a.set(99);
+            b.set(3);
+            p.record(a);
+            p.record(b);
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 2, p.fleets());
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 2, p.count(3));
+            CPPUNIT_ASSERT_EQUAL((uint64_t) 1, p.count(99));
+            CPPUNIT_ASSERT_EQUAL(0.75, p.weight(3));
+            CPPUNIT_ASSERT_EQUAL(0.25, p.weight(4));
+        }
+
+        bship::placement_prior p;
+        CPPUNIT_ASSERT(!p.open(path, 8, 8));
+        CPPUNIT_ASSERT(p.open(path, 10, 10));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 2, p.fleets());
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1, p.count(99));
+        p.close();
+        std::remove(path.c_str());
+
+        CPPUNIT_ASSERT_EQUAL(std::string("dir/slick_0_2.prior"), bship::placement_prior::path_for("dir", "slick 0.2"));
+
+    }
+
+
+    // test that the bot learns a fixed placement habit
+    void test_learns(){
+
+        // the prior of the opponent is in the directory, under its name
+        std::string dir = "/tmp/bship_habit_" + std::to_string(getpid());
+        std::string path = bship::placement_prior::path_for(dir, "habit");
+        mkdir(dir.c_str(), 0755);
+        std::remove(path.c_str());
+
+        bship::battleship game(10, 10, bship::OM_SILENT);
+        bship::model_player pa("model", dir);
+        habit_player pb("habit");
+        bship::connect(&game, &pa, &pb);
+        shot_counter cnt;
+        game.add_listener(&cnt);
+
+        // the first game is a parity hunt, from then on the habit is known
+        int first = 0, later = 0;
+        for(int g=0; g<11; ++g){
+            game.reset();
+            cnt.by_a = 0;
+            game.start();
+            CPPUNIT_ASSERT(game.is_finished());
+            if(g == 0) first = cnt.by_a;
+            else later += cnt.by_a;
+        }
+
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 11, pa.get_prior().fleets());
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 11, pa.get_prior().count(1));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 0, pa.get_prior().count(0));
+        CPPUNIT_ASSERT(first > 17);
+        CPPUNIT_ASSERT(later <= 10 * 20);
+
+        // another opponent gets its own prior
+        bship::bs_player other("other");
+        bship::connect(&game, &pa, &other);
+        game.reset();
+        game.start();
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1, pa.get_prior().fleets());
+        bship::placement_prior habit;
+        CPPUNIT_ASSERT(habit.open(path, 10, 10));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 11, habit.fleets());
+        habit.close();
+
+        // connected to fresh games without reset(), every game is recorded
+        for(int g=0; g<3; ++g){
+            bship::battleship fresh(10, 10, bship::OM_SILENT);
+            bship::connect(&fresh, &pa, &other);
+            fresh.start();
+            CPPUNIT_ASSERT(fresh.is_finished());
+        }
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 4, pa.get_prior().fleets());
+        CPPUNIT_ASSERT(pa.prior_ok());
+
+        // a prior that can not be opened is reported, the games go on
+        bship::model_player lost("model", dir + "/missing");
+        bship::connect(&game, &lost, &other);
+        game.reset();
+        game.start();
+        CPPUNIT_ASSERT(game.is_finished());
+        CPPUNIT_ASSERT(!lost.prior_ok());
+
+        std::remove(path.c_str());
+        std::remove(bship::placement_prior::path_for(dir, "other").c_str());
+        rmdir(dir.c_str());
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_model_player);
+    CPPUNIT_TEST(test_prior);
+    CPPUNIT_TEST(test_learns);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
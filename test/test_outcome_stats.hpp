@@ -0,0 +1,109 @@
+#ifndef TEST_OUTCOME_STATS_HPP
+#define TEST_OUTCOME_STATS_HPP
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "slick_player.h"
+#include "outcome_stats.h"
+
+
+class test_outcome_stats : public CppUnit::TestCase{
+
+public:
+
+    test_outcome_stats(){}
+
+
+    // test the running statistics against two passes, split and merged
+    void test_running_stats(){
+
+        std::vector<double> xs;
+        for(int i=0; i<1000; ++i) xs.push_back(1e6 + (i * 37) % 101 + 0.5 * (i % 3));
+
+        double mean = std::accumulate(xs.begin(), xs.end(), 0.0) / xs.size();
+        double sq = 0;
+        for(double x : xs) sq += (x - mean) * (x - mean);
+        double var = sq / (xs.size() - 1);
+
+        bship::running_stats all, lo, hi;
+        for(size_t i=0; i<xs.size(); ++i){
+            all.add(xs[i]);
+            ((i < 300) ? lo : hi).add(xs[i]);
+        }
+        lo.merge(hi);
+
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1000, all.count());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, all.mean(), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(var, all.variance(), 1e-6 * var);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1000, lo.count());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, lo.mean(), 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(var, lo.variance(), 1e-6 * var);
+        CPPUNIT_ASSERT_EQUAL(all.min(), lo.min());
+        CPPUNIT_ASSERT_EQUAL(all.max(), lo.max());
+
+        bship::running_stats none;
+        none.merge(bship::running_stats());
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 0, none.count());
+        CPPUNIT_ASSERT_EQUAL(0.0, none.variance());
+
+    }
+
+
+    // test the outcomes recorded from games in one slot, and their merge
+    void test_recorder(){
+
+        bship::outcome_stats st[2];
+        int wins_a = 0, shots = 0;
+        for(int s=0; s<2; ++s){
+            bship::battleship game(10, 10, bship::OM_SILENT);
+            bship::bs_player pa("random");
+            bship::slick_player pb("slick", 1.0);
+            bship::connect(&game, &pa, &pb);
+            bship::outcome_recorder rec(st[s], "random vs slick");
+            game.add_listener(&rec);
+
+            for(int g=0; g<3; ++g){
+                game.reset();
+                game.start();
+                if(game.get_winner() == &pa) ++wins_a;
+                shots += game.get_total_shots();
+            }
+            game.remove_listener(&rec);
+        }
+        st[0].merge(st[1]);
+
+        bship::outcome_stats::pairing p = st[0].get("random vs slick");
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 6, p.games);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) wins_a, p.wins_a);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(shots / 6.0, p.total_shots.mean(), 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(p.total_shots.mean(), p.shots[0].mean() + p.shots[1].mean(), 1e-9);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 6, std::accumulate(p.shots_hist.begin(), p.shots_hist.end(), (uint64_t) 0));
+
+        // the winner sank every ship, so it hit and sank at least once
+        CPPUNIT_ASSERT(p.first_sink[0].count() + p.first_sink[1].count() >= 6);
+        CPPUNIT_ASSERT(p.first_hit[1].max() <= p.first_sink[1].max());
+        CPPUNIT_ASSERT(p.first_hit[1].min() >= 1);
+
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 0, st[0].get("nobody").games);
+        CPPUNIT_ASSERT(st[0].to_json().find("\"random vs slick\": {\"games\": 6") != std::string::npos);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_outcome_stats);
+    CPPUNIT_TEST(test_running_stats);
+    CPPUNIT_TEST(test_recorder);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef TEST_PLACEMENT_STATS_HPP
+#define TEST_PLACEMENT_STATS_HPP
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bs_player.h"
+#include "placement_stats.h"
+
+
+class test_placement_stats : public CppUnit::TestCase{
+
+public:
+
+    test_placement_stats(){}
+
+
+    // test the counts of single ships and their merge
+    void test_counts(){
+
+        bship::bs_grid g(6, 6);
+        bship::placement_stats a(6, 6, g.get_max_n_ships()), b(6, 6, g.get_max_n_ships());
+        a.add_ship(bship::ST_THREE, 1, 2, bship::SO_HOR);
+        a.add_fleets(1);
+        b.add_ship(bship::ST_FOUR, 0, 3, bship::SO_VERT);
+        b.add_fleets(1);
+        a.merge(b);
+
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 2, a.get_fleets());
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1, a.occupancy(bship::ST_THREE, 1, 4));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 0, a.occupancy(bship::ST_THREE, 1, 5));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1, a.occupancy(bship::ST_FOUR, 3, 3));
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 2, a.occupancy(1, 3));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, a.frequency(1, 3), 1e-12);
+
+    }
+
+
+    // test the recorded placements of the random bot
+    void test_sample(){
+
+        bship::placement_stats st = bship::placement_stats::sample(
+            [](const std::string& name){ return new bship::bs_player(name); }, 10, 10, 1000, 2);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 1000, st.get_fleets());
+
+        // every fleet covers 17 cells, 2 of them with the 2-cell ship
+        uint64_t cells = 0, two = 0;
+        for(size_t r=0; r<10; ++r){
+            for(size_t c=0; c<10; ++c){
+                cells += st.occupancy(r, c);
+                two += st.occupancy(bship::ST_TWO, r, c);
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 17 * 1000, cells);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 2 * 1000, two);
+
+        // the recorded distribution is its own best fit
+        std::vector<double> self;
+        for(size_t i=0; i<100; ++i) self.push_back(st.frequency(i / 10, i % 10));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, st.chi_squared(self), 1e-9);
+        CPPUNIT_ASSERT(st.to_json(self).find("\"chi_squared\": 0") != std::string::npos);
+
+    }
+
+
+    // test the uniform distribution (on a small grid, the exact count is slow on 10x10)
+    void test_uniform(){
+
+        bship::bs_grid g(6, 6);
+        bship::placement_stats st(6, 6, g.get_max_n_ships());
+        std::vector<double> u = st.uniform();
+
+        double sum = 0;
+        for(double p : u) sum += p;
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(17.0, sum, 1e-9);
+        CPPUNIT_ASSERT(u[0] < u[2 * 6 + 2]);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(u[0], u[35], 1e-12);
+
+        // a fleet always in the same place is far from uniform
+        st.add_ship(bship::ST_FIVE, 0, 0, bship::SO_HOR);
+        st.add_ship(bship::ST_FOUR, 1, 0, bship::SO_HOR);
+        st.add_ship(bship::ST_THREE, 2, 0, bship::SO_HOR);
+        st.add_ship(bship::ST_THREE, 3, 0, bship::SO_HOR);
+        st.add_ship(bship::ST_TWO, 4, 0, bship::SO_HOR);
+        st.add_fleets(1);
+        double chi2 = 0;
+        for(size_t i=0; i<36; ++i){
+            double o = st.occupancy(i / 6, i % 6);
+            chi2 += (o - u[i]) * (o - u[i]) / u[i];
+        }
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(chi2, st.chi_squared(u), 1e-9);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_placement_stats);
+    CPPUNIT_TEST(test_counts);
+    CPPUNIT_TEST(test_sample);
+    CPPUNIT_TEST(test_uniform);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
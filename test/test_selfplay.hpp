@@ -0,0 +1,125 @@
+#ifndef TEST_SELFPLAY_HPP
+#define TEST_SELFPLAY_HPP
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bounded_queue.h"
+#include "bs_player.h"
+#include "selfplay.h"
+
+
+class test_selfplay : public CppUnit::TestCase{
+
+public:
+
+    test_selfplay(){}
+
+
+    // test that every element goes through a small queue once, in order per producer
+    void test_queue(){
+
+        const int producers = 4, n = 20000;
+        bship::bounded_queue<std::pair<int, int>> q(10);
+        CPPUNIT_ASSERT_EQUAL((size_t) 16, q.capacity());
+
+        std::vector<std::thread> threads;
+        for(int p=0; p<producers; ++p)
+            threads.emplace_back([&q, p]{ for(int i=0; i<n; ++i) q.push(std::make_pair(p, i)); });
+
+        std::vector<int> next(producers, 0);
+        std::pair<int, int> v;
+        for(int got=0; got<producers * n; ){
+            if(!q.try_pop(v)){
+                std::this_thread::yield();
+                continue;
+            }
+            CPPUNIT_ASSERT_EQUAL(next[v.first], v.second);
+            ++next[v.first];
+            ++got;
+        }
+        for(auto& t : threads) t.join();
+        CPPUNIT_ASSERT(!q.try_pop(v));
+
+    }
+
+
+    // test that the shards hold every move of every game, with consistent planes
+    void test_round_trip(){
+
+        bship::selfplay_config cfg;
+        cfg.games         = 40;
+        cfg.threads       = 3;
+        cfg.queue_capacity = 64;
+        cfg.chunk_samples = 500;
+        cfg.shard_chunks  = 3;
+        cfg.prefix        = "/tmp/bship_selfplay_" + std::to_string(getpid());
+
+        auto make = [](const std::string& name){ return new bship::bs_player(name); };
+        bship::selfplay_report rep = bship::selfplay_pipeline::run(make, make, cfg);
+        CPPUNIT_ASSERT(rep.ok);
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 40, rep.games);
+        CPPUNIT_ASSERT_EQUAL((rep.chunks + 2) / 3, rep.shards);
+        CPPUNIT_ASSERT(rep.stored_bytes < rep.raw_bytes);
+
+        std::vector<bship::train_sample> all, chunk;
+        for(uint64_t i=0; i<rep.shards; ++i){
+            std::string path = bship::shard_writer::shard_name(cfg.prefix, i);
+            bship::shard_reader rd;
+            CPPUNIT_ASSERT(rd.open(path));
+            CPPUNIT_ASSERT_EQUAL((size_t) 10, rd.get_width());
+            while(rd.next(chunk)) all.insert(all.end(), chunk.begin(), chunk.end());
+            CPPUNIT_ASSERT(!rd.failed());
+            std::remove(path.c_str());
+        }
+        CPPUNIT_ASSERT_EQUAL(rep.samples, (uint64_t) all.size());
+
+        // the moves of each side of each game, in order
+        std::map<std::pair<uint32_t, bool>, std::vector<bship::train_sample>> moves;
+        for(auto& s : all) moves[std::make_pair(s.game, (s.flags & bship::SF_BY_PA) != 0)].push_back(s);
+
+        int winners = 0;
+        for(auto& m : moves){
+            std::vector<bship::train_sample>& v = m.second;
+            bool won = (v[0].flags & bship::SF_WON) != 0;
+            int hits = 0;
+
+            for(size_t k=0; k<v.size(); ++k){
+                CPPUNIT_ASSERT_EQUAL((uint16_t) k, v[k].move);
+                CPPUNIT_ASSERT_EQUAL(won, (v[k].flags & bship::SF_WON) != 0);
+                CPPUNIT_ASSERT(!v[k].hits.test(v[k].cell) && !v[k].misses.test(v[k].cell));
+                CPPUNIT_ASSERT(v[k].sunk.subset_of(v[k].hits));
+                CPPUNIT_ASSERT_EQUAL(hits, v[k].hits.count());
+                CPPUNIT_ASSERT_EQUAL((int) k - hits, v[k].misses.count());
+                if(v[k].flags & bship::SF_HIT) ++hits;
+            }
+
+            if(won){
+                ++winners;
+                CPPUNIT_ASSERT_EQUAL(17, hits);
+                CPPUNIT_ASSERT(v.back().flags & bship::SF_SINK);
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(40, winners);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_selfplay);
+    CPPUNIT_TEST(test_queue);
+    CPPUNIT_TEST(test_round_trip);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef TEST_SLICED_ENGINE_HPP
+#define TEST_SLICED_ENGINE_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "fleet_sampler.h"
+#include "outcome_stats.h"
+#include "sliced_engine.h"
+
+
+class test_sliced_engine : public CppUnit::TestCase{
+
+    // places a given layout, then shoots in a given order
+    class script_player : public bship::bs_player {
+    public:
+
+        script_player(const std::string& n) : bship::bs_player(n), fleet(nullptr), order(nullptr), placed(0), next(0) {}
+
+        void move(){
+            if(!hidden_grid->is_ready()){
+                const bship::ship_placement& p = fleet[placed];
+                if(game->place_ship(p.type, p.row, p.col, p.orient)) ++placed;
+            }
+            else{
+                size_t x = order[next++];
+                game->shoot_at(x / hidden_grid->get_width(), x % hidden_grid->get_width());
+            }
+        }
+
+        void reset(){
+            bship::bs_player::reset();
+            placed = 0;
+            next = 0;
+        }
+
+        const bship::ship_placement  *fleet;
+        const uint8_t                *order;
+        size_t                        placed;
+        size_t                        next;
+    };
+
+
+public:
+
+    test_sliced_engine(){}
+
+
+    // test every game of a batch against the scalar engine
+    void test_cross_check(){
+
+        bship::bs_grid g(10, 10);
+        bship::sliced_engine eng(g, bship::SM_UNIFORM, 3);
+        bship::fleet_sampler fs(g, bship::SM_FAST, 4);
+        size_t n = eng.get_n_ships();
+
+        for(bship::sliced_policy pol : {bship::SP_RANDOM, bship::SP_PARITY}){
+            std::vector<bship::ship_placement> fa(64 * n), fb(64 * n);
+            for(int k=0; k<64; ++k){
+                fs.sample(&fa[k * n]);
+                fs.sample(&fb[k * n]);
+            }
+            uint8_t oa[100], ob[100];
+            eng.draw_order(pol, oa);
+            eng.draw_order(bship::SP_RANDOM, ob);
+
+            bship::game_outcome out[64];
+            eng.play(fa.data(), fb.data(), oa, ob, out);
+
+            bship::battleship game(10, 10, bship::OM_SILENT);
+            script_player pa("A"), pb("B");
+            bship::connect(&game, &pa, &pb);
+            pa.order = oa;
+            pb.order = ob;
+            for(int k=0; k<64; ++k){
+                bship::outcome_stats st;
+                bship::outcome_recorder rec(st, "scalar");
+                game.add_listener(&rec);
+                game.reset();
+                pa.fleet = &fa[k * n];
+                pb.fleet = &fb[k * n];
+                game.start();
+                game.remove_listener(&rec);
+
+                bship::outcome_stats::pairing p = st.get("scalar");
+                CPPUNIT_ASSERT_EQUAL(out[k].pa_won, p.wins_a == 1);
+                CPPUNIT_ASSERT_EQUAL((double) (out[k].shots[0] + out[k].shots[1]), p.total_shots.mean());
+                CPPUNIT_ASSERT_EQUAL(game.get_total_shots(), out[k].shots[0] + out[k].shots[1]);
+                for(int s=0; s<2; ++s){
+                    CPPUNIT_ASSERT_EQUAL((double) out[k].shots[s], p.shots[s].mean());
+                    CPPUNIT_ASSERT_EQUAL((double) out[k].first_hit[s], p.first_hit[s].mean());
+                    CPPUNIT_ASSERT_EQUAL((double) out[k].first_sink[s], p.first_sink[s].mean());
+                }
+            }
+        }
+
+    }
+
+
+    // test the parity order and the random batches
+    void test_batches(){
+
+        bship::bs_grid g(10, 10);
+        bship::sliced_engine eng(g);
+
+        uint8_t order[100];
+        eng.draw_order(bship::SP_PARITY, order);
+        bool seen[100] = {false};
+        for(int i=0; i<100; ++i){
+            CPPUNIT_ASSERT(!seen[order[i]]);
+            seen[order[i]] = true;
+            CPPUNIT_ASSERT_EQUAL(i >= 50, (order[i] / 10 + order[i] % 10) % 2 == 1);
+        }
+
+        bship::outcome_stats st;
+        bship::game_outcome out[64];
+        for(int b=0; b<4; ++b){
+            eng.play(bship::SP_PARITY, bship::SP_RANDOM, out);
+            for(int k=0; k<64; ++k){
+                CPPUNIT_ASSERT(out[k].shots[(out[k].pa_won) ? 0 : 1] >= 17);
+                CPPUNIT_ASSERT(out[k].first_sink[0] == 0 || out[k].first_hit[0] <= out[k].first_sink[0]);
+                st.record("parity vs random", out[k]);
+            }
+        }
+
+        // parity leaves the other colour for later: the first ship sinks later than at random
+        bship::outcome_stats::pairing p = st.get("parity vs random");
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 256, p.games);
+        CPPUNIT_ASSERT(p.first_sink[0].mean() > p.first_sink[1].mean() + 5);
+
+    }
+
+
+    // test that the games of a batch do not share their shot orders
+    void test_independent(){
+
+        // two layouts per fleet: games sharing the orders would have at most four outcomes
+        std::map<bship::ship_type, uint8_t> fleet = {{bship::ST_FIVE, 1}};
+        bship::sliced_engine eng(5, 2, fleet);
+        bship::game_outcome out[64];
+        eng.play(bship::SP_RANDOM, bship::SP_PARITY, out);
+
+        std::set<std::vector<int>> seen;
+        for(int k=0; k<64; ++k)
+            seen.insert({out[k].shots[0], out[k].shots[1], out[k].first_hit[0], out[k].first_hit[1]});
+        CPPUNIT_ASSERT(seen.size() > 4);
+
+        // the first shot of a random shooter hits half of the time (5 ship cells out of 10)
+        bship::running_stats first;
+        for(int b=0; b<200; ++b){
+            eng.play(bship::SP_RANDOM, bship::SP_RANDOM, out);
+            for(int k=0; k<64; ++k) first.add(out[k].first_hit[0] == 1);
+        }
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, first.mean(), 0.03);
+
+        uint8_t order[10];
+        CPPUNIT_ASSERT_THROW(eng.draw_order(bship::SP_HUNT_TARGET, order), bship::illegal_move_exception);
+        CPPUNIT_ASSERT_THROW(eng.play(bship::SP_HUNT_TARGET, bship::SP_RANDOM, out), bship::illegal_move_exception);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_sliced_engine);
+    CPPUNIT_TEST(test_cross_check);
+    CPPUNIT_TEST(test_batches);
+    CPPUNIT_TEST(test_independent);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
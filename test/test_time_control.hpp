@@ -0,0 +1,131 @@
+#ifndef TEST_TIME_CONTROL_HPP
+#define TEST_TIME_CONTROL_HPP
+
+#include <chrono>
+#include <thread>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "exceptions.hpp"
+
+
+// random player taking its time before every move
+class slow_player : public bship::bs_player{
+public:
+    slow_player(std::string nm, std::chrono::milliseconds d) : bship::bs_player(nm), delay(d) {}
+
+    void move(){
+        std::this_thread::sleep_for(delay);
+        bship::bs_player::move();
+    }
+
+    std::chrono::milliseconds delay;
+};
+
+
+// random player late on its first move only, counting its late moves
+class late_start_player : public bship::bs_player{
+public:
+    late_start_player(std::string nm, std::chrono::milliseconds d) : bship::bs_player(nm), delay(d), moves(0), late(0) {}
+
+    void move(){
+        if(moves++ == 0) std::this_thread::sleep_for(delay);
+        try{
+            bship::bs_player::move();
+        }
+        catch(bship::time_exception& e){
+            ++late;
+            throw;
+        }
+    }
+
+    std::chrono::milliseconds delay;
+    int moves;
+    int late;
+};
+
+
+class test_time_control : public CppUnit::TestCase{
+
+public:
+
+    test_time_control(){}
+
+
+    // test that a late player loses the game
+    void test_forfeit(){
+
+        bship::battleship game(10, 10);
+        slow_player pa("slow", std::chrono::milliseconds(20));
+        bship::bs_player pb("fast");
+        bship::connect(&game, &pa, &pb);
+
+        CPPUNIT_ASSERT(game.time_left() == std::chrono::nanoseconds::max());
+
+        game.set_time_control(bship::time_control(std::chrono::milliseconds(5)));
+        game.start();
+
+        CPPUNIT_ASSERT(game.is_finished());
+        CPPUNIT_ASSERT(game.get_winner() == &pb);
+        CPPUNIT_ASSERT_EQUAL(0, game.get_total_shots());
+        CPPUNIT_ASSERT(game.get_time_used(&pa) >= std::chrono::milliseconds(20));
+
+    }
+
+
+    // test that late moves are replaced by random ones
+    void test_random_move(){
+
+        bship::battleship game(10, 10);
+        slow_player pa("slow", std::chrono::milliseconds(2));
+        bship::bs_player pb("fast");
+        bship::connect(&game, &pa, &pb);
+
+        game.set_time_control(bship::time_control(std::chrono::microseconds(500),
+                                                  std::chrono::microseconds(0),
+                                                  bship::OP_RANDOM_MOVE));
+        game.start();
+
+        // the game is played to the end with every move of the slow player made by the engine
+        CPPUNIT_ASSERT(game.is_finished());
+        CPPUNIT_ASSERT(game.get_total_shots() >= 2*17 - 1);
+
+    }
+
+
+    // test that a player late on a placement carries on with the next ship
+    void test_placement_overrun(){
+
+        bship::battleship game(10, 10);
+        late_start_player pa("late", std::chrono::milliseconds(20));
+        bship::bs_player pb("fast");
+        bship::connect(&game, &pa, &pb);
+
+        game.set_time_control(bship::time_control(std::chrono::milliseconds(5),
+                                                  std::chrono::microseconds(0),
+                                                  bship::OP_RANDOM_MOVE));
+        game.start();
+
+        // the engine placed the smallest ship for the late move, the player
+        // placed every other one on its own, in time
+        CPPUNIT_ASSERT(game.is_finished());
+        CPPUNIT_ASSERT_EQUAL(1, pa.late);
+        CPPUNIT_ASSERT(game.get_total_shots() >= 17);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_time_control);
+    CPPUNIT_TEST(test_forfeit);
+    CPPUNIT_TEST(test_random_move);
+    CPPUNIT_TEST(test_placement_overrun);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
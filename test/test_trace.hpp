@@ -0,0 +1,91 @@
+#ifndef TEST_TRACE_HPP
+#define TEST_TRACE_HPP
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "battleship.h"
+#include "bs_player.h"
+#include "trace.h"
+#include "exceptions.hpp"
+
+
+class test_trace : public CppUnit::TestCase{
+
+    // number of occurrences of a string
+    static size_t count(const std::string& s, const std::string& what){
+        size_t n = 0;
+        for(size_t p = s.find(what); p != std::string::npos; p = s.find(what, p + 1)) ++n;
+        return n;
+    }
+
+public:
+
+    test_trace(){}
+
+
+    // test the spans of games traced on two threads
+    void test_games(){
+
+        std::string path = "/tmp/bship_trace_" + std::to_string(getpid()) + ".json";
+        CPPUNIT_ASSERT(!bship::tracer::enabled());
+
+        // small buffers, written while the games are played
+        CPPUNIT_ASSERT(bship::tracer::start(path, 16));
+        CPPUNIT_ASSERT(!bship::tracer::start(path));
+        CPPUNIT_ASSERT(bship::tracer::enabled());
+
+        auto play = [](int *shots){
+            bship::battleship game(10, 10, bship::OM_SILENT);
+            bship::bs_player pa("a"), pb("b");
+            bship::connect(&game, &pa, &pb);
+            game.start();
+            *shots = game.get_total_shots();
+        };
+        int s0, s1;
+        std::thread t0(play, &s0), t1(play, &s1);
+        t0.join();
+        t1.join();
+        int moves = s0 + s1 + 20;   // with the placements
+
+        { BS_TRACE("test", "test"); }
+        bship::tracer::stop();
+        CPPUNIT_ASSERT(!bship::tracer::enabled());
+
+        // not recorded
+        { BS_TRACE("after", "test"); }
+
+        std::ifstream in(path);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        std::string trace = ss.str();
+        unlink(path.c_str());
+
+        CPPUNIT_ASSERT_EQUAL('[', trace.front());
+        CPPUNIT_ASSERT_EQUAL(std::string("]\n"), trace.substr(trace.size() - 2));
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, count(trace, "\"name\":\"game\""));
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, count(trace, "\"name\":\"placement\""));
+        CPPUNIT_ASSERT_EQUAL((size_t) 2, count(trace, "\"name\":\"shooting\""));
+        CPPUNIT_ASSERT_EQUAL((size_t) moves, count(trace, "\"name\":\"move "));
+        CPPUNIT_ASSERT_EQUAL((size_t) 1, count(trace, "\"name\":\"test\""));
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, count(trace, "\"name\":\"after\""));
+        CPPUNIT_ASSERT_EQUAL(bship::tracer::num_events(), count(trace, "\"ph\":\"X\""));
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_trace);
+    CPPUNIT_TEST(test_games);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef TEST_VEC_ENV_HPP
+#define TEST_VEC_ENV_HPP
+
+#include <random>
+#include <vector>
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bship_c.h"
+#include "vec_env.h"
+
+
+class test_vec_env : public CppUnit::TestCase{
+
+public:
+
+    test_vec_env(){}
+
+
+    // test whole episodes shooting every cell in order
+    void test_episodes(){
+
+        const size_t n = 8;
+        bship::vec_env env(n, 10, 10);
+        CPPUNIT_ASSERT_EQUAL((size_t) 300, env.get_obs_size());
+
+        std::vector<float> obs(n * 300), rew(n);
+        std::vector<uint8_t> dones(n);
+        std::vector<int32_t> act(n);
+        env.reset(obs.data());
+        for(float x : obs) CPPUNIT_ASSERT_EQUAL(0.0f, x);
+
+        std::vector<float> total(n, 0.0f);
+        std::vector<bool> finished(n, false);
+        for(int t=0; t<100; ++t){
+            for(size_t i=0; i<n; ++i) act[i] = (finished[i]) ? 0 : t;
+            env.step(act.data(), obs.data(), rew.data(), dones.data());
+
+            for(size_t i=0; i<n; ++i){
+                if(finished[i]) continue;
+                total[i] += rew[i];
+
+                if(dones[i]){
+                    // every ship cell hit once, the new episode starts empty
+                    finished[i] = true;
+                    CPPUNIT_ASSERT_EQUAL(17.0f, total[i]);
+                    CPPUNIT_ASSERT_EQUAL(t + 1, env.get_last_length(i));
+                    for(size_t c=0; c<300; ++c) CPPUNIT_ASSERT_EQUAL(0.0f, obs[i * 300 + c]);
+                }
+                else{
+                    // one mark per shot, the sunk cells are hit cells
+                    float hits = 0, misses = 0;
+                    for(size_t c=0; c<100; ++c){
+                        const float *o = &obs[i * 300];
+                        hits   += o[bship::PL_HIT * 100 + c];
+                        misses += o[bship::PL_MISS * 100 + c];
+                        if(o[bship::PL_SUNK * 100 + c] > 0) CPPUNIT_ASSERT_EQUAL(1.0f, o[bship::PL_HIT * 100 + c]);
+                    }
+                    CPPUNIT_ASSERT_EQUAL((float) (t + 1), hits + misses);
+                    CPPUNIT_ASSERT_EQUAL(total[i], hits);
+                }
+            }
+        }
+        for(size_t i=0; i<n; ++i) CPPUNIT_ASSERT(finished[i]);
+
+    }
+
+
+    // test the illegal actions and the episode limit
+    void test_illegal(){
+
+        bship::env_rewards r;
+        r.max_steps = 5;
+        bship::vec_env env(2, 10, 10, 1, 7, r);
+
+        std::vector<float> obs(600), before(600), rew(2);
+        std::vector<uint8_t> dones(2);
+        int32_t act[2] = {42, -1};
+        env.reset(obs.data());
+
+        env.step(act, obs.data(), rew.data(), dones.data());
+        CPPUNIT_ASSERT_EQUAL(-1.0f, rew[1]);
+        before = obs;
+
+        act[1] = 100;
+        for(int t=0; t<3; ++t){
+            env.step(act, obs.data(), rew.data(), dones.data());
+            CPPUNIT_ASSERT_EQUAL(-1.0f, rew[0]);
+            CPPUNIT_ASSERT_EQUAL(-1.0f, rew[1]);
+            CPPUNIT_ASSERT(!dones[0] && !dones[1]);
+            CPPUNIT_ASSERT(obs == before);
+        }
+
+        // cut at the fifth step
+        env.step(act, obs.data(), rew.data(), dones.data());
+        CPPUNIT_ASSERT(dones[0] && dones[1]);
+        CPPUNIT_ASSERT_EQUAL(5, env.get_last_length(0));
+
+    }
+
+
+    // test that the episodes do not depend on the threads and that a step allocates nothing
+    void test_threads(){
+
+        const size_t n = 37;
+        bship::vec_env one(n, 10, 10, 1, 5), four(n, 10, 10, 4, 5);
+
+        std::vector<float> obs1(n * 300), obs4(n * 300), rew1(n), rew4(n);
+        std::vector<uint8_t> done1(n), done4(n);
+        std::vector<int32_t> act(n);
+        std::mt19937 rng(11);
+
+        long allocs = test_allocs;
+        for(int t=0; t<300; ++t){
+            for(auto& a : act) a = rng() % 100;
+            one.step(act.data(), obs1.data(), rew1.data(), done1.data());
+            four.step(act.data(), obs4.data(), rew4.data(), done4.data());
+            CPPUNIT_ASSERT(obs1 == obs4);
+            CPPUNIT_ASSERT(rew1 == rew4);
+            CPPUNIT_ASSERT(done1 == done4);
+        }
+        CPPUNIT_ASSERT_EQUAL(0L, test_allocs - allocs);
+
+    }
+
+
+    // test the C interface
+    void test_c_api(){
+
+        CPPUNIT_ASSERT(bship_vec_env_create(4, 0, 10, 1, 1, NULL) == NULL);
+
+        bship_rewards r;
+        bship_default_rewards(&r);
+        r.miss = -0.5f;
+        bship_vec_env *env = bship_vec_env_create(4, 10, 10, 2, 3, &r);
+        CPPUNIT_ASSERT(env != NULL);
+        CPPUNIT_ASSERT_EQUAL((size_t) 4, bship_vec_env_n_envs(env));
+        CPPUNIT_ASSERT_EQUAL((size_t) 300, bship_vec_env_obs_size(env));
+
+        std::vector<float> obs(4 * 300), rew(4);
+        std::vector<uint8_t> dones(4);
+        CPPUNIT_ASSERT_EQUAL(0, bship_vec_env_reset(env, obs.data()));
+
+        int32_t act[4] = {0, 1, 2, 3};
+        CPPUNIT_ASSERT_EQUAL(0, bship_vec_env_step(env, act, obs.data(), rew.data(), dones.data()));
+        for(int i=0; i<4; ++i){
+            CPPUNIT_ASSERT(rew[i] == -0.5f || rew[i] == 1.0f);
+            CPPUNIT_ASSERT_EQUAL((rew[i] > 0) ? 1.0f : 0.0f, obs[i * 300 + bship::PL_HIT * 100 + i]);
+        }
+        CPPUNIT_ASSERT_EQUAL(0, bship_vec_env_last_length(env, 0));
+        CPPUNIT_ASSERT_EQUAL(-1, bship_vec_env_last_length(env, 4));
+        CPPUNIT_ASSERT_EQUAL(-1, bship_vec_env_step(env, NULL, NULL, NULL, NULL));
+        bship_vec_env_destroy(env);
+
+    }
+
+
+    CPPUNIT_TEST_SUITE(test_vec_env);
+    CPPUNIT_TEST(test_episodes);
+    CPPUNIT_TEST(test_illegal);
+    CPPUNIT_TEST(test_threads);
+    CPPUNIT_TEST(test_c_api);
+    CPPUNIT_TEST_SUITE_END();
+
+};
+
+
+#endif